@@ -0,0 +1,142 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+constexpr int64_t LOOKUP_COUNT = 200'000;
+
+constexpr int64_t SCAN_COUNT = 10'000;
+
+// rows returned by each range scan on average, values are in [0, 10 * record_count)
+constexpr int64_t SCAN_ROWS = 100;
+
+// Compares B+tree indexes with in-memory ART indexes over an INT and a STR column, each kind of index on
+// its own copy of the table, for tables of 1000 records up to `max_record_count`: the time to build the
+// indexes, point lookups (SELECT * WHERE key = x) on both columns and range scans on the INT column.
+
+Schema bench_schema() {
+  return Schema({
+      {"a", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// returns the number of rows found, and the elapsed milliseconds in `ms`
+int64_t lookup(Index& index, const Schema& schema, const std::vector<Value>& keys, double* ms) {
+  Record record_buf(schema);
+  std::mt19937_64 rng(1);
+
+  auto start = std::chrono::steady_clock::now();
+  int64_t found = 0;
+  for (int64_t i = 0; i < LOOKUP_COUNT; i++) {
+    auto& key = keys[rng() % keys.size()];
+    auto iter = index.get_iter(key, key);
+    iter->begin(record_buf);
+    while (iter->next()) {
+      found++;
+    }
+  }
+  *ms = elapsed_ms(start);
+  return found;
+}
+
+// returns the number of rows found, and the elapsed milliseconds in `ms`
+int64_t scan(Index& index, const Schema& schema, int64_t record_count, double* ms) {
+  ColumnBatch batch(schema);
+  std::mt19937_64 rng(2);
+  auto width = 10 * SCAN_ROWS;
+
+  auto start = std::chrono::steady_clock::now();
+  int64_t found = 0;
+  for (int64_t i = 0; i < SCAN_COUNT; i++) {
+    auto min = static_cast<int64_t>(rng() % (record_count * 10));
+    auto iter = index.get_iter(Value(min), Value(min + width - 1));
+    while (iter->next_batch(batch)) {
+      found += batch.size;
+    }
+  }
+  *ms = elapsed_ms(start);
+  return found;
+}
+
+int main(int argc, char** argv) {
+  int64_t max_n = 1'000'000;
+  if (argc == 2) {
+    max_n = atol(argv[1]);
+  }
+  if (max_n < 1000) {
+    std::cout << "Usage: bench_art_index [max_record_count >= 1000]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_art_index";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  std::cout << "lookups: " << LOOKUP_COUNT << ", range scans of ~" << SCAN_ROWS << " rows: " << SCAN_COUNT
+            << "\n";
+
+  for (int64_t n = 1000; n <= max_n; n *= 10) {
+    std::vector<int64_t> as(n);
+    std::vector<std::string> strs(n);
+    std::vector<std::string_view> ss(n);
+    std::vector<Value> int_keys;
+    std::vector<Value> str_keys;
+    std::mt19937_64 rng(0);
+    for (int64_t i = 0; i < n; i++) {
+      as[i] = rng() % (n * 10);
+      strs[i] = "customer_" + std::to_string(rng() % (n * 10));
+      ss[i] = strs[i];
+      int_keys.emplace_back(as[i]);
+      str_keys.emplace_back(strs[i]);
+    }
+
+    std::cout << "records: " << n << "\n";
+    for (bool art : {false, true}) {
+      auto table_name = std::string(art ? "art" : "bpt") + std::to_string(n);
+      catalog.create_table(table_name, bench_schema());
+      catalog.get_inserter(table_name).insert({as.data(), ss.data()}, n);
+
+      auto start = std::chrono::steady_clock::now();
+      for (int col_idx : {0, 1}) {
+        if (art) {
+          catalog.create_art_index(table_name, col_idx);
+        } else {
+          catalog.create_index(table_name, col_idx);
+        }
+      }
+      auto build_ms = elapsed_ms(start);
+
+      auto& schema = *catalog.get_table_info(table_name).schema;
+      auto& indexes = catalog.get_indexes(table_name);
+      double int_ms, str_ms, scan_ms;
+      // first run warms up the buffer
+      lookup(*indexes[0], schema, int_keys, &int_ms);
+      auto int_found = lookup(*indexes[0], schema, int_keys, &int_ms);
+      auto str_found = lookup(*indexes[1], schema, str_keys, &str_ms);
+      auto scan_found = scan(*indexes[0], schema, n, &scan_ms);
+
+      std::cout << (art ? "  ART:    " : "  B+tree: ") << "built in " << build_ms << " ms, INT lookup "
+                << int_ms * 1'000'000 / LOOKUP_COUNT << " ns, STR lookup "
+                << str_ms * 1'000'000 / LOOKUP_COUNT << " ns, range scan " << scan_ms * 1'000 / SCAN_COUNT
+                << " us (rows found: " << int_found << ", " << str_found << ", " << scan_found << ")\n";
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
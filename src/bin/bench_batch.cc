@@ -0,0 +1,109 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Compares SELECT SUM(a) WHERE b < 50 using next() and next_batch(), in ROW and PAX format
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"a", DataType::INT},
+      {"b", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+void populate(const std::string& table_name, int64_t n) {
+  for (int64_t i = 0; i < n; i++) {
+    catalog.insert_record(table_name, {i, i % 7, i % 100, "value_number_" + std::to_string(i % 1000)});
+  }
+}
+
+// returns the sum, and the elapsed milliseconds in `ms`
+int64_t sum_tuples(const std::string& table_name, double* ms) {
+  Schema schema;
+  HeapFile* heap_file = catalog.get_table(table_name, &schema);
+
+  auto start = std::chrono::steady_clock::now();
+
+  Record record_buf(schema);
+  auto iter = heap_file->get_record_iter();
+  iter->begin(record_buf);
+  int64_t sum = 0;
+  while (iter->next()) {
+    if (record_buf.values[2].value.as_int < 50) {
+      sum += record_buf.values[1].value.as_int;
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  *ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return sum;
+}
+
+// returns the sum, and the elapsed milliseconds in `ms`
+int64_t sum_batches(const std::string& table_name, double* ms) {
+  Schema schema;
+  HeapFile* heap_file = catalog.get_table(table_name, &schema);
+
+  auto start = std::chrono::steady_clock::now();
+
+  ColumnBatch batch(schema);
+  auto iter = heap_file->get_record_iter();
+  int64_t sum = 0;
+  while (iter->next_batch(batch)) {
+    const int64_t* a = batch.columns[1].ints.data();
+    const int64_t* b = batch.columns[2].ints.data();
+    for (size_t i = 0; i < batch.size; i++) {
+      sum += b[i] < 50 ? a[i] : 0;
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  *ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_batch [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_batch";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  catalog.create_table("t_row", bench_schema(), TableFormat::ROW);
+  catalog.create_table("t_pax", bench_schema(), TableFormat::PAX);
+  populate("t_row", n);
+  populate("t_pax", n);
+
+  std::cout << "records: " << n << "\n";
+
+  for (auto table_name : {"t_row", "t_pax"}) {
+    // first runs warm up the buffer
+    double ms;
+    sum_tuples(table_name, &ms);
+    auto sum = sum_tuples(table_name, &ms);
+    std::cout << table_name << " next()       SUM(a) = " << sum << " in " << ms << " ms\n";
+
+    sum_batches(table_name, &ms);
+    sum = sum_batches(table_name, &ms);
+    std::cout << table_name << " next_batch() SUM(a) = " << sum << " in " << ms << " ms\n";
+  }
+
+  return EXIT_SUCCESS;
+}
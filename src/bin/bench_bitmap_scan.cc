@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "system/system.h"
+
+constexpr int64_t MB = 1024 * 1024;
+
+// Compares SELECT SUM(a) WHERE id BETWEEN x AND y using a B+tree over `id` that fetches the rows from the
+// heap file in key order (get_iter) against fetching them in physical order (get_bitmap_iter).
+// Rows are inserted in random order of id, so consecutive keys are in different heap pages. The buffer is
+// smaller than the table, so fetching in key order reads the same pages from disk many times.
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"a", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+// returns the sum of `a` over the range, and the elapsed milliseconds in `ms`
+int64_t sum_range(BPlusTree& index, int64_t min, int64_t max, bool bitmap, double* ms) {
+  ColumnBatch batch(index.heap_file.schema);
+
+  auto start = std::chrono::steady_clock::now();
+
+  Value min_value(min);
+  Value max_value(max);
+  auto iter = bitmap ? index.get_bitmap_iter(min_value, max_value) : index.get_iter(min_value, max_value);
+  int64_t sum = 0;
+  while (iter->next_batch(batch)) {
+    for (size_t i = 0; i < batch.size; i++) {
+      sum += batch.columns[1].ints[i];
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  *ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_bitmap_scan [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_bitmap_scan";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 32 * MB);
+
+  catalog.create_table("t", bench_schema());
+
+  std::vector<int64_t> ids(n);
+  for (int64_t i = 0; i < n; i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937_64(0));
+
+  auto inserter = catalog.get_inserter("t");
+  std::vector<int64_t> a(n);
+  std::vector<std::string> strs(n);
+  std::vector<std::string_view> s(n);
+  for (int64_t i = 0; i < n; i++) {
+    a[i] = ids[i] % 7;
+    strs[i] = "padding_to_make_rows_wider_" + std::to_string(ids[i]) + std::string(60, 'x');
+    s[i] = strs[i];
+  }
+  inserter.insert({ids.data(), a.data(), s.data()}, n);
+
+  catalog.create_index("t", 0);
+  auto& index = dynamic_cast<BPlusTree&>(*catalog.get_index("t"));
+
+  std::cout << "records: " << n << "\n";
+
+  for (double selectivity : {0.0001, 0.001, 0.01, 0.1, 0.5}) {
+    auto range_size = std::max<int64_t>(1, static_cast<int64_t>(selectivity * n));
+    auto min = (n - range_size) / 2;
+    auto max = min + range_size - 1;
+
+    // each mode runs twice, the second one is measured
+    double key_order_ms;
+    sum_range(index, min, max, false, &key_order_ms);
+    auto sum = sum_range(index, min, max, false, &key_order_ms);
+    double bitmap_ms;
+    sum_range(index, min, max, true, &bitmap_ms);
+    auto bitmap_sum = sum_range(index, min, max, true, &bitmap_ms);
+    if (sum != bitmap_sum) {
+      std::cout << "wrong result: " << sum << " != " << bitmap_sum << "\n";
+      return EXIT_FAILURE;
+    }
+    std::cout << "selectivity " << selectivity * 100 << "% (" << range_size << " rows), SUM(a) = " << sum
+              << ": key order " << key_order_ms << " ms, physical order " << bitmap_ms << " ms\n";
+  }
+
+  return EXIT_SUCCESS;
+}
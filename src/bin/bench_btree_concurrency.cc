@@ -0,0 +1,127 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/heap_file/heap_file.h"
+#include "storage/heap_file/table_page.h"
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Inserts the rows of a table into its B+tree from several threads at the same time, each thread also
+// looking up keys it inserted before (index-only point lookups). The rows are written to the heap file
+// before the timed part, so only the B+tree operations are measured.
+
+constexpr int64_t LOOKUPS_PER_INSERT = 1;
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_btree_concurrency [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_btree_concurrency";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  std::vector<std::string> keys(n);
+  std::mt19937_64 rng(0);
+  for (int64_t i = 0; i < n; i++) {
+    keys[i] = "customer_" + std::to_string(rng() % (n * 10)) + "_" + std::to_string(i);
+  }
+
+  std::cout << "records: " << n << ", hardware threads: " << std::thread::hardware_concurrency() << "\n";
+
+  for (int64_t thread_count : {1, 2, 4, 8}) {
+    auto table_name = "t" + std::to_string(thread_count);
+    Schema schema;
+    catalog.create_table(table_name, bench_schema());
+    auto heap_file = catalog.get_table(table_name, &schema);
+    catalog.create_index(table_name, 1, {0});
+    auto& index = dynamic_cast<BPlusTree&>(*catalog.get_index(table_name));
+
+    // the index is maintained below, so rows go directly to the heap file
+    std::vector<RID> rids(n);
+    {
+      Record record(schema);
+      std::unique_ptr<TablePage> current_page;
+      for (int64_t i = 0; i < n; i++) {
+        record.values[0].value.as_int = i;
+        record.values[1].set_str(keys[i].data(), keys[i].size());
+        rids[i] = heap_file->insert_record(record, current_page);
+      }
+    }
+
+    std::atomic<int64_t> found(0);
+    auto run = [&](int64_t thread) {
+      Record record(schema);
+      Record out(schema);
+      std::mt19937_64 thread_rng(thread);
+      int64_t thread_found = 0;
+      int64_t inserted = 0;
+      // thread `t` inserts the rows t, t + thread_count, t + 2 * thread_count, ...
+      for (int64_t i = thread; i < n; i += thread_count) {
+        record.values[0].value.as_int = i;
+        record.values[1].set_str(keys[i].data(), keys[i].size());
+        index.insert_record(record, rids[i]);
+        inserted++;
+
+        for (int64_t j = 0; j < LOOKUPS_PER_INSERT; j++) {
+          int64_t row = thread + (thread_rng() % inserted) * thread_count;
+          Value key(keys[row]);
+          auto iter = index.get_index_only_iter(key, key);
+          iter->begin(out);
+          while (iter->next()) {
+            thread_found += out.values[0].value.as_int == row;
+          }
+        }
+      }
+      found += thread_found;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int64_t thread = 0; thread < thread_count; thread++) {
+      threads.emplace_back(run, thread);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // every key must be in the index exactly once, in order
+    Record out(schema);
+    auto iter = index.get_index_only_iter(Value(std::string("")), Value(std::string("customer_a")));
+    iter->begin(out);
+    int64_t count = 0;
+    while (iter->next()) {
+      count++;
+    }
+
+    std::cout << "threads " << thread_count << ": " << ms << " ms, "
+              << (n * (1 + LOOKUPS_PER_INSERT)) / ms * 1000 << " ops/s"
+              << (found == n * LOOKUPS_PER_INSERT && count == n ? "" : " WRONG RESULT") << "\n";
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/b_plus_tree/b_plus_tree_leaf.h"
+#include "storage/heap_file/heap_file.h"
+#include "storage/heap_file/table_page.h"
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+constexpr int64_t DELETE_THREADS = 4;
+
+// one of each KEEP_EVERY rows is not deleted
+constexpr int64_t KEEP_EVERY = 10;
+
+constexpr int64_t QUERY_COUNT = 1000;
+
+// Deletes most rows of a B+tree from several threads while another thread inserts new rows and another one
+// runs range scans. It reports the range scans before and after the deletes, the leaves in the chain (merged
+// leaves leave it) and the pages of the leaf file before and after inserting the deleted rows again, that
+// reuse the pages of the merged leaves instead of growing the file. The rows are written to the heap file
+// before the timed part, so only the B+tree operations are measured.
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// returns the rows found by index-only scans over [min, min + width]
+int64_t run_queries(BPlusTree& index, const std::vector<int64_t>& mins, int64_t width, const Schema& schema) {
+  ColumnBatch batch(schema);
+  int64_t rows = 0;
+  for (auto min : mins) {
+    auto iter = index.get_index_only_iter(Value(min), Value(min + width));
+    while (iter->next_batch(batch)) {
+      rows += batch.size;
+    }
+  }
+  return rows;
+}
+
+int64_t count_leaves(const BPlusTree& index) {
+  int64_t count = 0;
+  int32_t page_number = 0;
+  do {
+    BPlusTreeLeaf leaf(index, page_number);
+    page_number = leaf.get_next_page_number();
+    count++;
+  } while (page_number != 0);
+  return count;
+}
+
+void print_pages(const std::string& name, const BPlusTree& index) {
+  std::cout << name << ": " << file_mgr.count_pages(index.leaf_file_id) << " leaf pages ("
+            << count_leaves(index) << " in the leaf chain), " << file_mgr.count_pages(index.dir_file_id)
+            << " dir pages\n";
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_btree_delete [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_btree_delete";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  Schema schema;
+  catalog.create_table("t", bench_schema());
+  auto heap_file = catalog.get_table("t", &schema);
+  catalog.create_index("t", 0);
+  auto& index = dynamic_cast<BPlusTree&>(*catalog.get_index("t"));
+
+  // rows [0, n) are inserted first, rows [n, 2 * n) while deleting
+  std::vector<RID> rids(2 * n);
+  {
+    Record record(schema);
+    std::string str(20, 's');
+    record.values[1].set_str(str.data(), str.size());
+    std::unique_ptr<TablePage> current_page;
+    for (int64_t i = 0; i < 2 * n; i++) {
+      record.values[0].value.as_int = i;
+      rids[i] = heap_file->insert_record(record, current_page);
+    }
+  }
+  std::vector<int64_t> order(n);
+  for (int64_t i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  std::mt19937_64 rng(0);
+  std::shuffle(order.begin(), order.end(), rng);
+
+  Record record(schema);
+  auto start = std::chrono::steady_clock::now();
+  for (auto i : order) {
+    heap_file->get_record(rids[i], record);
+    index.insert_record(record, rids[i]);
+  }
+  std::cout << "insert " << n << " rows: " << elapsed_ms(start) << " ms\n";
+  print_pages("after insert", index);
+
+  auto width = std::max<int64_t>(1, n / 1000);
+  std::vector<int64_t> mins(QUERY_COUNT);
+  for (auto& min : mins) {
+    min = rng() % std::max<int64_t>(1, n - width);
+  }
+  start = std::chrono::steady_clock::now();
+  auto rows = run_queries(index, mins, width, schema);
+  std::cout << "range scans before delete: " << elapsed_ms(start) << " ms, " << rows << " rows\n";
+
+  // deleters remove the rows of `order` not multiple of KEEP_EVERY
+  std::atomic<bool> deleting(true);
+  std::atomic<int64_t> scans(0);
+  auto run_deleter = [&](int64_t thread) {
+    Record record(schema);
+    for (int64_t i = thread; i < n; i += DELETE_THREADS) {
+      if (order[i] % KEEP_EVERY != 0) {
+        heap_file->get_record(rids[order[i]], record);
+        index.delete_record(record, rids[order[i]]);
+      }
+    }
+  };
+  auto run_inserter = [&]() {
+    Record record(schema);
+    for (int64_t i = n; i < 2 * n && deleting; i++) {
+      heap_file->get_record(rids[i], record);
+      index.insert_record(record, rids[i]);
+    }
+  };
+  auto run_scanner = [&]() {
+    std::mt19937_64 thread_rng(1);
+    std::vector<int64_t> scan_mins(1);
+    while (deleting) {
+      scan_mins[0] = thread_rng() % std::max<int64_t>(1, n - width);
+      run_queries(index, scan_mins, width, schema);
+      scans++;
+    }
+  };
+
+  start = std::chrono::steady_clock::now();
+  std::vector<std::thread> deleters;
+  for (int64_t thread = 0; thread < DELETE_THREADS; thread++) {
+    deleters.emplace_back(run_deleter, thread);
+  }
+  std::thread inserter(run_inserter);
+  std::thread scanner(run_scanner);
+  for (auto& thread : deleters) {
+    thread.join();
+  }
+  auto delete_ms = elapsed_ms(start);
+  deleting = false;
+  inserter.join();
+  scanner.join();
+  auto deleted = n - (n + KEEP_EVERY - 1) / KEEP_EVERY;
+  std::cout << "delete " << deleted << " rows from " << DELETE_THREADS << " threads: " << delete_ms << " ms, "
+            << deleted / delete_ms * 1000 << " deletes/s (" << scans << " concurrent range scans)\n";
+
+  // the new rows go after [0, n), so the scans only see the rows that were kept
+  start = std::chrono::steady_clock::now();
+  rows = run_queries(index, mins, width, schema);
+  std::cout << "range scans after delete: " << elapsed_ms(start) << " ms, " << rows << " rows\n";
+  print_pages("after delete", index);
+
+  start = std::chrono::steady_clock::now();
+  for (auto i : order) {
+    if (i % KEEP_EVERY != 0) {
+      heap_file->get_record(rids[i], record);
+      index.insert_record(record, rids[i]);
+    }
+  }
+  std::cout << "reinsert " << deleted << " rows: " << elapsed_ms(start) << " ms\n";
+  print_pages("after reinsert", index);
+
+  start = std::chrono::steady_clock::now();
+  rows = run_queries(index, mins, width, schema);
+  std::cout << "range scans after reinsert: " << elapsed_ms(start) << " ms, " << rows << " rows\n";
+
+  return EXIT_SUCCESS;
+}
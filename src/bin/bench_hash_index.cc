@@ -0,0 +1,108 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Point lookups (SELECT * WHERE key = x) through a B+tree and through a hash index over the same column,
+// each index on its own copy of the table. Keys are INT and STR columns.
+
+constexpr int64_t LOOKUP_COUNT = 1'000'000;
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+// returns the number of rows found, and the elapsed milliseconds in `ms`
+int64_t lookup(const std::string& table_name, const std::vector<Value>& keys, double* ms) {
+  Schema schema;
+  catalog.get_table(table_name, &schema);
+  Record record_buf(schema);
+  auto index = catalog.get_index(table_name);
+  std::mt19937_64 rng(1);
+
+  auto start = std::chrono::steady_clock::now();
+
+  int64_t found = 0;
+  for (int64_t i = 0; i < LOOKUP_COUNT; i++) {
+    auto& key = keys[rng() % keys.size()];
+    auto iter = index->get_iter(key, key);
+    iter->begin(record_buf);
+    while (iter->next()) {
+      found++;
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  *ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return found;
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_hash_index [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_hash_index";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  std::vector<int64_t> ids(n);
+  std::vector<std::string> strs(n);
+  std::vector<std::string_view> s(n);
+  std::mt19937_64 rng(0);
+  for (int64_t i = 0; i < n; i++) {
+    ids[i] = rng() % (n * 10);
+    strs[i] = "customer_" + std::to_string(rng() % (n * 10));
+    s[i] = strs[i];
+  }
+
+  std::cout << "records: " << n << ", lookups: " << LOOKUP_COUNT << "\n";
+
+  for (int64_t col_idx : {0, 1}) {
+    std::vector<Value> keys;
+    for (int64_t i = 0; i < n; i++) {
+      keys.push_back(col_idx == 0 ? Value(ids[i]) : Value(strs[i]));
+    }
+
+    for (bool hash : {false, true}) {
+      auto table_name = std::string(hash ? "hash" : "bpt") + std::to_string(col_idx);
+      catalog.create_table(table_name, bench_schema());
+      catalog.get_inserter(table_name).insert({ids.data(), s.data()}, n);
+
+      auto start = std::chrono::steady_clock::now();
+      if (hash) {
+        catalog.create_hash_index(table_name, col_idx);
+      } else {
+        catalog.create_index(table_name, col_idx);
+      }
+      auto end = std::chrono::steady_clock::now();
+      auto build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+      // first run warms up the buffer
+      double ms;
+      lookup(table_name, keys, &ms);
+      auto found = lookup(table_name, keys, &ms);
+      std::cout << (col_idx == 0 ? "INT" : "STR") << " key, " << (hash ? "hash index" : "B+tree")
+                << ": built in " << build_ms << " ms, " << found << " rows found in " << ms << " ms ("
+                << ms * 1'000'000 / LOOKUP_COUNT << " ns per lookup)\n";
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
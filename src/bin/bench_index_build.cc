@@ -0,0 +1,73 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Builds a B+tree over a STR column of the same table with different thread counts and memory budgets
+// (see BPlusTreeBuildOptions). Each build goes to a new copy of the table.
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_index_build [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_index_build";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  std::vector<int64_t> ids(n);
+  std::vector<std::string> strs(n);
+  std::vector<std::string_view> s(n);
+  std::mt19937_64 rng(0);
+  for (int64_t i = 0; i < n; i++) {
+    ids[i] = i;
+    strs[i] = "customer_" + std::to_string(rng() % (n * 10));
+    s[i] = strs[i];
+  }
+
+  std::cout << "records: " << n << ", hardware threads: " << std::thread::hardware_concurrency() << "\n";
+
+  int64_t table = 0;
+  for (size_t thread_count : {1, 2, 4, 8}) {
+    for (size_t memory_budget : {size_t(1) * GB, size_t(8 * 1024 * 1024)}) {
+      auto table_name = "t" + std::to_string(table++);
+      catalog.create_table(table_name, bench_schema());
+      catalog.get_inserter(table_name).insert({ids.data(), s.data()}, n);
+
+      BPlusTreeBuildOptions options;
+      options.thread_count = thread_count;
+      options.memory_budget = memory_budget;
+
+      auto start = std::chrono::steady_clock::now();
+      catalog.create_index(table_name, 1, {}, options);
+      auto end = std::chrono::steady_clock::now();
+
+      std::cout << "threads " << thread_count << ", memory budget " << (memory_budget >> 20) << " MB: "
+                << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
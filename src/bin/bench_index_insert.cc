@@ -0,0 +1,88 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Compares inserting rows into a table having B+tree indexes over a random INT column and over a STR
+// column, with Catalog::insert_record (one descent of each tree per row) and with a TableInserter
+// receiving batches (the entries of each batch are sorted and inserted in one sweep of the leaves)
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"a", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_index_insert [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_index_insert";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  // values are created before measuring, every method receives the same ones
+  std::mt19937_64 rng(0);
+  std::vector<int64_t> ids(n);
+  std::vector<int64_t> as(n);
+  std::vector<std::string> strings(n);
+  std::vector<std::string_view> ss(n);
+  for (int64_t i = 0; i < n; i++) {
+    ids[i] = i;
+    as[i] = static_cast<int64_t>(rng() % (n * 10));
+    strings[i] = "value_number_" + std::to_string(rng() % n);
+    ss[i] = strings[i];
+  }
+
+  for (int64_t batch_size : {0, 1024, 16384}) {
+    auto table_name = "t_" + std::to_string(batch_size);
+    catalog.create_table(table_name, bench_schema());
+    catalog.create_index(table_name, 1);
+    catalog.create_index(table_name, 2);
+
+    auto start = std::chrono::steady_clock::now();
+    if (batch_size == 0) {
+      std::vector<std::variant<std::string_view, int64_t>> values(3);
+      for (int64_t i = 0; i < n; i++) {
+        values[0] = ids[i];
+        values[1] = as[i];
+        values[2] = ss[i];
+        catalog.insert_record(table_name, values);
+      }
+    } else {
+      auto inserter = catalog.get_inserter(table_name);
+      for (int64_t i = 0; i < n; i += batch_size) {
+        auto row_count = std::min(batch_size, n - i);
+        inserter.insert({ids.data() + i, as.data() + i, ss.data() + i}, row_count);
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (batch_size == 0) {
+      std::cout << "Catalog::insert_record:            ";
+    } else {
+      std::cout << "TableInserter, batches of " << batch_size << (batch_size < 10000 ? ":  " : ": ");
+    }
+    std::cout << ms << " ms, " << ms * 1'000'000 / n << " ns per row\n";
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Compares SELECT SUM(a) WHERE id BETWEEN x AND y using a B+tree over `id` that fetches the rows from the
+// heap file against an index-only scan of the same B+tree, having `a` as INCLUDE column.
+// Rows are inserted in random order of id, so consecutive keys are in different heap pages.
+
+constexpr int64_t RANGE_COUNT = 1000;
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"a", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+// returns the sum over all the ranges, and the elapsed milliseconds in `ms`
+int64_t sum_ranges(BPlusTree& index, int64_t n, int64_t range_size, bool index_only, double* ms) {
+  Schema schema;
+  catalog.get_table("t", &schema);
+  Record record_buf(schema);
+  std::mt19937_64 rng(1);
+
+  auto start = std::chrono::steady_clock::now();
+
+  int64_t sum = 0;
+  for (int64_t i = 0; i < RANGE_COUNT; i++) {
+    int64_t min = rng() % n;
+    Value min_value(min);
+    Value max_value(min + range_size - 1);
+    auto iter = index_only ? index.get_index_only_iter(min_value, max_value)
+                           : index.get_iter(min_value, max_value);
+    iter->begin(record_buf);
+    while (iter->next()) {
+      sum += record_buf.values[1].value.as_int;
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  *ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_index_only [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_index_only";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  catalog.create_table("t", bench_schema());
+
+  std::vector<int64_t> ids(n);
+  for (int64_t i = 0; i < n; i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937_64(0));
+
+  auto inserter = catalog.get_inserter("t");
+  std::vector<int64_t> a(n);
+  std::vector<std::string> strs(n);
+  std::vector<std::string_view> s(n);
+  for (int64_t i = 0; i < n; i++) {
+    a[i] = ids[i] % 7;
+    strs[i] = "padding_to_make_rows_wider_" + std::to_string(ids[i]) + std::string(60, 'x');
+    s[i] = strs[i];
+  }
+  inserter.insert({ids.data(), a.data(), s.data()}, n);
+
+  catalog.create_index("t", 0, {1});
+  auto& index = dynamic_cast<BPlusTree&>(*catalog.get_index("t"));
+
+  std::cout << "records: " << n << ", ranges: " << RANGE_COUNT << "\n";
+
+  for (int64_t range_size : {10, 100, 1000}) {
+    if (range_size > n) {
+      break;
+    }
+    // first runs warm up the buffer
+    double ms;
+    sum_ranges(index, n, range_size, false, &ms);
+    auto sum = sum_ranges(index, n, range_size, false, &ms);
+    std::cout << "range " << range_size << " heap fetch SUM(a) = " << sum << " in " << ms << " ms\n";
+
+    sum_ranges(index, n, range_size, true, &ms);
+    sum = sum_ranges(index, n, range_size, true, &ms);
+    std::cout << "range " << range_size << " index-only SUM(a) = " << sum << " in " << ms << " ms\n";
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Compares inserting rows with Catalog::insert_record and with a TableInserter receiving batches
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"a", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_insert [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_insert";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  catalog.create_table("t_record", bench_schema());
+  catalog.create_table("t_inserter", bench_schema());
+
+  // strings are created before measuring, both methods receive the same string_views
+  std::vector<std::string> strings;
+  for (int64_t i = 0; i < 1000; i++) {
+    strings.push_back("value_number_" + std::to_string(i));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::variant<std::string_view, int64_t>> values = {int64_t(0), int64_t(0), std::string_view()};
+  for (int64_t i = 0; i < n; i++) {
+    values[0] = i;
+    values[1] = i % 7;
+    values[2] = std::string_view(strings[i % 1000]);
+    catalog.insert_record("t_record", values);
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << "Catalog::insert_record: " << ms << " ms, " << ms * 1'000'000 / n << " ns per row\n";
+
+  constexpr int64_t BATCH_SIZE = 1024;
+  std::vector<int64_t> ids(BATCH_SIZE);
+  std::vector<int64_t> as(BATCH_SIZE);
+  std::vector<std::string_view> ss(BATCH_SIZE);
+
+  start = std::chrono::steady_clock::now();
+  auto inserter = catalog.get_inserter("t_inserter");
+  std::vector<ColumnSpan> columns = {ids.data(), as.data(), ss.data()};
+  for (int64_t i = 0; i < n; i += BATCH_SIZE) {
+    auto row_count = std::min(BATCH_SIZE, n - i);
+    for (int64_t j = 0; j < row_count; j++) {
+      ids[j] = i + j;
+      as[j] = (i + j) % 7;
+      ss[j] = strings[(i + j) % 1000];
+    }
+    inserter.insert(columns, row_count);
+  }
+  end = std::chrono::steady_clock::now();
+  ms = std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << "TableInserter:          " << ms << " ms, " << ms * 1'000'000 / n << " ns per row\n";
+
+  return EXIT_SUCCESS;
+}
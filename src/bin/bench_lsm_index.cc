@@ -0,0 +1,136 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "storage/lsm/lsm_index.h"
+#include "system/system.h"
+
+constexpr int64_t MB = 1024 * 1024; // 1 MB
+
+constexpr int64_t BATCH_SIZE = 16384;
+
+constexpr int64_t QUERY_COUNT = 1000;
+
+// Compares a table having B+tree indexes over a random INT column and over a STR column with a table
+// having LSM indexes over the same columns: the time to insert the rows (for the LSM indexes, also
+// the time until their background compactions finish), and the time of range scans and point lookups
+// over the INT column. It runs with a buffer bigger than the indexes and with one much smaller.
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"a", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// returns the rows found by the queries over [min, min + width]
+int64_t run_queries(Index& index, const std::vector<int64_t>& mins, int64_t width, const Schema& schema) {
+  ColumnBatch batch(schema);
+  int64_t rows = 0;
+  for (auto min : mins) {
+    auto iter = index.get_iter(Value(min), Value(min + width));
+    while (iter->next_batch(batch)) {
+      rows += batch.size;
+    }
+  }
+  return rows;
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 2'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_lsm_index [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  // values are created before measuring, both tables receive the same ones
+  std::mt19937_64 rng(0);
+  std::vector<int64_t> ids(n);
+  std::vector<int64_t> as(n);
+  std::vector<std::string> strings(n);
+  std::vector<std::string_view> ss(n);
+  for (int64_t i = 0; i < n; i++) {
+    ids[i] = i;
+    as[i] = static_cast<int64_t>(rng() % (n * 10));
+    strings[i] = "value_number_" + std::to_string(rng() % n);
+    ss[i] = strings[i];
+  }
+  std::vector<int64_t> query_mins(QUERY_COUNT);
+  for (auto& min : query_mins) {
+    min = static_cast<int64_t>(rng() % (n * 10));
+  }
+
+  for (int64_t buffer_mb : {1024, 32}) {
+    std::string database_folder = "data/bench_lsm_index";
+    std::filesystem::remove_all(database_folder);
+
+    // Need to call System::init before start using the database
+    // When this object comes out of scope the database is no longer usable
+    auto system = System::init(database_folder, buffer_mb * MB);
+    std::cout << "Buffer of " << buffer_mb << " MB\n";
+
+    for (auto index_type : {IndexType::B_PLUS_TREE, IndexType::LSM}) {
+      std::string table_name = index_type == IndexType::LSM ? "t_lsm" : "t_bpt";
+      catalog.create_table(table_name, bench_schema());
+      if (index_type == IndexType::LSM) {
+        catalog.create_lsm_index(table_name, 1);
+        catalog.create_lsm_index(table_name, 2);
+      } else {
+        catalog.create_index(table_name, 1);
+        catalog.create_index(table_name, 2);
+      }
+      std::cout << (index_type == IndexType::LSM ? "LSM index:\n" : "B+tree:\n");
+
+      auto start = std::chrono::steady_clock::now();
+      auto inserter = catalog.get_inserter(table_name);
+      for (int64_t i = 0; i < n; i += BATCH_SIZE) {
+        auto row_count = std::min(BATCH_SIZE, n - i);
+        inserter.insert({ids.data() + i, as.data() + i, ss.data() + i}, row_count);
+      }
+      auto ingest_ms = elapsed_ms(start);
+      std::cout << "  insert:              " << ingest_ms << " ms, " << ingest_ms * 1'000'000 / n
+                << " ns per row\n";
+
+      if (index_type == IndexType::LSM) {
+        for (auto& index : catalog.get_indexes(table_name)) {
+          dynamic_cast<LSMIndex&>(*index).wait_for_compactions();
+        }
+        auto total_ms = elapsed_ms(start);
+        std::cout << "  insert + compaction: " << total_ms << " ms, " << total_ms * 1'000'000 / n
+                  << " ns per row\n";
+
+        std::cout << "  runs per level:     ";
+        auto& index = dynamic_cast<LSMIndex&>(*catalog.get_index(table_name));
+        for (auto run_count : index.get_run_counts()) {
+          std::cout << " " << run_count;
+        }
+        std::cout << "\n";
+      }
+
+      auto& schema = *catalog.get_table_info(table_name).schema;
+      auto& index = *catalog.get_index(table_name);
+      for (int64_t width : {0, 1000, 100'000}) {
+        start = std::chrono::steady_clock::now();
+        auto rows = run_queries(index, query_mins, width, schema);
+        auto ms = elapsed_ms(start);
+        std::cout << "  scan of width " << width << ": " << ms * 1000 / QUERY_COUNT << " us per query, "
+                  << static_cast<double>(rows) / QUERY_COUNT << " rows per query\n";
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
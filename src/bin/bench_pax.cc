@@ -0,0 +1,97 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Compares a single column aggregate (SUM) over the same data stored in ROW and PAX format
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"a", DataType::INT},
+      {"b", DataType::INT},
+      {"c", DataType::INT},
+      {"s1", DataType::STR},
+      {"s2", DataType::STR},
+      {"s3", DataType::STR},
+      {"s4", DataType::STR},
+  });
+}
+
+void populate(const std::string& table_name, int64_t n) {
+  for (int64_t i = 0; i < n; i++) {
+    auto str = "value_number_" + std::to_string(i % 1000);
+    catalog.insert_record(table_name, {i, i % 7, i % 13, i % 101, str, str, str, str});
+  }
+}
+
+// returns the sum of column `b`, and the elapsed milliseconds in `ms`
+int64_t sum_column(const std::string& table_name, bool use_projection, double* ms) {
+  Schema schema;
+  HeapFile* heap_file = catalog.get_table(table_name, &schema);
+
+  std::vector<bool> projection;
+  if (use_projection) {
+    projection = {false, false, true, false, false, false, false, false};
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  Record record_buf(schema);
+  auto iter = heap_file->get_record_iter(projection);
+  iter->begin(record_buf);
+  int64_t sum = 0;
+  while (iter->next()) {
+    sum += record_buf.values[2].value.as_int;
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  *ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_pax [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_pax";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  catalog.create_table("t_row", bench_schema(), TableFormat::ROW);
+  catalog.create_table("t_pax", bench_schema(), TableFormat::PAX);
+  populate("t_row", n);
+  populate("t_pax", n);
+
+  std::cout << "records: " << n << "\n";
+  std::cout << "pages ROW: " << file_mgr.count_pages(catalog.get_table_info("t_row").heap_file->file_id)
+            << ", pages PAX: " << file_mgr.count_pages(catalog.get_table_info("t_pax").heap_file->file_id)
+            << "\n";
+
+  for (bool use_projection : {false, true}) {
+    for (auto table_name : {"t_row", "t_pax"}) {
+      // first run warms up the buffer
+      double ms;
+      sum_column(table_name, use_projection, &ms);
+      auto sum = sum_column(table_name, use_projection, &ms);
+      std::cout << table_name << (use_projection ? " projected" : " full record") << " SUM(b) = " << sum
+                << " in " << ms << " ms\n";
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/b_plus_tree/b_plus_tree_slot_search.h"
+#include "storage/heap_file/heap_file.h"
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Point lookups (index-only scans with min = max) on B+trees over an INT and a STR column, with each
+// implementation of the search inside the nodes supported by the CPU (see BPlusTreeSlotSearch), and with
+// the best one reading every dir from its page instead of the copy of the upper levels (see
+// BPlusTreeDirCache). Then it deletes most rows of a table indexed over the INT column with and without
+// the copy, as the merges make it read the copy again.
+
+constexpr int64_t LOOKUP_COUNT = 1'000'000;
+
+// percentage of the rows deleted
+constexpr int64_t DELETE_PERCENT = 90;
+
+Schema bench_schema() {
+  return Schema({
+      {"id", DataType::INT},
+      {"s", DataType::STR},
+  });
+}
+
+const char* get_name(BPlusTreeSlotSearch::Implementation implementation) {
+  switch (implementation) {
+  case BPlusTreeSlotSearch::Implementation::SCALAR:
+    return "scalar";
+  case BPlusTreeSlotSearch::Implementation::SSE42:
+    return "SSE4.2";
+  case BPlusTreeSlotSearch::Implementation::AVX2:
+    return "AVX2";
+  }
+  return ""; // unreachable
+}
+
+// returns the number of lookups that found their key, and the elapsed milliseconds in `ms`
+int64_t lookup(BPlusTree& index, const std::vector<Value>& keys, double* ms) {
+  Record record_buf(index.heap_file.schema);
+  std::mt19937_64 rng(1);
+
+  auto start = std::chrono::steady_clock::now();
+
+  int64_t found = 0;
+  for (int64_t i = 0; i < LOOKUP_COUNT; i++) {
+    auto& key = keys[rng() % keys.size()];
+    auto iter = index.get_index_only_iter(key, key);
+    iter->begin(record_buf);
+    while (iter->next()) {
+      found++;
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  *ms = std::chrono::duration<double, std::milli>(end - start).count();
+  return found;
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_point_lookup [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_point_lookup";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  std::vector<int64_t> ids(n);
+  std::vector<std::string> strs(n);
+  std::vector<std::string_view> s(n);
+  std::mt19937_64 rng(0);
+  for (int64_t i = 0; i < n; i++) {
+    ids[i] = rng() % (n * 10);
+    strs[i] = "customer_" + std::to_string(rng() % (n * 10));
+    s[i] = strs[i];
+  }
+
+  std::cout << "records: " << n << ", lookups: " << LOOKUP_COUNT << "\n";
+
+  for (int64_t col_idx : {0, 1}) {
+    auto table_name = "t" + std::to_string(col_idx);
+    catalog.create_table(table_name, bench_schema());
+    catalog.get_inserter(table_name).insert({ids.data(), s.data()}, n);
+    catalog.create_index(table_name, col_idx);
+    auto& index = dynamic_cast<BPlusTree&>(*catalog.get_index(table_name));
+
+    std::vector<Value> keys;
+    for (int64_t i = 0; i < n; i++) {
+      keys.push_back(col_idx == 0 ? Value(ids[i]) : Value(strs[i]));
+    }
+
+    for (auto implementation : {BPlusTreeSlotSearch::Implementation::SCALAR,
+                                BPlusTreeSlotSearch::Implementation::SSE42,
+                                BPlusTreeSlotSearch::Implementation::AVX2}) {
+      if (!BPlusTreeSlotSearch::set_implementation(implementation)) {
+        continue;
+      }
+      // first run warms up the buffer
+      double ms;
+      lookup(index, keys, &ms);
+      auto found = lookup(index, keys, &ms);
+      std::cout << (col_idx == 0 ? "INT" : "STR") << " key, " << get_name(implementation) << ": " << found
+                << " found in " << ms << " ms (" << ms * 1'000'000 / LOOKUP_COUNT << " ns per lookup)\n";
+    }
+
+    index.set_dir_cache_enabled(false);
+    double ms;
+    auto found = lookup(index, keys, &ms);
+    auto implementation = BPlusTreeSlotSearch::get_implementation();
+    std::cout << (col_idx == 0 ? "INT" : "STR") << " key, " << get_name(implementation)
+              << " without dir cache: " << found << " found in " << ms << " ms ("
+              << ms * 1'000'000 / LOOKUP_COUNT << " ns per lookup)\n";
+  }
+
+  for (bool dir_cache_enabled : {true, false}) {
+    auto table_name = std::string(dir_cache_enabled ? "d_cache" : "d_no_cache");
+    Schema schema;
+    catalog.create_table(table_name, bench_schema());
+    catalog.get_inserter(table_name).insert({ids.data(), s.data()}, n);
+    catalog.create_index(table_name, 0);
+    auto& index = dynamic_cast<BPlusTree&>(*catalog.get_index(table_name));
+    index.set_dir_cache_enabled(dir_cache_enabled);
+
+    std::vector<RID> rids;
+    {
+      auto iter = catalog.get_table(table_name, &schema)->get_record_iter();
+      Record record(schema);
+      iter->begin(record);
+      while (iter->next()) {
+        rids.push_back(iter->get_current_RID());
+      }
+    }
+    std::shuffle(rids.begin(), rids.end(), std::mt19937_64(2));
+    auto delete_count = static_cast<int64_t>(rids.size()) * DELETE_PERCENT / 100;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < delete_count; i++) {
+      catalog.delete_record(table_name, rids[i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "INT key, delete " << DELETE_PERCENT << "% " << (dir_cache_enabled ? "with" : "without")
+              << " dir cache: " << delete_count << " rows in " << ms << " ms ("
+              << ms * 1'000'000 / delete_count << " ns per delete)\n";
+  }
+
+  return EXIT_SUCCESS;
+}
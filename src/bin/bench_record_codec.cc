@@ -0,0 +1,104 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "storage/heap_file/heap_file_page.h"
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Compares the decode throughput of the generic record decoding against the specialized RecordCodec
+
+void populate(const std::string& table_name, const Schema& schema, int64_t n) {
+  std::vector<std::variant<std::string_view, int64_t>> values(schema.columns.size());
+  std::string str_buf;
+  for (int64_t i = 0; i < n; i++) {
+    str_buf = "some_string_" + std::to_string(i % 1000);
+    for (size_t c = 0; c < schema.columns.size(); c++) {
+      if (schema.columns[c].datatype == DataType::INT) {
+        values[c] = int64_t(i + c);
+      } else {
+        values[c] = std::string_view(str_buf);
+      }
+    }
+    catalog.insert_record(table_name, values);
+  }
+}
+
+// decodes every record of the table, returns the elapsed milliseconds
+double decode_all(const HeapFile& heap_file, const RecordCodecDispatch* codec, int64_t* checksum) {
+  Record record_buf(heap_file.schema);
+  auto total_pages = file_mgr.count_pages(heap_file.file_id);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t page_number = 0; page_number < total_pages; page_number++) {
+    HeapFilePage page(heap_file.file_id, page_number, heap_file.dictionaries, codec);
+    auto dir_count = page.get_dir_count();
+    for (int32_t i = 0; i < dir_count; i++) {
+      if (page.get_record(i, record_buf)) {
+        *checksum += record_buf.values[0].datatype == DataType::INT ? record_buf.values[0].value.as_int
+                                                                    : record_buf.values[0].value.as_str[0];
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 1'000'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_record_codec [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_record_codec";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  std::vector<std::pair<std::string, Schema>> tables = {
+      {"int_str_int", Schema({{"a", DataType::INT}, {"b", DataType::STR}, {"c", DataType::INT}})},
+      {"int4",
+       Schema({{"a", DataType::INT}, {"b", DataType::INT}, {"c", DataType::INT}, {"d", DataType::INT}})},
+      {"str_int_int_str",
+       Schema({{"a", DataType::STR}, {"b", DataType::INT}, {"c", DataType::INT}, {"d", DataType::STR}})},
+  };
+
+  std::cout << "records: " << n << "\n";
+  for (auto& [table_name, schema] : tables) {
+    HeapFile* heap_file = catalog.create_table(table_name, schema);
+    populate(table_name, schema, n);
+
+    auto codec = get_record_codec(schema);
+    if (codec == nullptr) {
+      std::cout << table_name << ": no specialized codec\n";
+      continue;
+    }
+
+    int64_t generic_checksum = 0;
+    int64_t specialized_checksum = 0;
+    // first runs warm up the buffer
+    decode_all(*heap_file, nullptr, &generic_checksum);
+    decode_all(*heap_file, codec, &specialized_checksum);
+
+    auto generic_ms = decode_all(*heap_file, nullptr, &generic_checksum);
+    auto specialized_ms = decode_all(*heap_file, codec, &specialized_checksum);
+
+    if (generic_checksum != specialized_checksum) {
+      std::cout << table_name << ": ERROR, decoded records are different\n";
+      return EXIT_FAILURE;
+    }
+    std::cout << table_name << ": generic " << generic_ms << " ms (" << n / generic_ms / 1000
+              << " M records/s), specialized " << specialized_ms << " ms (" << n / specialized_ms / 1000
+              << " M records/s)\n";
+  }
+  return EXIT_SUCCESS;
+}
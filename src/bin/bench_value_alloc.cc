@@ -0,0 +1,160 @@
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "system/system.h"
+
+constexpr int64_t GB = 1024 * 1024 * 1024; // 1 GB
+
+// Counts the heap allocations per row done when inserting, scanning and copying records with a short and a
+// long STR column, and the allocations per query of small queries using a heap or an arena Record
+
+static int64_t allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+  allocations++;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void report(const std::string& name, int64_t allocations_before, int64_t n, const char* unit = "row") {
+  std::cout << name << ": " << static_cast<double>(allocations - allocations_before) / n
+            << " allocations per " << unit << "\n";
+}
+
+// SELECT * WHERE id < 10, returns the sum of the first character of `long_str`
+int64_t query(const HeapFile& heap_file, Record& record_buf) {
+  std::vector<ColumnPredicate> predicates;
+  predicates.emplace_back(0, CompareOp::LT, Value(int64_t(10)));
+  auto iter = heap_file.get_filtered_iter(std::move(predicates));
+  iter->begin(record_buf);
+  int64_t res = 0;
+  while (iter->next()) {
+    res += record_buf.values[2].value.as_str[0];
+  }
+  return res;
+}
+
+int main(int argc, char** argv) {
+  int64_t n = 100'000;
+  if (argc == 2) {
+    n = atol(argv[1]);
+  }
+  if (n <= 0) {
+    std::cout << "Usage: bench_value_alloc [record_count]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string database_folder = "data/bench_value_alloc";
+  std::filesystem::remove_all(database_folder);
+
+  // Need to call System::init before start using the database
+  // When this object comes out of scope the database is no longer usable
+  auto system = System::init(database_folder, 1 * GB);
+
+  Schema schema({
+      {"id", DataType::INT},
+      {"short_str", DataType::STR},
+      {"long_str", DataType::STR},
+  });
+  catalog.create_table("t", schema);
+
+  const std::string short_str = "short_value";
+  const std::string long_str = "a_long_string_value_that_does_not_fit_inline";
+
+  std::vector<std::variant<std::string_view, int64_t>> values = {int64_t(0), short_str, long_str};
+
+  auto allocations_before = allocations;
+  for (int64_t i = 0; i < n; i++) {
+    values[0] = i;
+    catalog.insert_record("t", values);
+  }
+  report("insert", allocations_before, n);
+
+  HeapFile* heap_file = catalog.get_table("t", &schema);
+  Record record_buf(schema);
+
+  allocations_before = allocations;
+  auto iter = heap_file->get_record_iter();
+  iter->begin(record_buf);
+  while (iter->next()) { }
+  report("scan", allocations_before, n);
+
+  int64_t total_len = 0;
+  allocations_before = allocations;
+  iter->reset();
+  while (iter->next()) {
+    Value key = record_buf.values[1];
+    total_len += key.value.as_str[0];
+  }
+  report("scan + copy short STR", allocations_before, n);
+
+  allocations_before = allocations;
+  iter->reset();
+  while (iter->next()) {
+    Value key = record_buf.values[2];
+    total_len += key.value.as_str[0];
+  }
+  report("scan + copy long STR", allocations_before, n);
+
+  allocations_before = allocations;
+  iter->reset();
+  std::pmr::vector<Value> row = record_buf.values;
+  while (iter->next()) {
+    row = record_buf.values;
+    total_len += row[1].value.as_str[0];
+  }
+  report("scan + assign row", allocations_before, n);
+
+  constexpr int64_t QUERIES = 1000;
+  allocations_before = allocations;
+  for (int64_t i = 0; i < QUERIES; i++) {
+    Record query_record(schema);
+    total_len += query(*heap_file, query_record);
+  }
+  report("query with heap Record", allocations_before, QUERIES, "query");
+
+  Arena arena;
+  allocations_before = allocations;
+  for (int64_t i = 0; i < QUERIES; i++) {
+    {
+      Record query_record(schema, arena);
+      total_len += query(*heap_file, query_record);
+    }
+    arena.reset();
+  }
+  report("query with arena Record", allocations_before, QUERIES, "query");
+
+  // avoids the copies being optimized away
+  return total_len == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
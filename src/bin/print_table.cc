@@ -42,7 +42,8 @@ int main(int argc, char* argv[]) {
 
     auto iter = heap_file->get_record_iter();
 
-    Record record_buf(schema);
+    Arena arena;
+    Record record_buf(schema, arena);
     iter->begin(record_buf);
     while (iter->next()) {
       std::cout << record_buf << '\n';
@@ -58,7 +58,7 @@ int main(int argc, char** argv) {
       catalog.insert_record(table1, {"test_record_" + std::to_string(count++), i});
     }
 
-    auto iter = index->get_iter(Value(0LL), Value(99999999LL));
+    auto iter = index->get_iter(Value(int64_t(0)), Value(int64_t(99999999)));
 
     Record& record_buf = catalog.get_record_buf(table1);
     iter->begin(record_buf);
@@ -0,0 +1,53 @@
+#include "batch_tuple_iter.h"
+
+BatchTupleIter::BatchTupleIter(std::unique_ptr<RelationIter> source, const Schema& schema)
+    : source(std::move(source)),
+      batch(schema) {}
+
+void BatchTupleIter::begin(Record& out) {
+  this->out = &out;
+}
+
+bool BatchTupleIter::next() {
+  if (batch_pos == batch.size) {
+    if (!source->next_batch(batch)) {
+      return false;
+    }
+    batch_pos = 0;
+  }
+  batch.read_record(batch_pos++, *out);
+  return true;
+}
+
+bool BatchTupleIter::next_batch(ColumnBatch& out_batch) {
+  // rows already buffered are returned first
+  out_batch.clear();
+  while (batch_pos < batch.size) {
+    // out_batch can hold a whole batch, so it can't get full here
+    for (size_t col = 0; col < batch.columns.size(); col++) {
+      switch (batch.columns[col].datatype) {
+      case DataType::INT: {
+        out_batch.columns[col].ints[out_batch.size] = batch.get_int(col, batch_pos);
+        break;
+      }
+      case DataType::STR: {
+        auto str = batch.get_str(col, batch_pos);
+        out_batch.set_str(col, out_batch.size, str.data(), str.size());
+        break;
+      }
+      }
+    }
+    out_batch.size++;
+    batch_pos++;
+  }
+  if (out_batch.size > 0) {
+    return true;
+  }
+  return source->next_batch(out_batch);
+}
+
+void BatchTupleIter::reset() {
+  source->reset();
+  batch.clear();
+  batch_pos = 0;
+}
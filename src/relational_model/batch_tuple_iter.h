@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+
+#include "relational_model/column_batch.h"
+#include "relational_model/relation_iter.h"
+
+// Adapter for tuple-at-a-time consumers: reads batches from `source` and returns one row per call to next().
+class BatchTupleIter : public RelationIter {
+public:
+  BatchTupleIter(std::unique_ptr<RelationIter> source, const Schema& schema);
+
+  virtual void begin(Record& out) override;
+
+  virtual bool next() override;
+
+  virtual bool next_batch(ColumnBatch& batch) override;
+
+  virtual void reset() override;
+
+private:
+  std::unique_ptr<RelationIter> source;
+
+  ColumnBatch batch;
+
+  // next row of batch to return
+  size_t batch_pos = 0;
+
+  Record* out;
+};
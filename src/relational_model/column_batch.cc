@@ -0,0 +1,76 @@
+#include "column_batch.h"
+
+#include <cassert>
+#include <cstring>
+
+ColumnBatch::ColumnBatch(const Schema& schema) {
+  columns.resize(schema.columns.size());
+  for (size_t i = 0; i < schema.columns.size(); i++) {
+    auto& column = columns[i];
+    column.datatype = schema.columns[i].datatype;
+    switch (column.datatype) {
+    case DataType::INT: {
+      column.ints.resize(CAPACITY);
+      break;
+    }
+    case DataType::STR: {
+      column.str_offsets.resize(CAPACITY);
+      column.str_lens.resize(CAPACITY);
+      column.chars.resize(CAPACITY * (Value::MAX_STRLEN + 1));
+      break;
+    }
+    }
+  }
+}
+
+void ColumnBatch::clear() {
+  size = 0;
+  for (auto& column : columns) {
+    column.chars_used = 0;
+  }
+}
+
+void ColumnBatch::set_str(size_t col, size_t row, const char* str, size_t len) {
+  auto& column = columns[col];
+  assert(column.datatype == DataType::STR);
+  assert(column.chars_used + len + 1 <= column.chars.size());
+  column.str_offsets[row] = column.chars_used;
+  column.str_lens[row] = len;
+  std::memcpy(column.chars.data() + column.chars_used, str, len);
+  column.chars[column.chars_used + len] = '\0';
+  column.chars_used += len + 1;
+}
+
+void ColumnBatch::append_record(const Record& record) {
+  assert(!full());
+  for (size_t col = 0; col < columns.size(); col++) {
+    auto& v = record.values[col];
+    switch (v.datatype) {
+    case DataType::INT: {
+      columns[col].ints[size] = v.value.as_int;
+      break;
+    }
+    case DataType::STR: {
+      set_str(col, size, v.value.as_str, strlen(v.value.as_str));
+      break;
+    }
+    }
+  }
+  size++;
+}
+
+void ColumnBatch::read_record(size_t row, Record& out) const {
+  for (size_t col = 0; col < columns.size(); col++) {
+    auto& column = columns[col];
+    switch (column.datatype) {
+    case DataType::INT: {
+      out.values[col].value.as_int = column.ints[row];
+      break;
+    }
+    case DataType::STR: {
+      out.values[col].set_str(column.chars.data() + column.str_offsets[row], column.str_lens[row]);
+      break;
+    }
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "relational_model/record.h"
+#include "relational_model/schema.h"
+
+// Holds up to CAPACITY rows stored by column, used by RelationIter::next_batch.
+// The memory is allocated once, so filling a batch again does not allocate.
+class ColumnBatch {
+public:
+  static constexpr size_t CAPACITY = 1024;
+
+  struct Column {
+    DataType datatype;
+
+    // INT values, CAPACITY elements
+    std::vector<int64_t> ints;
+
+    // STR values: start of each string in `chars`, CAPACITY elements. Strings are null-terminated
+    std::vector<uint32_t> str_offsets;
+
+    // STR values: length of each string, CAPACITY elements
+    std::vector<uint8_t> str_lens;
+
+    // STR values: CAPACITY * (Value::MAX_STRLEN + 1) bytes, the first chars_used are in use
+    std::vector<char> chars;
+
+    size_t chars_used = 0;
+  };
+
+  ColumnBatch(const Schema& schema);
+
+  // prevent accidental copies
+  ColumnBatch(const ColumnBatch& other) = delete;
+
+  std::vector<Column> columns;
+
+  // rows in the batch, all the columns have this number of values (except the columns not projected by the
+  // producer, whose values are undefined)
+  size_t size = 0;
+
+  bool full() const {
+    return size == CAPACITY;
+  }
+
+  void clear();
+
+  int64_t get_int(size_t col, size_t row) const {
+    return columns[col].ints[row];
+  }
+
+  std::string_view get_str(size_t col, size_t row) const {
+    auto& column = columns[col];
+    return std::string_view(column.chars.data() + column.str_offsets[row], column.str_lens[row]);
+  }
+
+  // strings of a column must be set in increasing row order
+  void set_str(size_t col, size_t row, const char* str, size_t len);
+
+  // appends a new row with the values of the record
+  void append_record(const Record& record);
+
+  // writes the values of the row into out
+  void read_record(size_t row, Record& out) const;
+};
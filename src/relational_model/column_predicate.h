@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "relational_model/value.h"
+
+enum class CompareOp { EQ, NE, LT, LE, GT, GE };
+
+// returns true if `cmp` (the result of comparing a column value against a constant, with the same
+// convention of strcmp) satisfies `op`
+inline bool compare_matches(CompareOp op, int cmp) {
+  switch (op) {
+  case CompareOp::EQ:
+    return cmp == 0;
+  case CompareOp::NE:
+    return cmp != 0;
+  case CompareOp::LT:
+    return cmp < 0;
+  case CompareOp::LE:
+    return cmp <= 0;
+  case CompareOp::GT:
+    return cmp > 0;
+  case CompareOp::GE:
+    return cmp >= 0;
+  }
+  return false; // unreachable
+}
+
+// Simple predicate of the form `column op constant`. A list of predicates is interpreted as a conjunction.
+struct ColumnPredicate {
+  int64_t col_idx;
+  CompareOp op;
+  Value constant;
+
+  // only used when the column is dictionary encoded (see StringDictionary::bind).
+  // matching_codes[code] tells if the string with that code satisfies the predicate
+  std::vector<bool> matching_codes;
+
+  ColumnPredicate(int64_t col_idx, CompareOp op, Value constant)
+      : col_idx(col_idx),
+        op(op),
+        constant(std::move(constant)) {}
+};
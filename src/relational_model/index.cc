@@ -0,0 +1,14 @@
+#include "index.h"
+
+#include "exceptions/exceptions.h"
+
+void Index::check_bound(const std::vector<Value>& bound, const std::vector<DataType>& key_datatypes) {
+  if (bound.size() > key_datatypes.size()) {
+    throw QueryException("index range has more values than key columns");
+  }
+  for (size_t i = 0; i < bound.size(); i++) {
+    if (bound[i].datatype != key_datatypes[i]) {
+      throw QueryException("index range must have the same datatypes than the key");
+    }
+  }
+}
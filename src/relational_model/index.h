@@ -1,25 +1,45 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
+#include "relational_model/record.h"
 #include "relational_model/relation_iter.h"
 #include "relational_model/value.h"
 #include "storage/heap_file/rid.h"
 
-enum class IndexType { NONE, B_PLUS_TREE };
+enum class IndexType { NONE, B_PLUS_TREE, HASH, LSM, ART };
 
 class Index {
   friend class Catalog;
+  friend class TableInserter;
 
 public:
   virtual ~Index() = default;
 
-  virtual std::unique_ptr<RelationIter> get_iter(const Value& min, const Value& max) = 0;
+  // returns the records with min <= key <= max, where keys are compared column by column. min and max
+  // may have fewer values than key columns, bounding only the first columns of the key
+  virtual std::unique_ptr<RelationIter> get_iter(
+      const std::vector<Value>& min, const std::vector<Value>& max
+  ) = 0;
+
+  // bounds only the first key column
+  std::unique_ptr<RelationIter> get_iter(const Value& min, const Value& max) {
+    return get_iter(std::vector<Value>{min}, std::vector<Value>{max});
+  }
 
   virtual IndexType get_type() = 0;
 
+  // positions of the key columns in the schema of the table, in the order they are compared
+  virtual const std::vector<int64_t>& get_key_columns() const = 0;
+
+protected:
+  // throws a QueryException if the values of a range bound are not the datatypes of the first key columns
+  static void check_bound(const std::vector<Value>& bound, const std::vector<DataType>& key_datatypes);
+
 private:
-  virtual void insert_record(RID rid) = 0;
+  // `record` is the row stored at `rid`, read once for all the indexes of the table
+  virtual void insert_record(const Record& record, RID rid) = 0;
 
-  virtual void delete_record(RID rid) = 0;
+  virtual void delete_record(const Record& record, RID rid) = 0;
 };
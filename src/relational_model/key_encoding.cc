@@ -0,0 +1,35 @@
+#include "key_encoding.h"
+
+size_t KeyEncoding::encode(const Value& value, char* out) {
+  switch (value.datatype) {
+  case DataType::INT:
+    return encode_int(value.value.as_int, out);
+  case DataType::STR:
+    return encode_str(value.value.as_str, std::strlen(value.value.as_str), out);
+  }
+  return 0; // unreachable
+}
+
+size_t KeyEncoding::encode(const Record& record, const std::vector<int64_t>& columns, char* out) {
+  size_t size = 0;
+  for (auto col : columns) {
+    size += encode(record.values[col], out + size);
+  }
+  return size;
+}
+
+size_t KeyEncoding::encode(const std::vector<Value>& values, char* out) {
+  size_t size = 0;
+  for (auto& value : values) {
+    size += encode(value, out + size);
+  }
+  return size;
+}
+
+size_t KeyEncoding::max_encoded_size(const Schema& schema, const std::vector<int64_t>& columns) {
+  size_t size = 0;
+  for (auto col : columns) {
+    size += max_encoded_size(schema.columns[col].datatype);
+  }
+  return size;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "relational_model/record.h"
+#include "relational_model/value.h"
+
+/*
+  Order preserving binary encoding of values. Two keys encoded from values (or tuples of values) with the
+  same datatypes compare with KeyEncoding::compare, a single memcmp, in the same order as Value::operator<
+  compares the values (lexicographically for tuples).
+
+  Encoding of each datatype:
+  - INT: 8 bytes big-endian, with the sign bit flipped so negative numbers go first
+  - STR: the bytes of the string followed by a 0x00 terminator. Strings of a Value never contain 0x00,
+    so the terminator is lower than any byte of a longer string with the same prefix
+  A composite key is the concatenation of the encodings of its columns.
+ */
+class KeyEncoding {
+public:
+  static constexpr size_t INT_SIZE = sizeof(int64_t);
+
+  static constexpr size_t MAX_STR_SIZE = Value::MAX_STRLEN + 1;
+
+  // max size of the encoding of a single value of any datatype
+  static constexpr size_t MAX_VALUE_SIZE = MAX_STR_SIZE;
+
+  static constexpr size_t max_encoded_size(DataType datatype) {
+    switch (datatype) {
+    case DataType::INT:
+      return INT_SIZE;
+    case DataType::STR:
+      return MAX_STR_SIZE;
+    }
+    return 0; // unreachable
+  }
+
+  static size_t encode_int(int64_t value, char* out) {
+    uint64_t flipped = static_cast<uint64_t>(value) ^ (UINT64_C(1) << 63);
+    for (size_t i = 0; i < INT_SIZE; i++) {
+      out[i] = static_cast<char>(flipped >> (8 * (INT_SIZE - 1 - i)));
+    }
+    return INT_SIZE;
+  }
+
+  static int64_t decode_int(const char* in) {
+    uint64_t flipped = 0;
+    for (size_t i = 0; i < INT_SIZE; i++) {
+      flipped = (flipped << 8) | static_cast<unsigned char>(in[i]);
+    }
+    return static_cast<int64_t>(flipped ^ (UINT64_C(1) << 63));
+  }
+
+  static size_t encode_str(const char* str, size_t len, char* out) {
+    std::memcpy(out, str, len);
+    out[len] = '\0';
+    return len + 1;
+  }
+
+  // returns the string at the beginning of `in`, that must be an encoded STR
+  static std::string_view decode_str(const char* in) {
+    return std::string_view(in);
+  }
+
+  // returns the number of bytes written into out, at most MAX_VALUE_SIZE
+  static size_t encode(const Value& value, char* out);
+
+  // encodes the composite key formed by `columns` of the record, returns the number of bytes written
+  // into out, that must have space for columns.size() * MAX_VALUE_SIZE bytes
+  static size_t encode(const Record& record, const std::vector<int64_t>& columns, char* out);
+
+  // encodes the composite key formed by the values, used for the bounds of index ranges
+  static size_t encode(const std::vector<Value>& values, char* out);
+
+  static std::string encode(const std::vector<Value>& values) {
+    std::string res(values.size() * MAX_VALUE_SIZE, '\0');
+    res.resize(encode(values, res.data()));
+    return res;
+  }
+
+  // max size of the composite key formed by `columns` of the schema
+  static size_t max_encoded_size(const Schema& schema, const std::vector<int64_t>& columns);
+
+  // returns the size of the encoding of a value of `datatype` starting at `in`
+  static size_t encoded_size(DataType datatype, const char* in) {
+    switch (datatype) {
+    case DataType::INT:
+      return INT_SIZE;
+    case DataType::STR:
+      return std::strlen(in) + 1;
+    }
+    return 0; // unreachable
+  }
+
+  // compares two encoded keys, with the same convention of memcmp. When one key is a prefix of the other
+  // the shorter one goes first
+  static int compare(const char* lhs, size_t lhs_len, const char* rhs, size_t rhs_len) {
+    int cmp = std::memcmp(lhs, rhs, lhs_len < rhs_len ? lhs_len : rhs_len);
+    if (cmp != 0) {
+      return cmp;
+    }
+    return lhs_len < rhs_len ? -1 : (rhs_len < lhs_len ? 1 : 0);
+  }
+
+  // true if the key is greater than max_key, comparing only the columns max_key has. The encoding of each
+  // column ends where it does in max_key, so comparing the first bytes of the key compares its first columns
+  static bool is_after_max(const char* key, size_t key_len, const char* max_key, size_t max_key_len) {
+    auto compared_len = key_len < max_key_len ? key_len : max_key_len;
+    return compare(key, compared_len, max_key, max_key_len) > 0;
+  }
+
+  // int64 with the order of the first 8 bytes of an encoded key (missing bytes count as 0x00), so
+  // comparing two of them as signed integers is the same as comparing the prefixes with memcmp
+  static int64_t prefix64(const char* key, size_t len) {
+    uint64_t res = 0;
+    for (size_t i = 0; i < INT_SIZE; i++) {
+      res <<= 8;
+      if (i < len) {
+        res |= static_cast<unsigned char>(key[i]);
+      }
+    }
+    return static_cast<int64_t>(res ^ (UINT64_C(1) << 63));
+  }
+};
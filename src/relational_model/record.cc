@@ -4,6 +4,7 @@
 #include <cstring>
 
 Record::Record(const Schema& schema) {
+  values.reserve(schema.columns.size());
   for (const auto& col : schema.columns) {
     switch (col.datatype) {
     case DataType::INT: {
@@ -18,6 +19,24 @@ Record::Record(const Schema& schema) {
   }
 }
 
+Record::Record(const Schema& schema, Arena& arena)
+    : values(&arena) {
+  values.reserve(schema.columns.size());
+  for (const auto& col : schema.columns) {
+    switch (col.datatype) {
+    case DataType::INT: {
+      values.push_back(Value((int64_t)0));
+      break;
+    }
+    case DataType::STR: {
+      values.push_back(Value(""));
+      values.back().set_buffer(arena.allocate_buffer(Value::MAX_STRLEN + 1));
+      break;
+    }
+    }
+  }
+}
+
 void Record::set(const std::vector<std::variant<std::string_view, int64_t>>& new_values) {
   assert(new_values.size() == values.size());
 
@@ -33,8 +52,7 @@ void Record::set(const std::vector<std::variant<std::string_view, int64_t>>& new
     case DataType::STR: {
       assert(std::holds_alternative<std::string_view>(value));
       auto& str = std::get<std::string_view>(value);
-      assert(str.size() <= Value::MAX_STRLEN);
-      memcpy(values[i].value.as_str, str.data(), str.size() + 1);
+      values[i].set_str(str.data(), str.size());
       break;
     }
     }
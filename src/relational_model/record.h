@@ -1,17 +1,22 @@
 #pragma once
 
 #include <cstdint>
+#include <memory_resource>
 #include <ostream>
 #include <variant>
 #include <vector>
 
 #include "relational_model/schema.h"
 #include "relational_model/value.h"
+#include "system/arena.h"
 
 class Record {
 public:
   Record(const Schema& schema);
 
+  // the values and the buffers of STR values are allocated in the arena, that must outlive the record
+  Record(const Schema& schema, Arena& arena);
+
   Record(const Record& other) = delete;
 
   void set(const std::vector<std::variant<std::string_view, int64_t>>& values);
@@ -26,5 +31,5 @@ public:
     return os;
   }
 
-  std::vector<Value> values;
+  std::pmr::vector<Value> values;
 };
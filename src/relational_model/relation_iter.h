@@ -1,5 +1,6 @@
 #pragma once
 
+#include "relational_model/column_batch.h"
 #include "relational_model/record.h"
 
 class RelationIter {
@@ -10,5 +11,10 @@ public:
 
   virtual bool next() = 0;
 
+  // Clears the batch and fills it with the next rows (at most ColumnBatch::CAPACITY).
+  // Returns false if there are no more rows. It does not need begin() to be called, and advances the same
+  // position as next(), so mixing both in the same iteration is allowed but rarely useful.
+  virtual bool next_batch(ColumnBatch& batch) = 0;
+
   virtual void reset() = 0;
 };
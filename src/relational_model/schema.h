@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -8,12 +9,18 @@
 // - 64 bit signed integer
 enum class DataType { STR, INT };
 
+// How the values of a column are stored in the heap file pages:
+// - PLAIN: the value itself
+// - DICTIONARY: only for STR columns, a 4 byte code of the string in a dictionary of the column
+enum class ColumnEncoding { PLAIN, DICTIONARY };
+
 struct ColumnInfo {
   std::string name;
   DataType datatype;
+  ColumnEncoding encoding = ColumnEncoding::PLAIN;
 
   bool operator==(const ColumnInfo& other) const {
-    return name == other.name && datatype == other.datatype;
+    return name == other.name && datatype == other.datatype && encoding == other.encoding;
   }
 };
 
@@ -26,6 +33,16 @@ public:
 
   std::vector<ColumnInfo> columns;
 
+  // returns the datatypes of the columns at the positions `column_idxs`
+  std::vector<DataType> get_datatypes(const std::vector<int64_t>& column_idxs) const {
+    std::vector<DataType> res;
+    res.reserve(column_idxs.size());
+    for (auto col : column_idxs) {
+      res.push_back(columns[col].datatype);
+    }
+    return res;
+  }
+
   bool operator==(const Schema& other) const {
     return columns == other.columns;
   }
@@ -8,11 +8,11 @@ TableInfo::TableInfo(
     const std::string& name,
     std::unique_ptr<Schema> _schema,
     std::unique_ptr<HeapFile> heap_file,
-    std::unique_ptr<Index> index
+    std::vector<std::unique_ptr<Index>> indexes
 )
     : name(name),
       schema(std::move(_schema)),
       heap_file(std::move(heap_file)),
-      index(std::move(index)) {
+      indexes(std::move(indexes)) {
   record_buf = std::make_unique<Record>(*schema);
 }
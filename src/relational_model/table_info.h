@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "relational_model/index.h"
 
@@ -20,13 +21,13 @@ struct TableInfo {
   // used as buffer, to avoid allocations
   std::unique_ptr<Record> record_buf;
 
-  // nullptr if there is not index
-  std::unique_ptr<Index> index;
+  // in creation order, empty if there is no index
+  std::vector<std::unique_ptr<Index>> indexes;
 
   TableInfo(
       const std::string& name,
       std::unique_ptr<Schema> _schema,
       std::unique_ptr<HeapFile> heap_file,
-      std::unique_ptr<Index> index
+      std::vector<std::unique_ptr<Index>> indexes
   );
 };
@@ -3,50 +3,69 @@
 #include <cassert>
 #include <cstring>
 
-Value::Value(Value&& other)
+Value::Value(Value&& other) noexcept
     : datatype(other.datatype),
       value(other.value) {
   if (datatype == DataType::STR) {
-    // change datatype to avoid deleting value.as_str when other is destroyed
-    other.datatype = DataType::INT;
+    if (other.is_inline()) {
+      std::memcpy(inline_str, other.inline_str, INLINE_STRLEN + 1);
+      value.as_str = inline_str;
+    } else {
+      steal_buffer(other);
+    }
   }
 }
 
+void Value::steal_buffer(Value& other) {
+  assert(!other.is_inline());
+  datatype = DataType::STR;
+  value.as_str = other.value.as_str;
+  inline_str[0] = other.inline_str[0];
+  // other becomes the empty string
+  other.init_inline_str();
+}
+
 Value::Value(const Value& other)
     : datatype(other.datatype),
       value(other.value) {
   if (datatype == DataType::STR) {
-    value.as_str = new char[MAX_STRLEN + 1];
-    std::memcpy(value.as_str, other.value.as_str, MAX_STRLEN + 1);
+    init_inline_str();
+    set_str(other.value.as_str, strlen(other.value.as_str));
   }
 }
 
 void Value::operator=(const Value& other) {
+  if (this == &other) {
+    return;
+  }
   if (other.datatype == DataType::STR) {
     if (datatype != DataType::STR) {
-      value.as_str = new char[MAX_STRLEN + 1];
+      init_inline_str();
     }
-    std::memcpy(value.as_str, other.value.as_str, MAX_STRLEN + 1);
+    set_str(other.value.as_str, strlen(other.value.as_str));
   } else {
-    if (datatype == DataType::STR) {
+    if (owns_buffer()) {
       delete[] value.as_str;
     }
+    this->datatype = other.datatype;
     this->value = other.value;
   }
-  this->datatype = other.datatype;
 }
 
-void Value::operator=(Value&& other) {
-  if (datatype == DataType::STR) {
-    delete[] value.as_str;
+void Value::operator=(Value&& other) noexcept {
+  if (this == &other) {
+    return;
+  }
+  if (other.datatype != DataType::STR || other.is_inline()) {
+    // nothing to steal, copying does not allocate as the string fits inline or in our heap buffer
+    *this = other;
+    return;
   }
 
-  this->datatype = other.datatype;
-  this->value = other.value;
-  if (datatype == DataType::STR) {
-    // change datatype to avoid deleting value.as_str when other is destroyed
-    other.datatype = DataType::INT;
+  if (owns_buffer()) {
+    delete[] value.as_str;
   }
+  steal_buffer(other);
 }
 
 Value::Value(int64_t i)
@@ -56,25 +75,44 @@ Value::Value(int64_t i)
 Value::Value(const char* str_value)
     : datatype(DataType::STR),
       value(nullptr) {
-  value.as_str = new char[MAX_STRLEN + 1];
-
-  auto size = strlen(str_value);
-  assert(size <= MAX_STRLEN);
-  std::memcpy(value.as_str, str_value, size + 1); // size+1 to copy '\0'
+  init_inline_str();
+  set_str(str_value, strlen(str_value));
 }
 
 Value::Value(const std::string& str_value)
     : datatype(DataType::STR),
       value(nullptr) {
-  value.as_str = new char[MAX_STRLEN + 1];
+  init_inline_str();
+  set_str(str_value.data(), str_value.size());
+}
 
-  auto size = str_value.size();
-  assert(size <= MAX_STRLEN);
-  std::memcpy(value.as_str, str_value.c_str(), size + 1); // size+1 to copy '\0'
+// Not inline on purpose: when the compiler knows that len is lower than 256 it expands memcpy as
+// `rep movs`, that is much slower than the library call for short strings
+void Value::set_str(const char* str, size_t len) {
+  assert(datatype == DataType::STR);
+  assert(len <= MAX_STRLEN);
+  if (len > INLINE_STRLEN && is_inline()) {
+    value.as_str = new char[MAX_STRLEN + 1];
+    inline_str[0] = HEAP_BUFFER;
+  }
+  // the buffer is owned by this value, so it is writable
+  char* buffer = const_cast<char*>(value.as_str);
+  std::memcpy(buffer, str, len);
+  buffer[len] = '\0';
+}
+
+void Value::set_buffer(char* buffer) {
+  assert(datatype == DataType::STR);
+  std::memcpy(buffer, value.as_str, strlen(value.as_str) + 1);
+  if (owns_buffer()) {
+    delete[] value.as_str;
+  }
+  value.as_str = buffer;
+  inline_str[0] = EXTERNAL_BUFFER;
 }
 
 Value::~Value() {
-  if (datatype == DataType::STR) {
+  if (owns_buffer()) {
     delete[] value.as_str;
   }
 }
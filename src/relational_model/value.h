@@ -7,30 +7,44 @@
 #include "relational_model/schema.h"
 
 union ValueUnion {
-  char* as_str;
+  // null-terminated, owned by the Value. Use Value::set_str to modify it
+  const char* as_str;
   int64_t as_int;
 
-  explicit ValueUnion(char* str_value)
+  explicit ValueUnion(const char* str_value)
       : as_str(str_value) {}
   explicit ValueUnion(int64_t int_value)
       : as_int(int_value) {}
 };
 
+// STR values up to INLINE_STRLEN characters are stored inside the Value, so creating, copying and moving
+// them does not allocate. Longer strings use a heap buffer of MAX_STRLEN + 1 bytes, that is kept when a
+// shorter string is set afterwards, so a Value reused as a buffer allocates at most once.
+// A buffer owned by someone else (e.g. an Arena) can be given with set_buffer, then it never allocates.
 class Value {
 public:
   static constexpr int64_t MAX_STRLEN = 255;
 
+  static constexpr int64_t INLINE_STRLEN = 23;
+
   explicit Value(int64_t);
   explicit Value(const char* str_value);
   explicit Value(const std::string&);
 
-  Value(Value&& other);
+  Value(Value&& other) noexcept;
   Value(const Value& other);
 
   ~Value();
 
   void operator=(const Value& other);
-  void operator=(Value&& other);
+  void operator=(Value&& other) noexcept;
+
+  // copies `len` bytes of `str` as the value of a STR Value
+  void set_str(const char* str, size_t len);
+
+  // from now on the string of this STR Value is stored in `buffer` (MAX_STRLEN + 1 bytes), that is not
+  // owned by the Value. The buffer must outlive this Value and any Value moved from it
+  void set_buffer(char* buffer);
 
   bool operator<(const Value& other) const;
   bool operator==(const Value& other) const;
@@ -66,4 +80,31 @@ public:
     }
     return os;
   }
+
+private:
+  // values of inline_str[0] when the string is not inline
+  static constexpr char HEAP_BUFFER = 0;
+  static constexpr char EXTERNAL_BUFFER = 1;
+
+  // buffer of value.as_str for short strings. When the string is not inline the first byte tells if
+  // value.as_str has to be deleted (HEAP_BUFFER) or not (EXTERNAL_BUFFER)
+  char inline_str[INLINE_STRLEN + 1];
+
+  bool is_inline() const {
+    return value.as_str == inline_str;
+  }
+
+  bool owns_buffer() const {
+    return datatype == DataType::STR && !is_inline() && inline_str[0] == HEAP_BUFFER;
+  }
+
+  // takes the buffer of other, that must not be inline
+  void steal_buffer(Value& other);
+
+  // the value becomes the empty STR, without allocating
+  void init_inline_str() {
+    datatype = DataType::STR;
+    inline_str[0] = '\0';
+    value.as_str = inline_str;
+  }
 };
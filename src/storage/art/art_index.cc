@@ -0,0 +1,41 @@
+#include "art_index.h"
+
+#include "relational_model/key_encoding.h"
+#include "storage/art/art_index_iter.h"
+#include "storage/b_plus_tree/b_plus_tree_utils.h"
+#include "storage/heap_file/heap_file.h"
+
+ARTIndex::ARTIndex(const HeapFile& heap_file, const std::vector<int64_t>& key_columns)
+    : heap_file(heap_file),
+      key_columns(key_columns),
+      key_datatypes(heap_file.schema.get_datatypes(key_columns)),
+      version(0) {}
+
+size_t ARTIndex::encode_entry(const Record& record, RID rid, char* out) const {
+  auto size = KeyEncoding::encode(record, key_columns, out);
+  return size + BPlusTreeRecord::encode_rid(rid, out + size);
+}
+
+std::unique_ptr<RelationIter> ARTIndex::get_iter(
+    const std::vector<Value>& min, const std::vector<Value>& max
+) {
+  check_bound(min, key_datatypes);
+  check_bound(max, key_datatypes);
+  return std::make_unique<ARTIndexIter>(*this, min, max);
+}
+
+void ARTIndex::insert_record(const Record& record, RID rid) {
+  char entry[BPlusTreeRecord::MAX_SIZE];
+  auto size = encode_entry(record, rid, entry);
+  if (tree.insert(std::string_view(entry, size))) {
+    version++;
+  }
+}
+
+void ARTIndex::delete_record(const Record& record, RID rid) {
+  char entry[BPlusTreeRecord::MAX_SIZE];
+  auto size = encode_entry(record, rid, entry);
+  if (tree.remove(std::string_view(entry, size))) {
+    version++;
+  }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "relational_model/index.h"
+#include "relational_model/record.h"
+#include "storage/art/art_tree.h"
+
+class HeapFile;
+
+/*
+  Index kept only in memory, for small tables with frequent lookups. The entries are the encoded key
+  followed by the RID (see KeyEncoding), stored in an adaptive radix tree (see ARTTree), so lookups and
+  range scans don't go through the buffer manager.
+
+  The index has no files: it is rebuilt from the heap file when the catalog is loaded.
+ */
+class ARTIndex : public Index {
+public:
+  // the key is the concatenation of the `key_columns`
+  ARTIndex(const HeapFile& heap_file, const std::vector<int64_t>& key_columns);
+
+  void insert_record(const Record& record, RID rid) override;
+
+  void delete_record(const Record& record, RID rid) override;
+
+  using Index::get_iter;
+
+  std::unique_ptr<RelationIter> get_iter(
+      const std::vector<Value>& min, const std::vector<Value>& max
+  ) override;
+
+  IndexType get_type() override {
+    return IndexType::ART;
+  }
+
+  const std::vector<int64_t>& get_key_columns() const override {
+    return key_columns;
+  }
+
+  size_t size() const {
+    return tree.size();
+  }
+
+  const HeapFile& heap_file;
+
+  const std::vector<int64_t> key_columns;
+
+  const std::vector<DataType> key_datatypes;
+
+private:
+  friend class ARTIndexIter;
+
+  ARTTree tree;
+
+  // incremented when the tree is modified, so open iterators know their cursor is no longer valid
+  uint64_t version;
+
+  // writes the entry of `record` and `rid` into out, returns its size
+  size_t encode_entry(const Record& record, RID rid, char* out) const;
+};
@@ -0,0 +1,70 @@
+#include "art_index_iter.h"
+
+#include "relational_model/key_encoding.h"
+#include "storage/b_plus_tree/b_plus_tree_utils.h"
+#include "storage/heap_file/heap_file.h"
+
+ARTIndexIter::ARTIndexIter(
+    const ARTIndex& index, const std::vector<Value>& min, const std::vector<Value>& max
+)
+    : index(index),
+      min_key(KeyEncoding::encode(min)),
+      max_key(KeyEncoding::encode(max)),
+      version(0),
+      started(false) {}
+
+void ARTIndexIter::begin(Record& _out) {
+  out = &_out;
+  reset();
+}
+
+void ARTIndexIter::reset() {
+  cursor.seek(index.tree, min_key);
+  version = index.version;
+  last_entry.clear();
+  started = true;
+}
+
+bool ARTIndexIter::advance(RID* rid) {
+  if (version != index.version) {
+    // the nodes of the cursor may have been freed
+    cursor.seek(index.tree, last_entry.empty() ? std::string_view(min_key) : last_entry);
+    version = index.version;
+    if (!last_entry.empty() && cursor.valid() && cursor.get_entry() == last_entry) {
+      cursor.next();
+    }
+  } else if (!last_entry.empty()) {
+    cursor.next();
+  }
+
+  if (!cursor.valid()) {
+    return false;
+  }
+  auto entry = cursor.get_entry();
+  auto key_size = entry.size() - BPlusTreeRecord::RID_SIZE;
+  if (KeyEncoding::is_after_max(entry.data(), key_size, max_key.data(), max_key.size())) {
+    return false;
+  }
+  last_entry.assign(entry.data(), entry.size());
+  *rid = BPlusTreeRecord::decode_rid(entry.data() + entry.size() - BPlusTreeRecord::RID_SIZE);
+  return true;
+}
+
+bool ARTIndexIter::next() {
+  RID rid;
+  if (!advance(&rid)) {
+    return false;
+  }
+  index.heap_file.get_record(rid, *out);
+  return true;
+}
+
+bool ARTIndexIter::next_batch(ColumnBatch& batch) {
+  batch.clear();
+  if (!started) {
+    reset();
+  }
+
+  index.heap_file.append_records_to_batch([this](RID* rid) { return advance(rid); }, batch);
+  return batch.size > 0;
+}
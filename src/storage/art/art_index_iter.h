@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "relational_model/relation_iter.h"
+#include "storage/art/art_index.h"
+#include "storage/art/art_tree.h"
+
+// Returns the records with min <= key <= max, reading the entries of the tree in order. If the index is
+// modified during the scan, the cursor moves again to the entry after the last one returned.
+class ARTIndexIter : public RelationIter {
+public:
+  ARTIndexIter(const ARTIndex& index, const std::vector<Value>& min, const std::vector<Value>& max);
+
+  virtual void begin(Record& out) override;
+
+  virtual bool next() override;
+
+  virtual bool next_batch(ColumnBatch& batch) override;
+
+  virtual void reset() override;
+
+private:
+  const ARTIndex& index;
+
+  // encoded keys (without RID)
+  std::string min_key;
+
+  std::string max_key;
+
+  ARTTree::Cursor cursor;
+
+  // version of the index when the cursor was moved
+  uint64_t version;
+
+  // the last entry returned, empty if there is none
+  std::string last_entry;
+
+  bool started;
+
+  Record* out;
+
+  // moves to the next entry with key <= max, returns false if there is no such entry
+  bool advance(RID* rid);
+};
@@ -0,0 +1,596 @@
+#include "art_tree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Positions of the children of a node: the index in keys for NODE4 and NODE16, and the byte of the child
+// for NODE48 and NODE256. In both cases greater positions have greater bytes.
+
+static ARTLeaf* new_leaf(std::string_view entry) {
+  auto leaf = static_cast<ARTLeaf*>(::operator new(sizeof(ARTLeaf) + entry.size()));
+  leaf->type = ARTNodeType::LEAF;
+  leaf->size = static_cast<uint32_t>(entry.size());
+  std::memcpy(leaf + 1, entry.data(), entry.size());
+  return leaf;
+}
+
+template <class Node>
+static Node* new_inner(ARTNodeType type, const ARTInner& header) {
+  auto node = new Node();
+  node->type = type;
+  node->prefix_size = header.prefix_size;
+  std::memcpy(node->prefix, header.prefix, ARTInner::MAX_PREFIX_SIZE);
+  return node;
+}
+
+static void delete_node(ARTNode* node) {
+  switch (node->type) {
+  case ARTNodeType::LEAF:
+    ::operator delete(node);
+    return;
+  case ARTNodeType::NODE4:
+    delete static_cast<ARTNode4*>(node);
+    return;
+  case ARTNodeType::NODE16:
+    delete static_cast<ARTNode16*>(node);
+    return;
+  case ARTNodeType::NODE48:
+    delete static_cast<ARTNode48*>(node);
+    return;
+  case ARTNodeType::NODE256:
+    delete static_cast<ARTNode256*>(node);
+    return;
+  }
+}
+
+// returns the first position >= pos having a child, -1 if there is none
+static int32_t next_child(const ARTInner* node, int32_t pos) {
+  switch (node->type) {
+  case ARTNodeType::NODE4:
+  case ARTNodeType::NODE16:
+    return pos < node->count ? pos : -1;
+  case ARTNodeType::NODE48: {
+    auto node48 = static_cast<const ARTNode48*>(node);
+    for (; pos < 256; pos++) {
+      if (node48->child_index[pos] != 0) {
+        return pos;
+      }
+    }
+    return -1;
+  }
+  case ARTNodeType::NODE256: {
+    auto node256 = static_cast<const ARTNode256*>(node);
+    for (; pos < 256; pos++) {
+      if (node256->children[pos] != nullptr) {
+        return pos;
+      }
+    }
+    return -1;
+  }
+  case ARTNodeType::LEAF:
+    break;
+  }
+  return -1; // unreachable
+}
+
+static ARTNode* child_at(const ARTInner* node, int32_t pos) {
+  switch (node->type) {
+  case ARTNodeType::NODE4:
+    return static_cast<const ARTNode4*>(node)->children[pos];
+  case ARTNodeType::NODE16:
+    return static_cast<const ARTNode16*>(node)->children[pos];
+  case ARTNodeType::NODE48: {
+    auto node48 = static_cast<const ARTNode48*>(node);
+    return node48->children[node48->child_index[pos] - 1];
+  }
+  case ARTNodeType::NODE256:
+    return static_cast<const ARTNode256*>(node)->children[pos];
+  case ARTNodeType::LEAF:
+    break;
+  }
+  return nullptr; // unreachable
+}
+
+template <class Node>
+static int32_t lower_bound_key(const Node* node, uint8_t byte, uint8_t* child_byte) {
+  for (int32_t i = 0; i < node->count; i++) {
+    if (node->keys[i] >= byte) {
+      *child_byte = node->keys[i];
+      return i;
+    }
+  }
+  return -1;
+}
+
+// returns the position of the first child with a byte >= `byte` and writes its byte into `child_byte`,
+// -1 if there is none
+static int32_t lower_bound_child(const ARTInner* node, uint8_t byte, uint8_t* child_byte) {
+  // the keys of NODE4 and NODE16 are read in separate functions, if the compiler merges the reads it may
+  // assume the position is always below 4
+  switch (node->type) {
+  case ARTNodeType::NODE4:
+    return lower_bound_key(static_cast<const ARTNode4*>(node), byte, child_byte);
+  case ARTNodeType::NODE16:
+    return lower_bound_key(static_cast<const ARTNode16*>(node), byte, child_byte);
+  case ARTNodeType::NODE48:
+  case ARTNodeType::NODE256: {
+    auto pos = next_child(node, byte);
+    *child_byte = static_cast<uint8_t>(pos);
+    return pos;
+  }
+  case ARTNodeType::LEAF:
+    break;
+  }
+  return -1; // unreachable
+}
+
+// returns the slot of the child of `byte`, nullptr if there is none
+static ARTNode** find_child(ARTInner* node, uint8_t byte) {
+  switch (node->type) {
+  case ARTNodeType::NODE4: {
+    auto node4 = static_cast<ARTNode4*>(node);
+    for (int32_t i = 0; i < node4->count; i++) {
+      if (node4->keys[i] == byte) {
+        return &node4->children[i];
+      }
+    }
+    return nullptr;
+  }
+  case ARTNodeType::NODE16: {
+    auto node16 = static_cast<ARTNode16*>(node);
+#ifdef __SSE2__
+    // compares the 16 keys at once
+    auto keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(node16->keys));
+    auto equal = _mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(byte)));
+    auto mask = _mm_movemask_epi8(equal) & ((1 << node16->count) - 1);
+    return mask != 0 ? &node16->children[__builtin_ctz(mask)] : nullptr;
+#else
+    for (int32_t i = 0; i < node16->count; i++) {
+      if (node16->keys[i] == byte) {
+        return &node16->children[i];
+      }
+    }
+    return nullptr;
+#endif
+  }
+  case ARTNodeType::NODE48: {
+    auto node48 = static_cast<ARTNode48*>(node);
+    auto index = node48->child_index[byte];
+    return index != 0 ? &node48->children[index - 1] : nullptr;
+  }
+  case ARTNodeType::NODE256: {
+    auto node256 = static_cast<ARTNode256*>(node);
+    return node256->children[byte] != nullptr ? &node256->children[byte] : nullptr;
+  }
+  case ARTNodeType::LEAF:
+    break;
+  }
+  return nullptr; // unreachable
+}
+
+static const ARTLeaf* min_leaf(const ARTNode* node) {
+  while (node->type != ARTNodeType::LEAF) {
+    auto inner = static_cast<const ARTInner*>(node);
+    node = child_at(inner, next_child(inner, 0));
+  }
+  return static_cast<const ARTLeaf*>(node);
+}
+
+// returns the full prefix of a node at `depth`
+static const char* get_prefix(const ARTInner* node, size_t depth) {
+  if (node->prefix_size <= ARTInner::MAX_PREFIX_SIZE) {
+    return node->prefix;
+  }
+  return min_leaf(node)->get_entry().data() + depth;
+}
+
+// sets the prefix of a node, `bytes` must have `size` bytes
+static void set_prefix(ARTInner* node, const char* bytes, uint32_t size) {
+  node->prefix_size = size;
+  std::memcpy(node->prefix, bytes, std::min(size, ARTInner::MAX_PREFIX_SIZE));
+}
+
+// returns the number of bytes of the prefix of a node at `depth` equal to the bytes of `key` there
+static uint32_t prefix_match(const ARTInner* node, std::string_view key, size_t depth) {
+  auto prefix = get_prefix(node, depth);
+  auto size = std::min<size_t>(node->prefix_size, key.size() - depth);
+  uint32_t i = 0;
+  while (i < size && prefix[i] == key[depth + i]) {
+    i++;
+  }
+  return i;
+}
+
+static void add_child(ARTNode*& ref, uint8_t byte, ARTNode* child) {
+  auto node = static_cast<ARTInner*>(ref);
+  switch (node->type) {
+  case ARTNodeType::NODE4: {
+    auto node4 = static_cast<ARTNode4*>(node);
+    if (node4->count < 4) {
+      int32_t pos = 0;
+      while (pos < node4->count && node4->keys[pos] < byte) {
+        pos++;
+      }
+      std::memmove(node4->keys + pos + 1, node4->keys + pos, node4->count - pos);
+      std::memmove(node4->children + pos + 1, node4->children + pos, (node4->count - pos) * sizeof(ARTNode*));
+      node4->keys[pos] = byte;
+      node4->children[pos] = child;
+      node4->count++;
+      return;
+    }
+    auto grown = new_inner<ARTNode16>(ARTNodeType::NODE16, *node4);
+    grown->count = 4;
+    std::memcpy(grown->keys, node4->keys, 4);
+    std::memcpy(grown->children, node4->children, 4 * sizeof(ARTNode*));
+    delete node4;
+    ref = grown;
+    add_child(ref, byte, child);
+    return;
+  }
+  case ARTNodeType::NODE16: {
+    auto node16 = static_cast<ARTNode16*>(node);
+    if (node16->count < 16) {
+      int32_t pos = 0;
+      while (pos < node16->count && node16->keys[pos] < byte) {
+        pos++;
+      }
+      std::memmove(node16->keys + pos + 1, node16->keys + pos, node16->count - pos);
+      std::memmove(
+          node16->children + pos + 1, node16->children + pos, (node16->count - pos) * sizeof(ARTNode*)
+      );
+      node16->keys[pos] = byte;
+      node16->children[pos] = child;
+      node16->count++;
+      return;
+    }
+    auto grown = new_inner<ARTNode48>(ARTNodeType::NODE48, *node16);
+    grown->count = 16;
+    for (int32_t i = 0; i < 16; i++) {
+      grown->child_index[node16->keys[i]] = static_cast<uint8_t>(i + 1);
+      grown->children[i] = node16->children[i];
+    }
+    delete node16;
+    ref = grown;
+    add_child(ref, byte, child);
+    return;
+  }
+  case ARTNodeType::NODE48: {
+    auto node48 = static_cast<ARTNode48*>(node);
+    if (node48->count < 48) {
+      // removed children leave empty slots
+      int32_t pos = 0;
+      while (node48->children[pos] != nullptr) {
+        pos++;
+      }
+      node48->children[pos] = child;
+      node48->child_index[byte] = static_cast<uint8_t>(pos + 1);
+      node48->count++;
+      return;
+    }
+    auto grown = new_inner<ARTNode256>(ARTNodeType::NODE256, *node48);
+    grown->count = 48;
+    for (int32_t b = 0; b < 256; b++) {
+      if (node48->child_index[b] != 0) {
+        grown->children[b] = node48->children[node48->child_index[b] - 1];
+      }
+    }
+    delete node48;
+    ref = grown;
+    add_child(ref, byte, child);
+    return;
+  }
+  case ARTNodeType::NODE256: {
+    auto node256 = static_cast<ARTNode256*>(node);
+    node256->children[byte] = child;
+    node256->count++;
+    return;
+  }
+  case ARTNodeType::LEAF:
+    assert(false && "leaves have no children");
+    return;
+  }
+}
+
+// removes the child of `byte` from the node at `depth`, the child must have been freed
+static void remove_child(ARTNode*& ref, uint8_t byte, size_t depth) {
+  auto node = static_cast<ARTInner*>(ref);
+  switch (node->type) {
+  case ARTNodeType::NODE4: {
+    auto node4 = static_cast<ARTNode4*>(node);
+    int32_t pos = 0;
+    while (node4->keys[pos] != byte) {
+      pos++;
+    }
+    std::memmove(node4->keys + pos, node4->keys + pos + 1, node4->count - pos - 1);
+    std::memmove(
+        node4->children + pos, node4->children + pos + 1, (node4->count - pos - 1) * sizeof(ARTNode*)
+    );
+    node4->count--;
+    if (node4->count > 1) {
+      return;
+    }
+    // the node is replaced by its only child, whose prefix gets the prefix of the node and the byte
+    auto child = node4->children[0];
+    if (child->type != ARTNodeType::LEAF) {
+      auto inner = static_cast<ARTInner*>(child);
+      auto prefix_size = node4->prefix_size + 1 + inner->prefix_size;
+      set_prefix(inner, min_leaf(inner)->get_entry().data() + depth, prefix_size);
+    }
+    delete node4;
+    ref = child;
+    return;
+  }
+  case ARTNodeType::NODE16: {
+    auto node16 = static_cast<ARTNode16*>(node);
+    int32_t pos = 0;
+    while (node16->keys[pos] != byte) {
+      pos++;
+    }
+    std::memmove(node16->keys + pos, node16->keys + pos + 1, node16->count - pos - 1);
+    std::memmove(
+        node16->children + pos, node16->children + pos + 1, (node16->count - pos - 1) * sizeof(ARTNode*)
+    );
+    node16->count--;
+    if (node16->count > 3) {
+      return;
+    }
+    auto shrunk = new_inner<ARTNode4>(ARTNodeType::NODE4, *node16);
+    shrunk->count = node16->count;
+    std::memcpy(shrunk->keys, node16->keys, node16->count);
+    std::memcpy(shrunk->children, node16->children, node16->count * sizeof(ARTNode*));
+    delete node16;
+    ref = shrunk;
+    return;
+  }
+  case ARTNodeType::NODE48: {
+    auto node48 = static_cast<ARTNode48*>(node);
+    node48->children[node48->child_index[byte] - 1] = nullptr;
+    node48->child_index[byte] = 0;
+    node48->count--;
+    if (node48->count > 12) {
+      return;
+    }
+    auto shrunk = new_inner<ARTNode16>(ARTNodeType::NODE16, *node48);
+    for (int32_t b = 0; b < 256; b++) {
+      if (node48->child_index[b] != 0) {
+        shrunk->keys[shrunk->count] = static_cast<uint8_t>(b);
+        shrunk->children[shrunk->count] = node48->children[node48->child_index[b] - 1];
+        shrunk->count++;
+      }
+    }
+    delete node48;
+    ref = shrunk;
+    return;
+  }
+  case ARTNodeType::NODE256: {
+    auto node256 = static_cast<ARTNode256*>(node);
+    node256->children[byte] = nullptr;
+    node256->count--;
+    if (node256->count > 40) {
+      return;
+    }
+    auto shrunk = new_inner<ARTNode48>(ARTNodeType::NODE48, *node256);
+    for (int32_t b = 0; b < 256; b++) {
+      if (node256->children[b] != nullptr) {
+        shrunk->children[shrunk->count] = node256->children[b];
+        shrunk->count++;
+        shrunk->child_index[b] = static_cast<uint8_t>(shrunk->count);
+      }
+    }
+    delete node256;
+    ref = shrunk;
+    return;
+  }
+  case ARTNodeType::LEAF:
+    assert(false && "leaves have no children");
+    return;
+  }
+}
+
+static void delete_tree(ARTNode* node) {
+  if (node->type != ARTNodeType::LEAF) {
+    auto inner = static_cast<ARTInner*>(node);
+    for (auto pos = next_child(inner, 0); pos >= 0; pos = next_child(inner, pos + 1)) {
+      delete_tree(child_at(inner, pos));
+    }
+  }
+  delete_node(node);
+}
+
+ARTTree::ARTTree()
+    : root(nullptr),
+      entry_count(0) {}
+
+ARTTree::~ARTTree() {
+  if (root != nullptr) {
+    delete_tree(root);
+  }
+}
+
+bool ARTTree::insert(std::string_view entry) {
+  if (!insert(root, entry, 0)) {
+    return false;
+  }
+  entry_count++;
+  return true;
+}
+
+bool ARTTree::remove(std::string_view entry) {
+  if (!remove(root, entry, 0)) {
+    return false;
+  }
+  entry_count--;
+  return true;
+}
+
+bool ARTTree::insert(ARTNode*& ref, std::string_view entry, size_t depth) {
+  if (ref == nullptr) {
+    ref = new_leaf(entry);
+    return true;
+  }
+
+  if (ref->type == ARTNodeType::LEAF) {
+    auto existing = static_cast<ARTLeaf*>(ref)->get_entry();
+    if (existing == entry) {
+      return false;
+    }
+    // the leaf is replaced by a node with both entries, as none is a prefix of the other they have a
+    // different byte before the end of both
+    auto end = depth;
+    while (existing[end] == entry[end]) {
+      end++;
+    }
+    auto node = new ARTNode4();
+    node->type = ARTNodeType::NODE4;
+    set_prefix(node, entry.data() + depth, static_cast<uint32_t>(end - depth));
+    ARTNode* node_ref = node;
+    add_child(node_ref, existing[end], ref);
+    add_child(node_ref, entry[end], new_leaf(entry));
+    ref = node_ref;
+    return true;
+  }
+
+  auto node = static_cast<ARTInner*>(ref);
+  auto matched = prefix_match(node, entry, depth);
+  if (matched < node->prefix_size) {
+    // the prefix is split, a new node with the matched bytes gets the node and the entry as children
+    auto node_byte = static_cast<uint8_t>(get_prefix(node, depth)[matched]);
+    auto parent = new ARTNode4();
+    parent->type = ARTNodeType::NODE4;
+    set_prefix(parent, entry.data() + depth, matched);
+    auto node_prefix = min_leaf(node)->get_entry().data() + depth + matched + 1;
+    set_prefix(node, node_prefix, node->prefix_size - matched - 1);
+    ARTNode* parent_ref = parent;
+    add_child(parent_ref, node_byte, node);
+    add_child(parent_ref, entry[depth + matched], new_leaf(entry));
+    ref = parent_ref;
+    return true;
+  }
+
+  depth += node->prefix_size;
+  assert(depth < entry.size() && "entries can't be a prefix of other entries");
+  auto child = find_child(node, entry[depth]);
+  if (child != nullptr) {
+    return insert(*child, entry, depth + 1);
+  }
+  add_child(ref, entry[depth], new_leaf(entry));
+  return true;
+}
+
+bool ARTTree::remove(ARTNode*& ref, std::string_view entry, size_t depth) {
+  if (ref == nullptr) {
+    return false;
+  }
+  if (ref->type == ARTNodeType::LEAF) {
+    // only when the leaf is the root
+    if (static_cast<ARTLeaf*>(ref)->get_entry() != entry) {
+      return false;
+    }
+    delete_node(ref);
+    ref = nullptr;
+    return true;
+  }
+
+  auto node = static_cast<ARTInner*>(ref);
+  if (prefix_match(node, entry, depth) < node->prefix_size) {
+    return false;
+  }
+  auto node_depth = depth;
+  depth += node->prefix_size;
+  if (depth >= entry.size()) {
+    return false;
+  }
+  auto child = find_child(node, entry[depth]);
+  if (child == nullptr) {
+    return false;
+  }
+  if ((*child)->type != ARTNodeType::LEAF) {
+    return remove(*child, entry, depth + 1);
+  }
+  if (static_cast<ARTLeaf*>(*child)->get_entry() != entry) {
+    return false;
+  }
+  delete_node(*child);
+  remove_child(ref, entry[depth], node_depth);
+  return true;
+}
+
+void ARTTree::Cursor::seek(const ARTTree& tree, std::string_view key) {
+  path.clear();
+  leaf = nullptr;
+  const ARTNode* node = tree.root;
+  if (node == nullptr) {
+    return;
+  }
+
+  size_t depth = 0;
+  while (node->type != ARTNodeType::LEAF) {
+    auto inner = static_cast<const ARTInner*>(node);
+    auto remaining = key.size() - depth;
+    auto compared = std::min<size_t>(inner->prefix_size, remaining);
+    auto cmp = std::memcmp(get_prefix(inner, depth), key.data() + depth, compared);
+    if (cmp < 0) {
+      // every entry below the node is lower than the key
+      next();
+      return;
+    }
+    if (cmp > 0 || remaining <= inner->prefix_size) {
+      // every entry below the node is greater than the key, or the key is a prefix of them
+      descend_min(inner);
+      return;
+    }
+    depth += inner->prefix_size;
+
+    auto byte = static_cast<uint8_t>(key[depth]);
+    uint8_t child_byte;
+    auto pos = lower_bound_child(inner, byte, &child_byte);
+    if (pos < 0) {
+      next();
+      return;
+    }
+    path.emplace_back(inner, pos);
+    if (child_byte > byte) {
+      descend_min(child_at(inner, pos));
+      return;
+    }
+    node = child_at(inner, pos);
+    depth++;
+  }
+
+  auto node_leaf = static_cast<const ARTLeaf*>(node);
+  if (node_leaf->get_entry() >= key) {
+    leaf = node_leaf;
+  } else {
+    next();
+  }
+}
+
+void ARTTree::Cursor::next() {
+  leaf = nullptr;
+  while (!path.empty()) {
+    auto& [node, pos] = path.back();
+    auto next_pos = next_child(node, pos + 1);
+    if (next_pos >= 0) {
+      pos = next_pos;
+      descend_min(child_at(node, next_pos));
+      return;
+    }
+    path.pop_back();
+  }
+}
+
+void ARTTree::Cursor::descend_min(const ARTNode* node) {
+  while (node->type != ARTNodeType::LEAF) {
+    auto inner = static_cast<const ARTInner*>(node);
+    auto pos = next_child(inner, 0);
+    path.emplace_back(inner, pos);
+    node = child_at(inner, pos);
+  }
+  leaf = static_cast<const ARTLeaf*>(node);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum class ARTNodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+struct ARTNode {
+  ARTNodeType type;
+};
+
+// Stores a whole entry, its bytes are allocated right after the struct
+struct ARTLeaf : ARTNode {
+  uint32_t size;
+
+  std::string_view get_entry() const {
+    return std::string_view(reinterpret_cast<const char*>(this + 1), size);
+  }
+};
+
+// Inner nodes have a child for each distinct byte of the entries below them at their depth. The bytes
+// all those entries share before that position are the prefix of the node, only its first
+// MAX_PREFIX_SIZE bytes are stored in the node, the full prefix is read from any leaf below it.
+struct ARTInner : ARTNode {
+  static constexpr uint32_t MAX_PREFIX_SIZE = 8;
+
+  uint16_t count;
+
+  uint32_t prefix_size;
+
+  char prefix[MAX_PREFIX_SIZE];
+};
+
+// keys sorted, children[i] is the child of keys[i]
+struct ARTNode4 : ARTInner {
+  uint8_t keys[4];
+
+  ARTNode* children[4];
+};
+
+struct ARTNode16 : ARTInner {
+  uint8_t keys[16];
+
+  ARTNode* children[16];
+};
+
+// child_index[byte] is 1 + the position of the child of byte in children, 0 if there is no child
+struct ARTNode48 : ARTInner {
+  uint8_t child_index[256];
+
+  ARTNode* children[48];
+};
+
+struct ARTNode256 : ARTInner {
+  ARTNode* children[256];
+};
+
+/*
+  Adaptive radix tree over byte strings, kept only in memory (see ARTIndex). Each inner node uses the
+  smallest of four layouts (4, 16, 48 or 256 children) that fits its children, growing and shrinking with
+  them, and single-child paths are compressed into the prefix of the next node. So a lookup reads one node
+  per distinct byte position of the key, with no search inside nodes bigger than 16 children.
+
+  No entry can be a prefix of another entry (the encoding of keys followed by a RID is prefix free).
+  It is not thread safe.
+ */
+class ARTTree {
+public:
+  ARTTree();
+
+  ~ARTTree();
+
+  // prevent accidental copies
+  ARTTree(const ARTTree& other) = delete;
+
+  // returns false if the entry was already in the tree
+  bool insert(std::string_view entry);
+
+  // returns false if the entry was not in the tree
+  bool remove(std::string_view entry);
+
+  size_t size() const {
+    return entry_count;
+  }
+
+  // Reads the entries in order, invalidated when the tree is modified
+  class Cursor {
+  public:
+    Cursor()
+        : leaf(nullptr) {}
+
+    // moves to the first entry greater or equal than `key`
+    void seek(const ARTTree& tree, std::string_view key);
+
+    // false when there are no more entries
+    bool valid() const {
+      return leaf != nullptr;
+    }
+
+    std::string_view get_entry() const {
+      return leaf->get_entry();
+    }
+
+    void next();
+
+  private:
+    // the inner nodes from the root to the current leaf, with the position of the child followed
+    std::vector<std::pair<const ARTInner*, int32_t>> path;
+
+    const ARTLeaf* leaf;
+
+    // moves to the first leaf below `node`
+    void descend_min(const ARTNode* node);
+  };
+
+private:
+  ARTNode* root;
+
+  size_t entry_count;
+
+  bool insert(ARTNode*& ref, std::string_view entry, size_t depth);
+
+  bool remove(ARTNode*& ref, std::string_view entry, size_t depth);
+};
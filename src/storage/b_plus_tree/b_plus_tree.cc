@@ -1,94 +1,464 @@
 #include "b_plus_tree.h"
 
+#include <algorithm>
+#include <shared_mutex>
+
+#include "relational_model/key_encoding.h"
+#include "storage/b_plus_tree/b_plus_tree_bitmap_iter.h"
 #include "storage/b_plus_tree/b_plus_tree_dir.h"
+#include "storage/b_plus_tree/b_plus_tree_dir_cache.h"
 #include "storage/b_plus_tree/b_plus_tree_iter.h"
+#include "storage/b_plus_tree/b_plus_tree_leaf.h"
 #include "storage/heap_file/heap_file.h"
 #include "storage/heap_file/heap_file_iter.h"
 #include "system/system.h"
 
-// construct 8 byte integer with first 8 characters
-int64_t serialize_string_key(const char* str) {
-  int64_t res = 0;
+BPlusTree::BPlusTree(
+    const HeapFile& heap_file,
+    const std::vector<int64_t>& key_columns,
+    const std::string& idx_name,
+    const std::vector<int64_t>& include_columns
+)
+    : heap_file(heap_file),
+      key_columns(key_columns),
+      key_datatypes(heap_file.schema.get_datatypes(key_columns)),
+      include_columns(include_columns),
+      dir_file_id(file_mgr.get_file_id(idx_name + ".dir")),
+      leaf_file_id(file_mgr.get_file_id(idx_name + ".leaf")),
+      active_operations(0),
+      first_free_leaf(0),
+      first_free_dir(0),
+      removed_page_count(0),
+      dir_cache_enabled(true),
+      dir_cache_version(0),
+      dir_cache_changes(0),
+      dir_cache_reading(false) {
+  // if the B+tree is new, the root is initialized empty with the leaf 0 as its only child
+  // new pages comes with all bytes setted at 0
+  root = std::make_unique<BPlusTreeDir>(*this, 0);
+  BPlusTreeLeaf leaf(*this, 0);
+  if (root->get_data_begin() == 0) {
+    root->init();
+    leaf.init();
+    return;
+  }
+
+  // the free pages are cleared from the files while the B+tree is open, if it is not closed properly they
+  // are lost instead of being reused twice
+  first_free_leaf = leaf.page.read_int32(BPlusTreeLeaf::OFFSET_FIRST_FREE);
+  first_free_dir = root->page.read_int32(BPlusTreeDir::OFFSET_FIRST_FREE);
+  leaf.page.write_int32(BPlusTreeLeaf::OFFSET_FIRST_FREE, 0);
+  root->page.write_int32(BPlusTreeDir::OFFSET_FIRST_FREE, 0);
+}
+
+BPlusTree::~BPlusTree() {
+  for (auto page_number : removed_leaves) {
+    free_page(leaf_file_id, page_number);
+  }
+  for (auto page_number : removed_dirs) {
+    free_page(dir_file_id, page_number);
+  }
+  BPlusTreeLeaf leaf(*this, 0);
+  leaf.page.write_int32(BPlusTreeLeaf::OFFSET_FIRST_FREE, first_free_leaf);
+  root->page.write_int32(BPlusTreeDir::OFFSET_FIRST_FREE, first_free_dir);
+}
 
-  int shift_size = 8 * 7;
-  for (int i = 0; i < 8 && *str != '\0'; i++, str++, shift_size -= 8) {
-    int64_t byte64 = static_cast<int64_t>(*str);
-    res |= byte64 << shift_size;
+Page& BPlusTree::allocate_page(FileId file_id) const {
+  std::lock_guard<std::mutex> lck(free_pages_mutex);
+  auto is_leaf = file_id == leaf_file_id;
+  auto& first_free = is_leaf ? first_free_leaf : first_free_dir;
+  if (first_free == 0) {
+    return buffer_mgr.append_page(file_id);
   }
+  auto link_offset = is_leaf ? BPlusTreeLeaf::OFFSET_NEXT_LEAF : BPlusTreeDir::OFFSET_RIGHT_SIBLING;
+  auto& page = buffer_mgr.get_page(file_id, first_free);
+  first_free = page.read_int32(link_offset);
+  return page;
+}
 
-  return res;
+void BPlusTree::free_page(FileId file_id, int32_t page_number) {
+  auto is_leaf = file_id == leaf_file_id;
+  auto& first_free = is_leaf ? first_free_leaf : first_free_dir;
+  auto link_offset = is_leaf ? BPlusTreeLeaf::OFFSET_NEXT_LEAF : BPlusTreeDir::OFFSET_RIGHT_SIBLING;
+  auto& page = buffer_mgr.get_page(file_id, page_number);
+  page.write_int32(link_offset, first_free);
+  page.unpin();
+  first_free = page_number;
 }
 
-BPlusTree::BPlusTree(const HeapFile& heap_file, int key_column_idx, const std::string& idx_name)
-    : heap_file(heap_file),
-      key_column_idx(key_column_idx),
-      dir_file_id(file_mgr.get_file_id(idx_name + ".dir")),
-      leaf_file_id(file_mgr.get_file_id(idx_name + ".leaf")),
-      record_buf(heap_file.schema) {
-  root = std::make_unique<BPlusTreeDir>(*this, 0);
-  if (root->get_child_count() == 0) {
-    // the B+tree is new, initialize empty
-    root->set_child_count(1);
+void BPlusTree::release_removed_pages() {
+  if (removed_page_count < MIN_RELEASED_PAGES) {
+    return;
+  }
+  std::lock_guard<std::mutex> lck(free_pages_mutex);
+  // the pages were removed before this check, so the operations that may reach them are still counted
+  if (active_operations > 0 || removed_page_count < MIN_RELEASED_PAGES) {
+    return;
+  }
+  // the copy of the upper levels may point to the removed nodes. The operations that read it before it
+  // was discarded are counted in the check below
+  discard_dir_cache();
+  if (active_operations > 0) {
+    return;
+  }
+  for (auto page_number : removed_leaves) {
+    free_page(leaf_file_id, page_number);
+  }
+  for (auto page_number : removed_dirs) {
+    free_page(dir_file_id, page_number);
+  }
+  removed_leaves.clear();
+  removed_dirs.clear();
+  removed_page_count = 0;
+}
+
+std::unique_ptr<RelationIter> BPlusTree::get_iter(
+    const std::vector<Value>& min, const std::vector<Value>& max
+) {
+  return make_iter(min, max, false);
+}
+
+std::unique_ptr<RelationIter> BPlusTree::get_index_only_iter(
+    const std::vector<Value>& min, const std::vector<Value>& max
+) {
+  return make_iter(min, max, true);
+}
+
+std::unique_ptr<RelationIter> BPlusTree::get_bitmap_iter(
+    const std::vector<Value>& min, const std::vector<Value>& max
+) {
+  check_bound(min, key_datatypes);
+  check_bound(max, key_datatypes);
+  return std::make_unique<BPlusTreeBitmapIter>(*this, min, max);
+}
+
+std::unique_ptr<RelationIter> BPlusTree::make_iter(
+    const std::vector<Value>& min, const std::vector<Value>& max, bool index_only
+) {
+  check_bound(min, key_datatypes);
+  check_bound(max, key_datatypes);
+  return std::make_unique<BPlusTreeIter>(*this, min, max, index_only);
+}
+
+size_t BPlusTree::encode_entry(const Record& record, RID rid, char* out) const {
+  auto size = KeyEncoding::encode(record, key_columns, out);
+  size += BPlusTreeRecord::encode_rid(rid, out + size);
+  return size + KeyEncoding::encode(record, include_columns, out + size);
+}
+
+void BPlusTree::insert_record(const Record& record, RID rid) {
+  // pages removed by deletes are reused by the splits
+  release_removed_pages();
+  OperationGuard guard(*this);
+  char entry[BPlusTreeRecord::MAX_SIZE];
+  auto entry_size = encode_entry(record, rid, entry);
+  insert_entry(BPlusTreeRecord(entry, entry_size));
+}
+
+std::shared_ptr<const BPlusTreeDirCache> BPlusTree::get_dir_cache() const {
+  if (!dir_cache_enabled) {
+    return nullptr;
+  }
+  auto cache = std::atomic_load(&dir_cache);
+  auto max_changes = cache == nullptr ? -1 : cache->get_separator_count() / BPlusTreeDirCache::STALE_FRACTION;
+  if (dir_cache_changes <= max_changes) {
+    return cache;
+  }
+  if (dir_cache_reading.exchange(true)) {
+    return cache;
+  }
+
+  auto version = dir_cache_version.load();
+  dir_cache_changes = 0;
+  auto new_cache = std::make_shared<const BPlusTreeDirCache>(*this);
+  {
+    std::lock_guard<std::mutex> lck(dir_cache_mutex);
+    if (dir_cache_version == version) {
+      std::atomic_store(&dir_cache, new_cache);
+    } else {
+      // it may point to pages reused after it was read
+      new_cache = nullptr;
+    }
   }
+  dir_cache_reading = false;
+  return new_cache;
+}
+
+int32_t BPlusTree::get_lowest_cached_level() const {
+  std::shared_lock<std::shared_mutex> lck(root->page.latch);
+  return std::max(1, root->get_level() - BPlusTreeDirCache::MAX_LEVELS + 1);
+}
+
+void BPlusTree::discard_dir_cache() {
+  std::lock_guard<std::mutex> lck(dir_cache_mutex);
+  dir_cache_version++;
+  std::atomic_store(&dir_cache, std::shared_ptr<const BPlusTreeDirCache>());
 }
 
-std::unique_ptr<RelationIter> BPlusTree::get_iter(const Value& min, const Value& max) {
-  int64_t encoded_min;
-  int64_t encoded_max;
+int32_t BPlusTree::find_node(const BPlusTreeRecord& record, int32_t level) const {
+  int32_t page_number = 0;
+  auto cache = get_dir_cache();
+  if (cache != nullptr && level < cache->get_top_level()) {
+    int32_t node_level;
+    page_number = cache->find(record, level, &node_level);
+    if (node_level == level) {
+      return page_number;
+    }
+  }
+  while (true) {
+    BPlusTreeDir dir(*this, page_number);
+    std::shared_lock<std::shared_mutex> lck(dir.page.latch);
 
-  auto key_datatype = heap_file.schema.columns[key_column_idx].datatype;
-  switch (key_datatype) {
-  case DataType::STR: {
-    encoded_min = serialize_string_key(min.value.as_str);
-    encoded_max = serialize_string_key(max.value.as_str);
-    break;
+    // a removed dir points to the dir that received its records
+    if (dir.is_removed()) {
+      page_number = dir.get_right_sibling();
+      continue;
+    }
+    auto dir_level = dir.get_level();
+    if (dir_level == level) {
+      return page_number;
+    }
+    if (dir.goes_right(record)) {
+      page_number = dir.get_right_sibling();
+      continue;
+    }
+    auto child = dir.get_child(dir.search_child_idx(record));
+    if (dir_level == 1) {
+      return child; // positive number: pointer to leaf
+    }
+    page_number = -1 * child; // negative number: pointer to dir
   }
+}
 
-  case DataType::INT: {
-    encoded_min = min.value.as_int;
-    encoded_max = max.value.as_int;
-    break;
+std::unique_ptr<BPlusTreeLeaf> BPlusTree::latch_leaf(
+    const BPlusTreeRecord& entry, std::unique_ptr<BPlusTreeLeaf> leaf
+) {
+  if (leaf == nullptr) {
+    leaf = std::make_unique<BPlusTreeLeaf>(*this, find_node(entry, 0));
+    leaf->page.latch.lock();
   }
+  // move right (latching the next leaf before releasing the current one) until the leaf where the entry
+  // goes
+  while (true) {
+    if (leaf->is_removed()) {
+      // the leaf at its left received its records, it is latched after releasing this one as leaves are
+      // latched from left to right
+      auto left_page_number = leaf->get_next_page_number();
+      leaf->page.latch.unlock();
+      leaf = std::make_unique<BPlusTreeLeaf>(*this, left_page_number);
+      leaf->page.latch.lock();
+      continue;
+    }
+    if (!leaf->goes_right(entry)) {
+      return leaf;
+    }
+    auto next_leaf = std::make_unique<BPlusTreeLeaf>(*this, leaf->get_next_page_number());
+    next_leaf->page.latch.lock();
+    leaf->page.latch.unlock();
+    leaf = std::move(next_leaf);
   }
+}
 
-  BPlusTreeRecord min_record(encoded_min, RID(INT32_MIN, INT32_MIN));
-  BPlusTreeRecord max_record(encoded_max, RID(INT32_MAX, INT32_MAX));
+std::unique_ptr<BPlusTreeDir> BPlusTree::latch_dir(const BPlusTreeRecord& record, int32_t level) {
+  auto dir = std::make_unique<BPlusTreeDir>(*this, find_node(record, level));
+  dir->page.latch.lock();
+  while (true) {
+    if (dir->is_removed()) {
+      auto left_page_number = dir->get_right_sibling();
+      dir->page.latch.unlock();
+      dir = std::make_unique<BPlusTreeDir>(*this, left_page_number);
+      dir->page.latch.lock();
+      continue;
+    }
+    if (dir->get_level() != level) {
+      // the root was split after find_node, search again from the new root
+      dir->page.latch.unlock();
+      dir = std::make_unique<BPlusTreeDir>(*this, find_node(record, level));
+      dir->page.latch.lock();
+      continue;
+    }
+    if (!dir->goes_right(record)) {
+      return dir;
+    }
+    auto next_dir = std::make_unique<BPlusTreeDir>(*this, dir->get_right_sibling());
+    next_dir->page.latch.lock();
+    dir->page.latch.unlock();
+    dir = std::move(next_dir);
+  }
+}
 
-  return std::make_unique<BPlusTreeIter>(*this, min, max, key_column_idx, min_record, max_record);
+void BPlusTree::insert_entry(const BPlusTreeRecord& entry) {
+  OperationGuard guard(*this);
+  auto leaf = latch_leaf(entry, nullptr);
+  auto split = leaf->insert_record(entry);
+  leaf->page.latch.unlock();
+  leaf.reset();
+
+  insert_separators(std::move(split));
 }
 
-void BPlusTree::insert_record(RID rid) {
-  heap_file.get_record(rid, record_buf);
-  auto key = record_buf.values[key_column_idx];
+int32_t BPlusTree::find_leaf(const BPlusTreeRecord& record, int32_t* dir_page_number) const {
+  if (*dir_page_number >= 0) {
+    BPlusTreeDir dir(*this, *dir_page_number);
+    std::shared_lock<std::shared_mutex> lck(dir.page.latch);
+    // the root may have been split, moving its records to other dirs, or the dir may have been removed
+    if (dir.get_level() == 1 && !dir.is_removed() && !dir.goes_right(record)) {
+      return dir.get_child(dir.search_child_idx(record));
+    }
+  }
 
-  auto key_datatype = heap_file.schema.columns[key_column_idx].datatype;
-  switch (key_datatype) {
-  case DataType::STR: {
-    root->insert_record(BPlusTreeRecord(serialize_string_key(key.value.as_str), rid));
-    break;
+  int32_t page_number = 0;
+  auto cache = get_dir_cache();
+  if (cache != nullptr && cache->get_top_level() > 1) {
+    int32_t node_level;
+    page_number = cache->find(record, 1, &node_level);
   }
+  while (true) {
+    BPlusTreeDir dir(*this, page_number);
+    std::shared_lock<std::shared_mutex> lck(dir.page.latch);
 
-  case DataType::INT: {
-    root->insert_record(BPlusTreeRecord(key.value.as_int, rid));
-    break;
+    if (dir.is_removed() || dir.goes_right(record)) {
+      page_number = dir.get_right_sibling();
+      continue;
+    }
+    auto child = dir.get_child(dir.search_child_idx(record));
+    if (dir.get_level() == 1) {
+      *dir_page_number = page_number;
+      return child;
+    }
+    page_number = -1 * child;
   }
+}
+
+void BPlusTree::insert_entries(std::vector<BPlusTreeRecord>& entries) {
+  release_removed_pages();
+  OperationGuard guard(*this);
+  std::sort(entries.begin(), entries.end());
+
+  std::unique_ptr<BPlusTreeLeaf> leaf;
+  int32_t dir_page_number = -1;
+  for (auto& entry : entries) {
+    if (leaf != nullptr && leaf->goes_right(entry)) {
+      leaf->page.latch.unlock();
+      leaf.reset();
+    }
+    if (leaf == nullptr) {
+      leaf = std::make_unique<BPlusTreeLeaf>(*this, find_leaf(entry, &dir_page_number));
+      leaf->page.latch.lock();
+    }
+    leaf = latch_leaf(entry, std::move(leaf));
+
+    auto split = leaf->insert_record(entry);
+    if (split != nullptr) {
+      // the latch of the leaf is not held while inserting in the upper levels, the next entries move
+      // right from it if the leaf was split again meanwhile
+      leaf->page.latch.unlock();
+      insert_separators(std::move(split));
+      leaf->page.latch.lock();
+    }
+  }
+  if (leaf != nullptr) {
+    leaf->page.latch.unlock();
   }
 }
 
-void BPlusTree::delete_record(RID rid) {
-  heap_file.get_record(rid, record_buf);
-  auto key = record_buf.values[key_column_idx];
+void BPlusTree::insert_separators(std::unique_ptr<BPlusTreeSplit> split) {
+  // The new node is already linked at the right of the split one, so its separator is inserted in the
+  // parent level without holding any other latch
+  int32_t level = 1;
+  while (split != nullptr) {
+    if (level >= get_lowest_cached_level()) {
+      dir_cache_changes++;
+    }
+    auto dir = latch_dir(split->record, level);
+    split = dir->insert_separator(*split);
+    auto root_split = dir->page.get_page_number() == 0 && dir->get_level() != level;
+    dir->page.latch.unlock();
+    if (root_split) {
+      // the copy of the upper levels does not have the new level
+      discard_dir_cache();
+    }
+    level++;
+  }
+}
 
-  auto key_datatype = heap_file.schema.columns[key_column_idx].datatype;
-  switch (key_datatype) {
-  case DataType::STR: {
-    root->delete_record(BPlusTreeRecord(serialize_string_key(key.value.as_str), rid));
-    break;
+void BPlusTree::delete_record(const Record& record, RID rid) {
+  {
+    OperationGuard guard(*this);
+    char bytes[BPlusTreeRecord::MAX_SIZE];
+    BPlusTreeRecord entry(bytes, encode_entry(record, rid, bytes));
+
+    auto leaf = latch_leaf(entry, nullptr);
+    auto too_small = leaf->delete_record(entry) && leaf->get_used_size() < MERGE_MIN_SIZE;
+    leaf->page.latch.unlock();
+    leaf.reset();
+
+    // as splits, merges go up while they leave the parent too small
+    for (int32_t level = 0; too_small; level++) {
+      too_small = merge_children(entry, level);
+    }
   }
+  release_removed_pages();
+}
 
-  case DataType::INT: {
-    root->delete_record(BPlusTreeRecord(key.value.as_int, rid));
-    break;
+bool BPlusTree::merge_children(const BPlusTreeRecord& record, int32_t level) {
+  {
+    std::shared_lock<std::shared_mutex> lck(root->page.latch);
+    if (root->get_level() <= level) {
+      return false;
+    }
   }
+  auto parent = latch_dir(record, level + 1);
+  auto idx = parent->search_child_idx(record);
+
+  bool merged = false;
+  for (auto left_idx : {idx, idx - 1}) {
+    if (left_idx >= 0 && left_idx < parent->get_record_count()) {
+      merged = level == 0 ? merge_leaves(*parent, left_idx) : merge_dirs(*parent, left_idx);
+      if (merged) {
+        break;
+      }
+    }
+  }
+  auto too_small = merged && parent->page.get_page_number() != 0 && parent->get_used_size() < MERGE_MIN_SIZE;
+  parent->page.latch.unlock();
+  return too_small;
+}
+
+bool BPlusTree::merge_leaves(BPlusTreeDir& parent, int32_t idx) {
+  // latched from left to right, after the parent
+  BPlusTreeLeaf left(*this, parent.get_child(idx));
+  BPlusTreeLeaf right(*this, parent.get_child(idx + 1));
+  std::unique_lock<std::shared_mutex> left_lck(left.page.latch);
+  std::unique_lock<std::shared_mutex> right_lck(right.page.latch);
+
+  // if the left leaf was split and its separator is not in the parent yet, they are not siblings
+  if (left.get_next_page_number() != right.page.get_page_number()
+      || !left.merge_right(right, MERGE_MAX_SIZE))
+  {
+    return false;
+  }
+  parent.remove_at(idx);
+  std::lock_guard<std::mutex> lck(free_pages_mutex);
+  removed_leaves.push_back(right.page.get_page_number());
+  removed_page_count++;
+  return true;
+}
+
+bool BPlusTree::merge_dirs(BPlusTreeDir& parent, int32_t idx) {
+  BPlusTreeDir left(*this, -1 * parent.get_child(idx));
+  BPlusTreeDir right(*this, -1 * parent.get_child(idx + 1));
+  std::unique_lock<std::shared_mutex> left_lck(left.page.latch);
+  std::unique_lock<std::shared_mutex> right_lck(right.page.latch);
+
+  if (left.get_right_sibling() != right.page.get_page_number()
+      || !left.merge_right(right, parent.get_record(idx), MERGE_MAX_SIZE))
+  {
+    return false;
   }
+  parent.remove_at(idx);
+  std::lock_guard<std::mutex> lck(free_pages_mutex);
+  removed_dirs.push_back(right.page.get_page_number());
+  removed_page_count++;
+  return true;
 }
@@ -1,35 +1,245 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "relational_model/index.h"
 #include "storage/b_plus_tree/b_plus_tree_dir.h"
 #include "storage/heap_file/heap_file.h"
 
+class BPlusTreeDirCache;
+class BPlusTreeLeaf;
+
+// B-link tree: the nodes of each level are linked from left to right and have a high key (see BPlusTreeDir
+// and BPlusTreeLeaf), so inserts through insert_record(const Record&, RID) and iterators can run
+// concurrently. Readers latch (shared) one node at a time, without holding the latch of the parent, and
+// writers latch (exclusive) only the node they modify. A node that was split before a search reaches it
+// is handled by moving right.
+// Deletes merge a node that gets too small with a sibling under the same parent (see merge_children). The
+// removed node points to the node that received its records, so a search that reaches it moves there,
+// and its page is reused only after the operations and iterators that could have reached it finish.
+// Descents read the upper levels from an in-memory copy (see BPlusTreeDirCache) instead of their pages.
 class BPlusTree : public Index {
 public:
-  BPlusTree(const HeapFile& heap_file, int key_col_idx, const std::string& idx_name);
+  // a node using less than this after a delete is merged with a sibling
+  static constexpr size_t MERGE_MIN_SIZE = Page::SIZE / 4;
+
+  // nodes are merged only if the result uses at most this, so it does not split again soon
+  static constexpr size_t MERGE_MAX_SIZE = Page::SIZE * 3 / 4;
+
+  // the pages of merged nodes are reused once there are at least this many (see release_removed_pages)
+  static constexpr int64_t MIN_RELEASED_PAGES = 64;
+
+  // Counts an operation or iterator while it is alive, see release_removed_pages
+  class OperationGuard {
+  public:
+    OperationGuard(const BPlusTree& bpt)
+        : bpt(bpt) {
+      bpt.active_operations++;
+    }
+
+    ~OperationGuard() {
+      bpt.active_operations--;
+    }
+
+  private:
+    const BPlusTree& bpt;
+  };
+
+  // the key is the concatenation of the `key_columns` (a composite key when there are several). The
+  // leaves also store the values of `include_columns` (a covering index), so index-only scans can return
+  // them without reading the heap file
+  BPlusTree(
+      const HeapFile& heap_file,
+      const std::vector<int64_t>& key_columns,
+      const std::string& idx_name,
+      const std::vector<int64_t>& include_columns = {}
+  );
+
+  // saves the free pages of the files
+  ~BPlusTree();
+
+  // inserts the entry of a record already read, it may be called concurrently with other inserts and
+  // iterators
+  void insert_record(const Record& record, RID rid) override;
+
+  // inserts many entries (see encode_entry), sorting them first so they are inserted in one sweep of the
+  // leaves from left to right: a leaf stays latched while the next entries still go to it, and the leaf of
+  // the next entry is searched from the dir above the last leaf when it is there. It may be called
+  // concurrently with other inserts and iterators
+  void insert_entries(std::vector<BPlusTreeRecord>& entries);
+
+  // deletes the entry of a record, merging the nodes that get too small. It may be called concurrently
+  // with inserts and iterators
+  void delete_record(const Record& record, RID rid) override;
+
+  using Index::get_iter;
+
+  // reads the records with min <= key <= max from the heap file
+  std::unique_ptr<RelationIter> get_iter(
+      const std::vector<Value>& min, const std::vector<Value>& max
+  ) override;
+
+  // returns the records with min <= key <= max without reading the heap file. Only the key and the
+  // INCLUDE columns are written into the output record, the other columns are left unchanged
+  // (or undefined in batches)
+  std::unique_ptr<RelationIter> get_index_only_iter(
+      const std::vector<Value>& min, const std::vector<Value>& max
+  );
 
-  void insert_record(RID rid) override;
+  // bounds only the first key column
+  std::unique_ptr<RelationIter> get_index_only_iter(const Value& min, const Value& max) {
+    return get_index_only_iter(std::vector<Value>{min}, std::vector<Value>{max});
+  }
 
-  void delete_record(RID rid) override;
+  // reads the records with min <= key <= max from the heap file in physical order instead of key order,
+  // reading each heap page once (see BPlusTreeBitmapIter). Prefer it over get_iter for ranges matching
+  // a large fraction of the table when the order of the keys is not needed
+  std::unique_ptr<RelationIter> get_bitmap_iter(const std::vector<Value>& min, const std::vector<Value>& max);
 
-  std::unique_ptr<RelationIter> get_iter(const Value& min, const Value& max) override;
+  std::unique_ptr<RelationIter> get_bitmap_iter(const Value& min, const Value& max) {
+    return get_bitmap_iter(std::vector<Value>{min}, std::vector<Value>{max});
+  }
 
   IndexType get_type() override {
     return IndexType::B_PLUS_TREE;
   }
 
+  const std::vector<int64_t>& get_key_columns() const override {
+    return key_columns;
+  }
+
+  // writes the B+tree entry of `record` (key, RID and INCLUDE columns) into out, returns its size
+  size_t encode_entry(const Record& record, RID rid, char* out) const;
+
+  // returns the page number of the node at `level` (0 for leaves, 1 for the dirs above them, etc.) where
+  // the record is or would be, descending from the root. The node is not latched when this returns, so
+  // it may have been split meanwhile and the caller must check if it has to move right
+  int32_t find_node(const BPlusTreeRecord& record, int32_t level) const;
+
+  // descents read every dir from its page if `enabled` is false. Not thread-safe, used to compare them
+  void set_dir_cache_enabled(bool enabled) {
+    dir_cache_enabled = enabled;
+  }
+
+  // returns a page for a new node of the file (leaf_file_id or dir_file_id), reusing a page of a removed
+  // node if there is one
+  Page& allocate_page(FileId file_id) const;
+
+  // returns the size of the key at the beginning of an entry
+  size_t get_key_size(const BPlusTreeRecord& entry) const {
+    size_t size = 0;
+    for (auto datatype : key_datatypes) {
+      size += KeyEncoding::encoded_size(datatype, entry.bytes + size);
+    }
+    return size;
+  }
+
   const HeapFile& heap_file;
 
-  const int key_column_idx;
+  const std::vector<int64_t> key_columns;
+
+  // datatypes of the key columns
+  const std::vector<DataType> key_datatypes;
+
+  const std::vector<int64_t> include_columns;
 
   const FileId dir_file_id;
 
   const FileId leaf_file_id;
 
-  // we reuse this attribute in inserts/deletes to reduce allocations
-  Record record_buf;
-
+  // the root is always the dir at page 0, kept pinned
   std::unique_ptr<BPlusTreeDir> root;
+
+private:
+  // number of OperationGuard alive
+  mutable std::atomic<int64_t> active_operations;
+
+  // protects the free and removed pages below
+  mutable std::mutex free_pages_mutex;
+
+  // free pages are linked by their next leaf / right sibling, 0 if there are none. They are saved in the
+  // leaf 0 and the root when the B+tree is closed
+  mutable int32_t first_free_leaf;
+
+  mutable int32_t first_free_dir;
+
+  // pages of the nodes removed by merges that may still be reached by running operations
+  std::vector<int32_t> removed_leaves;
+
+  std::vector<int32_t> removed_dirs;
+
+  // size of removed_leaves plus removed_dirs, so operations check it without locking free_pages_mutex
+  std::atomic<int64_t> removed_page_count;
+
+  bool dir_cache_enabled;
+
+  // copy of the upper levels used by descents, read again when it gets stale (see get_dir_cache). It is
+  // read with std::atomic_load, and replaced holding dir_cache_mutex
+  mutable std::shared_ptr<const BPlusTreeDirCache> dir_cache;
+
+  mutable std::mutex dir_cache_mutex;
+
+  // incremented when dir_cache is discarded, so a copy being read at that moment is not used
+  mutable std::atomic<int64_t> dir_cache_version;
+
+  // separators inserted in the levels of dir_cache since it was read
+  mutable std::atomic<int64_t> dir_cache_changes;
+
+  // true while a thread reads a new dir_cache
+  mutable std::atomic<bool> dir_cache_reading;
+
+  void insert_entry(const BPlusTreeRecord& entry);
+
+  // same as find_node(record, 0), but starting from the dir of level 1 `*dir_page_number` (if it is not
+  // negative) when the record is not at its right. The record must not be at the left of that dir, as when
+  // records are searched in order. Writes into dir_page_number the dir where the leaf was found
+  int32_t find_leaf(const BPlusTreeRecord& record, int32_t* dir_page_number) const;
+
+  // inserts the separator of a split leaf in the dir above it, splitting the dirs that get full
+  void insert_separators(std::unique_ptr<BPlusTreeSplit> split);
+
+  // returns the leaf where the entry goes, latched (exclusive), starting from `leaf` if it is not nullptr
+  // (already latched) and descending from the root otherwise
+  std::unique_ptr<BPlusTreeLeaf> latch_leaf(
+      const BPlusTreeRecord& entry, std::unique_ptr<BPlusTreeLeaf> leaf
+  );
+
+  // returns the dir at `level` where the record goes, latched (exclusive). The level must exist
+  std::unique_ptr<BPlusTreeDir> latch_dir(const BPlusTreeRecord& record, int32_t level);
+
+  // merges the node at `level` where the record goes with its right sibling, or else with its left
+  // sibling, if both are children of the same dir and fit in MERGE_MAX_SIZE. Returns true if that dir is
+  // left too small (and it is not the root)
+  bool merge_children(const BPlusTreeRecord& record, int32_t level);
+
+  // merges the children `idx` and `idx + 1` of a latched dir, returns false if they were not merged
+  bool merge_leaves(BPlusTreeDir& parent, int32_t idx);
+
+  bool merge_dirs(BPlusTreeDir& parent, int32_t idx);
+
+  // moves the removed pages to the free pages if no operation is running, as only the operations that were
+  // running when a node was removed may reach it. Called by inserts and deletes while they are not counted.
+  // It discards the copy of the upper levels, so it does nothing until MIN_RELEASED_PAGES were removed
+  void release_removed_pages();
+
+  // links the page to the free pages of the file, the caller must hold free_pages_mutex
+  void free_page(FileId file_id, int32_t page_number);
+
+  // returns the copy of the upper levels, reading it again if many separators were inserted since it was
+  // read. Meanwhile other threads get the stale copy, that is still valid. Returns nullptr if it is
+  // disabled or there is no valid copy
+  std::shared_ptr<const BPlusTreeDirCache> get_dir_cache() const;
+
+  // lowest level a BPlusTreeDirCache of this B+tree may have
+  int32_t get_lowest_cached_level() const;
+
+  // discards the copy of the upper levels, needed before reusing the pages of nodes it may point to
+  void discard_dir_cache();
+
+  std::unique_ptr<RelationIter> make_iter(
+      const std::vector<Value>& min, const std::vector<Value>& max, bool index_only
+  );
 };
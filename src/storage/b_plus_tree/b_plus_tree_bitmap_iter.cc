@@ -0,0 +1,87 @@
+#include "b_plus_tree_bitmap_iter.h"
+
+#include <algorithm>
+
+#include "storage/b_plus_tree/b_plus_tree_iter.h"
+#include "storage/heap_file/heap_file.h"
+
+BPlusTreeBitmapIter::BPlusTreeBitmapIter(
+    const BPlusTree& bpt, const std::vector<Value>& min, const std::vector<Value>& max
+)
+    : bpt(bpt),
+      min(min),
+      max(max),
+      collected(false),
+      current_pos(0) {}
+
+void BPlusTreeBitmapIter::begin(Record& _out) {
+  out = &_out;
+  reset();
+}
+
+void BPlusTreeBitmapIter::reset() {
+  if (!collected) {
+    collect_rids();
+  }
+  current_pos = 0;
+  current_page.reset();
+}
+
+void BPlusTreeBitmapIter::collect_rids() {
+  // the key iterator is destroyed at the end, unpinning its last leaf
+  BPlusTreeIter key_iter(bpt, min, max, true);
+  RID rid;
+  while (key_iter.next_rid(&rid)) {
+    rids.push_back(rid);
+  }
+  std::sort(rids.begin(), rids.end());
+  collected = true;
+}
+
+void BPlusTreeBitmapIter::move_to_page() {
+  auto page_number = rids[current_pos].page_num;
+  if (current_page == nullptr || current_page->page.page_id.page_number != page_number) {
+    current_page.reset(); // unpin before pinning the next one
+    current_page = bpt.heap_file.get_page(page_number);
+  }
+}
+
+bool BPlusTreeBitmapIter::next() {
+  while (current_pos < rids.size()) {
+    move_to_page();
+    auto slot = rids[current_pos++].dir_slot;
+    // the entry may point to a record deleted after the RIDs were collected
+    if (current_page->get_record(slot, *out)) {
+      return true;
+    }
+  }
+  current_page.reset();
+  return false;
+}
+
+bool BPlusTreeBitmapIter::next_batch(ColumnBatch& batch) {
+  batch.clear();
+  if (!collected) {
+    reset();
+  }
+
+  while (!batch.full() && current_pos < rids.size()) {
+    move_to_page();
+
+    // the following RIDs with consecutive slots of the same page are read together
+    auto run_end = current_pos + 1;
+    while (run_end < rids.size() && rids[run_end].page_num == rids[current_pos].page_num
+           && rids[run_end].dir_slot == rids[run_end - 1].dir_slot + 1)
+    {
+      run_end++;
+    }
+    auto begin_slot = rids[current_pos].dir_slot;
+    auto end_slot = begin_slot + static_cast<int32_t>(run_end - current_pos);
+    auto next_slot = current_page->append_to_batch(begin_slot, end_slot, batch, bpt.heap_file.schema, {}, {});
+    current_pos += next_slot - begin_slot;
+  }
+  if (current_pos == rids.size()) {
+    current_page.reset();
+  }
+  return batch.size > 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "relational_model/relation_iter.h"
+#include "relational_model/value.h"
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/heap_file/rid.h"
+#include "storage/heap_file/table_page.h"
+
+// Returns the records with min <= key <= max, like BPlusTreeIter, but visiting the heap file in physical
+// order: the RIDs of the range are collected from the leaves and sorted first, so each heap page is read
+// once and consecutive slots of a page are read together. Records are not returned in key order.
+// Pays off for ranges matching many records of a column not correlated with the order of the heap file,
+// where fetching in key order pins the same pages over and over.
+// The RIDs are collected in the first call to begin() or next_batch(), reset() reuses them.
+class BPlusTreeBitmapIter : public RelationIter {
+public:
+  BPlusTreeBitmapIter(const BPlusTree& bpt, const std::vector<Value>& min, const std::vector<Value>& max);
+
+  virtual void begin(Record& out) override;
+
+  virtual bool next() override;
+
+  virtual bool next_batch(ColumnBatch& batch) override;
+
+  virtual void reset() override;
+
+private:
+  const BPlusTree& bpt;
+
+  const std::vector<Value> min;
+
+  const std::vector<Value> max;
+
+  bool collected;
+
+  // sorted by page and slot
+  std::vector<RID> rids;
+
+  // position in rids of the next record to return
+  size_t current_pos;
+
+  // the page of rids[current_pos - 1], kept pinned
+  std::unique_ptr<TablePage> current_page;
+
+  Record* out;
+
+  void collect_rids();
+
+  // pins the page of rids[current_pos] if it is not the current one
+  void move_to_page();
+};
@@ -0,0 +1,373 @@
+#include "b_plus_tree_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/b_plus_tree/b_plus_tree_dir.h"
+#include "storage/b_plus_tree/b_plus_tree_leaf.h"
+#include "storage/filesystem.h"
+#include "system/arena.h"
+#include "system/system.h"
+
+// heap pages taken at once by a thread collecting entries
+static constexpr int64_t PAGES_PER_RANGE = 64;
+
+namespace {
+// Sorted sequence of entries to merge
+class SortedSource {
+public:
+  BPlusTreeRecord entry;
+
+  SortedSource()
+      : entry(nullptr, 0) {}
+
+  virtual ~SortedSource() = default;
+
+  // moves to the next entry, returns false if there are no more entries
+  virtual bool next() = 0;
+};
+
+// Reads the entries of a run, each one stored as its size (uint16) followed by its bytes
+class RunSource : public SortedSource {
+public:
+  RunSource(const std::string& path)
+      : file(path, std::ios::binary) {}
+
+  bool next() override {
+    uint16_t size;
+    if (!file.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+      return false;
+    }
+    file.read(bytes, size);
+    entry = BPlusTreeRecord(bytes, size);
+    return true;
+  }
+
+private:
+  std::ifstream file;
+
+  char bytes[BPlusTreeRecord::MAX_SIZE];
+};
+
+// Reads sorted entries kept in memory
+template <class Entry>
+class MemorySource : public SortedSource {
+public:
+  MemorySource(const std::vector<char>& bytes, const std::vector<Entry>& entries)
+      : bytes(bytes),
+        entries(entries) {}
+
+  bool next() override {
+    if (current == entries.size()) {
+      return false;
+    }
+    auto& current_entry = entries[current++];
+    entry = BPlusTreeRecord(bytes.data() + current_entry.offset, current_entry.size);
+    return true;
+  }
+
+private:
+  const std::vector<char>& bytes;
+
+  const std::vector<Entry>& entries;
+
+  size_t current = 0;
+};
+
+// Tournament tree for a k-way merge: each internal node keeps the loser of the match between the winners
+// of its two subtrees, so getting the next entry replays only the path of the last winner, with log(k)
+// comparisons. Sources are the leaves k..2k-1 of the implicit tree, the overall winner is kept at 0.
+class LoserTree {
+public:
+  LoserTree(std::vector<std::unique_ptr<SortedSource>>& sources)
+      : sources(sources),
+        exhausted(sources.size()),
+        losers(std::max<size_t>(sources.size(), 1), EMPTY) {
+    // the first source reaching a node waits there for the winner of the other subtree
+    for (int64_t source = static_cast<int64_t>(sources.size()) - 1; source >= 0; source--) {
+      exhausted[source] = !sources[source]->next();
+      replay(source, true);
+    }
+  }
+
+  // returns the source with the lowest entry, or -1 if all the sources are exhausted
+  int64_t get_winner() const {
+    auto winner = losers[0];
+    return winner == EMPTY || exhausted[winner] ? -1 : winner;
+  }
+
+  // moves the winner to its next entry
+  void pop() {
+    auto winner = losers[0];
+    exhausted[winner] = !sources[winner]->next();
+    replay(winner, false);
+  }
+
+private:
+  static constexpr int64_t EMPTY = -1;
+
+  std::vector<std::unique_ptr<SortedSource>>& sources;
+
+  std::vector<bool> exhausted;
+
+  std::vector<int64_t> losers;
+
+  // returns true if the entry of lhs goes before the entry of rhs
+  bool beats(int64_t lhs, int64_t rhs) const {
+    if (exhausted[lhs]) {
+      return false;
+    }
+    return exhausted[rhs] || sources[lhs]->entry < sources[rhs]->entry;
+  }
+
+  void replay(int64_t source, bool initializing) {
+    const auto k = static_cast<int64_t>(sources.size());
+    auto winner = source;
+    for (auto node = (source + k) / 2; node > 0; node /= 2) {
+      if (initializing && losers[node] == EMPTY) {
+        losers[node] = winner;
+        return;
+      }
+      if (beats(losers[node], winner)) {
+        std::swap(losers[node], winner);
+      }
+    }
+    losers[0] = winner;
+  }
+};
+} // namespace
+
+void BPlusTreeBuilder::Partition::add(const char* entry, size_t size) {
+  entries.push_back({bytes.size(), size});
+  bytes.insert(bytes.end(), entry, entry + size);
+}
+
+void BPlusTreeBuilder::Partition::sort() {
+  const char* data = bytes.data();
+  std::sort(entries.begin(), entries.end(), [data](const Entry& lhs, const Entry& rhs) {
+    return KeyEncoding::compare(data + lhs.offset, lhs.size, data + rhs.offset, rhs.size) < 0;
+  });
+}
+
+void BPlusTreeBuilder::Partition::clear() {
+  bytes.clear();
+  entries.clear();
+}
+
+void BPlusTreeBuilder::Level::add(const BPlusTreeRecord& separator, int32_t child) {
+  separators.push_back({bytes.size(), separator.size});
+  bytes.insert(bytes.end(), separator.bytes, separator.bytes + separator.size);
+  children.push_back(child);
+}
+
+BPlusTreeBuilder::BPlusTreeBuilder(
+    BPlusTree& bpt, const BPlusTreeBuildOptions& options, const std::string& run_path
+)
+    : bpt(bpt),
+      options(options),
+      run_path(run_path),
+      page_fill(options.fill_factor * Page::SIZE) {
+  assert(options.fill_factor > 0 && options.fill_factor <= 1);
+  leaves.first_child = 0;
+}
+
+BPlusTreeBuilder::~BPlusTreeBuilder() {
+  for (int64_t run = 0; run < run_count; run++) {
+    Filesystem::remove(get_run_path(run));
+  }
+}
+
+void BPlusTreeBuilder::build() {
+  auto thread_count = options.thread_count;
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  partitions.resize(thread_count);
+
+  auto page_count = file_mgr.count_pages(bpt.heap_file.file_id);
+  std::atomic<int64_t> next_page(0);
+  if (thread_count == 1) {
+    collect(0, next_page, page_count);
+  } else {
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < thread_count; thread++) {
+      threads.emplace_back(&BPlusTreeBuilder::collect, this, thread, std::ref(next_page), page_count);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  merge();
+  partitions.clear();
+
+  write_leaf(BPlusTreeRecord(nullptr, 0));
+  write_dirs(leaves);
+}
+
+void BPlusTreeBuilder::collect(size_t thread, std::atomic<int64_t>& next_page, int64_t page_count) {
+  auto& heap_file = bpt.heap_file;
+  auto& partition = partitions[thread];
+  const auto partition_budget = options.memory_budget / partitions.size();
+
+  Arena arena;
+  Record record(heap_file.schema, arena);
+  char entry[BPlusTreeRecord::MAX_SIZE];
+
+  while (true) {
+    auto begin = next_page.fetch_add(PAGES_PER_RANGE);
+    if (begin >= page_count) {
+      break;
+    }
+    auto end = std::min(begin + PAGES_PER_RANGE, page_count);
+
+    for (auto page_number = begin; page_number < end; page_number++) {
+      auto page = heap_file.get_page(page_number);
+      auto dir_count = page->get_dir_count();
+      for (int32_t slot = 0; slot < dir_count; slot++) {
+        if (!page->get_record(slot, record)) {
+          continue;
+        }
+        partition.add(entry, bpt.encode_entry(record, RID(page_number, slot), entry));
+
+        if (partition.bytes.size() + partition.entries.size() * sizeof(Entry) >= partition_budget) {
+          spill(partition);
+        }
+      }
+    }
+  }
+  partition.sort();
+}
+
+void BPlusTreeBuilder::spill(Partition& partition) {
+  partition.sort();
+
+  int64_t run;
+  {
+    std::lock_guard<std::mutex> lck(runs_mutex);
+    run = run_count++;
+  }
+  std::ofstream file(get_run_path(run), std::ios::binary);
+  for (auto& entry : partition.entries) {
+    auto size = static_cast<uint16_t>(entry.size);
+    file.write(reinterpret_cast<char*>(&size), sizeof(size));
+    file.write(partition.bytes.data() + entry.offset, entry.size);
+  }
+  partition.clear();
+}
+
+void BPlusTreeBuilder::merge() {
+  std::vector<std::unique_ptr<SortedSource>> sources;
+  for (auto& partition : partitions) {
+    sources.push_back(std::make_unique<MemorySource<Entry>>(partition.bytes, partition.entries));
+  }
+  for (int64_t run = 0; run < run_count; run++) {
+    sources.push_back(std::make_unique<RunSource>(get_run_path(run)));
+  }
+
+  LoserTree tree(sources);
+  for (auto source = tree.get_winner(); source != -1; source = tree.get_winner()) {
+    add_to_leaf(sources[source]->entry);
+    tree.pop();
+  }
+}
+
+void BPlusTreeBuilder::add_to_leaf(const BPlusTreeRecord& entry) {
+  if (!leaf_entries.empty()) {
+    // size of the leaf with the new entry, with prefix compression (see BPlusTreeLeaf::rebuild)
+    BPlusTreeRecord first(leaf_bytes.data() + leaf_entries[0].offset, leaf_entries[0].size);
+    auto prefix_size = first.common_prefix_size(entry);
+    auto count = leaf_entries.size() + 1;
+    auto suffixes_size = leaf_size + BPlusTreeLeaf::SLOT_SIZE + entry.size - count * prefix_size;
+    auto size = BPlusTreeLeaf::OFFSET_SLOTS + prefix_size + suffixes_size;
+
+    // the high key is not longer than the last entry of the leaf, so it must fit too
+    if (size > page_fill || size + entry.size > Page::SIZE) {
+      // the separator is the shortest prefix of entry greater than the last entry, as in leaf splits
+      auto& last_entry = leaf_entries.back();
+      BPlusTreeRecord last(leaf_bytes.data() + last_entry.offset, last_entry.size);
+      BPlusTreeRecord separator(entry.bytes, entry.common_prefix_size(last) + 1);
+
+      write_leaf(separator);
+      leaves.add(separator, leaf_page_number);
+    }
+  }
+  leaf_entries.push_back({leaf_bytes.size(), entry.size});
+  leaf_bytes.insert(leaf_bytes.end(), entry.bytes, entry.bytes + entry.size);
+  leaf_size += BPlusTreeLeaf::SLOT_SIZE + entry.size;
+}
+
+void BPlusTreeBuilder::write_leaf(const BPlusTreeRecord& high_key) {
+  std::vector<BPlusTreeRecord> records;
+  records.reserve(leaf_entries.size());
+  for (auto& entry : leaf_entries) {
+    records.emplace_back(leaf_bytes.data() + entry.offset, entry.size);
+  }
+
+  BPlusTreeLeaf leaf(bpt, leaf_page_number);
+  leaf.rebuild(records.data(), records.size(), high_key);
+  if (high_key.size > 0) {
+    BPlusTreeLeaf next_leaf(bpt);
+    leaf_page_number = next_leaf.page.get_page_number();
+    leaf.set_next_page_number(leaf_page_number);
+  }
+
+  leaf_bytes.clear();
+  leaf_entries.clear();
+  leaf_size = 0;
+}
+
+void BPlusTreeBuilder::write_dirs(Level& level) {
+  for (int32_t dir_level = 1; ; dir_level++) {
+    auto get_separator = [&](size_t i) {
+      return BPlusTreeRecord(level.bytes.data() + level.separators[i].offset, level.separators[i].size);
+    };
+
+    size_t level_size = BPlusTreeDir::OFFSET_SLOTS;
+    for (auto& separator : level.separators) {
+      level_size += BPlusTreeDir::RECORD_OVERHEAD + separator.size;
+    }
+
+    if (level_size <= Page::SIZE) {
+      // the level fits in the root
+      auto& root = *bpt.root;
+      root.clear(level.first_child, dir_level);
+      for (size_t i = 0; i < level.separators.size(); i++) {
+        root.insert_at(i, get_separator(i), level.children[i]);
+      }
+      return;
+    }
+
+    Level upper;
+    auto dir = std::make_unique<BPlusTreeDir>(bpt);
+    dir->clear(level.first_child, dir_level);
+    upper.first_child = -1 * dir->page.get_page_number();
+    size_t dir_size = BPlusTreeDir::OFFSET_SLOTS;
+
+    for (size_t i = 0; i < level.separators.size(); i++) {
+      auto separator = get_separator(i);
+      auto separator_size = BPlusTreeDir::RECORD_OVERHEAD + separator.size;
+      // if the dir ends after this separator, the next one is its high key
+      auto high_key_size = i + 1 < level.separators.size() ? level.separators[i + 1].size : 0;
+
+      if (dir->get_record_count() > 0 && dir_size + separator_size + high_key_size > page_fill) {
+        // the separator goes to the upper level, its child is the first child of a new dir at the right
+        auto new_dir = std::make_unique<BPlusTreeDir>(bpt);
+        new_dir->clear(level.children[i], dir_level);
+        dir->set_right_sibling(new_dir->page.get_page_number(), separator);
+        dir = std::move(new_dir);
+        upper.add(separator, -1 * dir->page.get_page_number());
+        dir_size = BPlusTreeDir::OFFSET_SLOTS;
+      } else {
+        dir->insert_at(dir->get_record_count(), separator, level.children[i]);
+        dir_size += separator_size;
+      }
+    }
+    dir.reset();
+    level = std::move(upper);
+  }
+}
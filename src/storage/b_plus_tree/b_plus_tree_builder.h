@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "storage/b_plus_tree/b_plus_tree_utils.h"
+
+class BPlusTree;
+
+struct BPlusTreeBuildOptions {
+  // fraction of each page filled by the build, in (0, 1]. Lower values leave space for later inserts
+  // without splits
+  double fill_factor = 0.9;
+
+  // bytes of entries sorted in memory, shared by all the threads. More entries are sorted in runs written
+  // to temporary files
+  size_t memory_budget = 64 * 1024 * 1024;
+
+  // threads reading the heap file and sorting the entries, 0 means one per hardware thread
+  size_t thread_count = 0;
+};
+
+// Builds a new (empty) B+tree bottom-up from the records of its heap file:
+// - Threads take ranges of heap pages, collect the entries of their records and sort them. Each thread
+//   has its part of the memory budget, and writes a sorted run to a temporary file when it is exceeded.
+// - The sorted sequences of all the threads (in memory and in files) are merged with a loser tree,
+//   and the merged entries are written to the leaves from left to right.
+// - Then each level of dirs is written, until a level fits in the root. The nodes of each level are
+//   linked with their high keys, as in BPlusTree inserts.
+// Every page is filled up to the fill factor.
+class BPlusTreeBuilder {
+public:
+  // temporary runs are written to `run_path` followed by a number
+  BPlusTreeBuilder(BPlusTree& bpt, const BPlusTreeBuildOptions& options, const std::string& run_path);
+
+  ~BPlusTreeBuilder();
+
+  void build();
+
+private:
+  // position of an entry inside a buffer
+  struct Entry {
+    size_t offset;
+    size_t size;
+  };
+
+  // entries collected by a thread, sorted at the end
+  struct Partition {
+    std::vector<char> bytes;
+    std::vector<Entry> entries;
+
+    void add(const char* entry, size_t size);
+
+    void sort();
+
+    void clear();
+  };
+
+  // children of a level of the tree being built: the first child and the (separator, right child) pairs
+  struct Level {
+    int32_t first_child;
+    std::vector<char> bytes;
+    std::vector<Entry> separators;
+    std::vector<int32_t> children;
+
+    void add(const BPlusTreeRecord& separator, int32_t child);
+  };
+
+  BPlusTree& bpt;
+
+  const BPlusTreeBuildOptions options;
+
+  const std::string run_path;
+
+  const size_t page_fill;
+
+  std::vector<Partition> partitions;
+
+  // protects run_count
+  std::mutex runs_mutex;
+
+  int64_t run_count = 0;
+
+  // entries of the leaf being built
+  std::vector<char> leaf_bytes;
+
+  std::vector<Entry> leaf_entries;
+
+  // size of the slots and entries in the leaf being built, without prefix compression
+  size_t leaf_size = 0;
+
+  int32_t leaf_page_number = 0;
+
+  Level leaves;
+
+  // collects the entries of the heap pages taken from `next_page` into partitions[thread]
+  void collect(size_t thread, std::atomic<int64_t>& next_page, int64_t page_count);
+
+  // sorts the partition and writes it to a new run
+  void spill(Partition& partition);
+
+  // merges the sorted partitions and runs into the leaves
+  void merge();
+
+  // appends the next entry, in order, to the leaves
+  void add_to_leaf(const BPlusTreeRecord& entry);
+
+  // writes the entries of the leaf being built. Unless it is the last leaf (the high key is empty), a new
+  // leaf is appended as its next leaf
+  void write_leaf(const BPlusTreeRecord& high_key);
+
+  void write_dirs(Level& level);
+
+  std::string get_run_path(int64_t run) const {
+    return run_path + std::to_string(run);
+  }
+};
@@ -1,180 +1,352 @@
 #include "b_plus_tree_dir.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "storage/b_plus_tree/b_plus_tree.h"
-#include "storage/b_plus_tree/b_plus_tree_leaf.h"
 #include "storage/b_plus_tree/b_plus_tree_utils.h"
 #include "system/system.h"
 
+// returns the record `idx` of a dir page stored at page_bytes
+static BPlusTreeRecord read_record(const char* page_bytes, int32_t idx) {
+  uint16_t location[2];
+  auto slot_offset = BPlusTreeDir::OFFSET_SLOTS + idx * BPlusTreeDir::SLOT_SIZE;
+  std::memcpy(location, page_bytes + slot_offset + sizeof(uint32_t), sizeof(location));
+  return BPlusTreeRecord(page_bytes + location[0], location[1]);
+}
+
+// returns the child at the right of the record `idx` of a dir page stored at page_bytes
+static int32_t read_right_child(const char* page_bytes, int32_t idx) {
+  int32_t child;
+  auto record = read_record(page_bytes, idx);
+  std::memcpy(&child, record.bytes - sizeof(child), sizeof(child));
+  return child;
+}
+
+// returns the high key of a dir page stored at page_bytes
+static BPlusTreeRecord read_high_key(const char* page_bytes) {
+  int32_t high_key[2];
+  std::memcpy(high_key, page_bytes + BPlusTreeDir::OFFSET_HIGH_KEY, sizeof(high_key));
+  return BPlusTreeRecord(page_bytes + high_key[0], high_key[1]);
+}
+
 BPlusTreeDir::BPlusTreeDir(const BPlusTree& bpt, int32_t page_number)
     : bpt(bpt),
       page(buffer_mgr.get_page(bpt.dir_file_id, page_number)) {}
 
 BPlusTreeDir::BPlusTreeDir(const BPlusTree& bpt)
     : bpt(bpt),
-      page(buffer_mgr.append_page(bpt.dir_file_id)) {}
+      page(bpt.allocate_page(bpt.dir_file_id)) {}
 
 BPlusTreeDir::~BPlusTreeDir() {
   page.unpin();
 }
 
-int32_t BPlusTreeDir::get_child_count() const {
-  return page.read_int32(OFFSET_CHILD_COUNT);
+void BPlusTreeDir::init() {
+  clear(0, 1);
 }
 
-void BPlusTreeDir::set_child_count(int32_t child_count) {
-  page.write_int32(OFFSET_CHILD_COUNT, child_count);
+int32_t BPlusTreeDir::get_record_count() const {
+  return page.read_int32(OFFSET_RECORD_COUNT);
 }
 
-// valid index goes from [0, get_child_count() - 1]
-int32_t BPlusTreeDir::get_child(size_t index) const {
-  return page.read_int32(OFFSET_CHILDREN + sizeof(child_t) * index);
+void BPlusTreeDir::set_record_count(int32_t record_count) {
+  page.write_int32(OFFSET_RECORD_COUNT, record_count);
 }
 
-void BPlusTreeDir::set_child(size_t index, int32_t child) {
-  page.write_int32(OFFSET_CHILDREN + sizeof(child_t) * index, child);
+int32_t BPlusTreeDir::get_data_begin() const {
+  return page.read_int32(OFFSET_DATA_BEGIN);
 }
 
-// valid index goes from [0, get_child_count() - 2]
-BPlusTreeRecord BPlusTreeDir::get_record(size_t index) const {
-  auto offset = OFFSET_RECORD + index * sizeof(BPlusTreeRecord);
-  auto encoded_key = page.read_int64(offset);
-  auto page_num = page.read_int32(offset + 8);
-  auto dir_slot = page.read_int32(offset + 12);
-  return BPlusTreeRecord(encoded_key, RID(page_num, dir_slot));
+void BPlusTreeDir::set_data_begin(int32_t data_begin) {
+  page.write_int32(OFFSET_DATA_BEGIN, data_begin);
 }
 
-void BPlusTreeDir::set_record(size_t index, const BPlusTreeRecord& record) {
-  auto offset = OFFSET_RECORD + index * sizeof(BPlusTreeRecord);
-  page.write_int64(offset, record.encoded_key);
-  page.write_int32(offset + 8, record.rid.page_num);
-  page.write_int32(offset + 12, record.rid.dir_slot);
+int32_t BPlusTreeDir::get_free_space() const {
+  return get_data_begin() - static_cast<int32_t>(OFFSET_SLOTS + get_record_count() * SLOT_SIZE);
 }
 
-BPlusTreeSearchResult BPlusTreeDir::search_leaf(const BPlusTreeRecord& record) {
-  auto dir_index = search_child_idx(record);
-  auto page_num = get_child(dir_index);
+int32_t BPlusTreeDir::get_level() const {
+  return page.read_int32(OFFSET_LEVEL);
+}
 
-  if (page_num < 0) { // negative number: pointer to dir
-    BPlusTreeDir child(bpt, -1 * page_num);
-    return child.search_leaf(record);
-  } else { // positive number: pointer to leaf
-    BPlusTreeLeaf child(bpt, page_num);
-    auto index = child.search_index(record);
-    return BPlusTreeSearchResult(page_num, index);
+bool BPlusTreeDir::is_removed() const {
+  return page.read_int32(OFFSET_REMOVED) != 0;
+}
+
+size_t BPlusTreeDir::get_used_size() const {
+  const auto record_count = get_record_count();
+  size_t size = OFFSET_SLOTS + get_high_key().size + record_count * RECORD_OVERHEAD;
+  for (int32_t i = 0; i < record_count; i++) {
+    size += get_record(i).size;
   }
+  return size;
+}
+
+int32_t BPlusTreeDir::get_right_sibling() const {
+  return page.read_int32(OFFSET_RIGHT_SIBLING);
+}
+
+BPlusTreeRecord BPlusTreeDir::get_high_key() const {
+  return read_high_key(page.get_bytes());
 }
 
-int32_t BPlusTreeDir::search_child_idx(const BPlusTreeRecord& record) {
-  auto from = 0;
-  auto to = get_child_count() - 1;
+bool BPlusTreeDir::goes_right(const BPlusTreeRecord& record) const {
+  return get_right_sibling() != 0 && !(record < get_high_key());
+}
 
-  while (from != to) {
-    auto middle_idx = ((from + to + 1) / 2) - 1;
-    if (record < get_record(middle_idx)) {
-      to = middle_idx;
+int32_t BPlusTreeDir::get_child(int32_t index) const {
+  if (index == 0) {
+    return page.read_int32(OFFSET_FIRST_CHILD);
+  }
+  return read_right_child(page.get_bytes(), index - 1);
+}
+
+BPlusTreeRecord BPlusTreeDir::get_record(int32_t index) const {
+  return read_record(page.get_bytes(), index);
+}
+
+void BPlusTreeDir::clear(int32_t first_child, int32_t level) {
+  set_record_count(0);
+  set_data_begin(Page::SIZE);
+  page.write_int32(OFFSET_FIRST_CHILD, first_child);
+  page.write_int32(OFFSET_RIGHT_SIBLING, 0);
+  page.write_int32(OFFSET_LEVEL, level);
+  page.write_int32(OFFSET_HIGH_KEY, Page::SIZE);
+  page.write_int32(OFFSET_HIGH_KEY + sizeof(high_key_t), 0);
+  page.write_int32(OFFSET_PREFIX_SIZE, 0);
+  page.write_int32(OFFSET_REMOVED, 0);
+  page.write_int32(OFFSET_FIRST_FREE, 0);
+}
+
+void BPlusTreeDir::set_right_sibling(int32_t right_sibling, const BPlusTreeRecord& high_key) {
+  assert(static_cast<int32_t>(high_key.size) <= get_free_space());
+
+  auto data_begin = get_data_begin() - static_cast<int32_t>(high_key.size);
+  page.write(data_begin, high_key.size, high_key.bytes);
+  set_data_begin(data_begin);
+
+  page.write_int32(OFFSET_RIGHT_SIBLING, right_sibling);
+  page.write_int32(OFFSET_HIGH_KEY, data_begin);
+  page.write_int32(OFFSET_HIGH_KEY + sizeof(high_key_t), high_key.size);
+}
+
+void BPlusTreeDir::insert_at(int32_t idx, const BPlusTreeRecord& record, int32_t right_child) {
+  const auto record_count = get_record_count();
+  assert(static_cast<int32_t>(RECORD_OVERHEAD + record.size) <= get_free_space());
+
+  auto record_begin = get_data_begin() - static_cast<int32_t>(record.size);
+  page.write(record_begin, record.size, record.bytes);
+  auto data_begin = record_begin - static_cast<int32_t>(sizeof(child_t));
+  page.write_int32(data_begin, right_child);
+  set_data_begin(data_begin);
+
+  auto slot_offset = OFFSET_SLOTS + idx * SLOT_SIZE;
+  page.move(slot_offset + SLOT_SIZE, slot_offset, (record_count - idx) * SLOT_SIZE);
+  auto head = record.get_head(get_prefix_size());
+  uint16_t location[2] = {static_cast<uint16_t>(record_begin), static_cast<uint16_t>(record.size)};
+  page.write(slot_offset, sizeof(head), reinterpret_cast<char*>(&head));
+  page.write(slot_offset + sizeof(head), sizeof(location), reinterpret_cast<char*>(location));
+  set_record_count(record_count + 1);
+
+  // records inserted in the middle keep the common prefix of the first and last records
+  if (idx == 0 || idx == record_count) {
+    update_prefix_size();
+  }
+}
+
+int32_t BPlusTreeDir::get_prefix_size() const {
+  return page.read_int32(OFFSET_PREFIX_SIZE);
+}
+
+void BPlusTreeDir::update_prefix_size() {
+  const auto record_count = get_record_count();
+  int32_t prefix_size = get_record(0).common_prefix_size(get_record(record_count - 1));
+  if (prefix_size == get_prefix_size()) {
+    return;
+  }
+  page.write_int32(OFFSET_PREFIX_SIZE, prefix_size);
+  for (int32_t i = 0; i < record_count; i++) {
+    auto head = get_record(i).get_head(prefix_size);
+    page.write(OFFSET_SLOTS + i * SLOT_SIZE, sizeof(head), reinterpret_cast<char*>(&head));
+  }
+}
+
+int32_t BPlusTreeDir::search_child_idx(const BPlusTreeRecord& record) const {
+  // number of records lower or equal than `record`
+  const auto record_count = get_record_count();
+  if (record_count == 0) {
+    return 0;
+  }
+
+  // compare the prefix once, then the heads after it
+  auto prefix_size = get_prefix_size();
+  auto prefix = get_record(0).bytes;
+  auto prefix_cmp = std::memcmp(record.bytes, prefix, std::min<size_t>(record.size, prefix_size));
+  if (prefix_cmp < 0 || (prefix_cmp == 0 && static_cast<int32_t>(record.size) < prefix_size)) {
+    return 0;
+  } else if (prefix_cmp > 0) {
+    return record_count;
+  }
+
+  // only the records with the same head than `record` have to be compared
+  auto slots = page.get_bytes() + OFFSET_SLOTS;
+  auto head = record.get_head(prefix_size);
+  int32_t from = BPlusTreeSlotSearch::lower_bound(slots, 0, record_count, head, false);
+  int32_t to = BPlusTreeSlotSearch::lower_bound(slots, from, record_count, head, true);
+
+  while (from < to) {
+    auto mid = (from + to) / 2;
+    if (record < get_record(mid)) {
+      to = mid;
     } else {
-      from = middle_idx + 1;
+      from = mid + 1;
     }
   }
-
   return from;
 }
 
-void BPlusTreeDir::delete_record(const BPlusTreeRecord& record) {
-  // TODO: Bonus
+bool BPlusTreeDir::merge_right(BPlusTreeDir& right, const BPlusTreeRecord& separator, size_t max_size) {
+  auto size = get_used_size() - get_high_key().size + RECORD_OVERHEAD + separator.size
+            + right.get_used_size() - OFFSET_SLOTS;
+  if (size > max_size) {
+    return false;
+  }
+
+  char old_bytes[Page::SIZE];
+  std::memcpy(old_bytes, page.get_bytes(), Page::SIZE);
+  const auto record_count = get_record_count();
+  const auto right_count = right.get_record_count();
+
+  // the first child of `right` goes at the right of the separator
+  clear(get_child(0), get_level());
+  for (int32_t i = 0; i < record_count; i++) {
+    insert_at(i, read_record(old_bytes, i), read_right_child(old_bytes, i));
+  }
+  insert_at(record_count, separator, right.get_child(0));
+  for (int32_t i = 0; i < right_count; i++) {
+    insert_at(record_count + 1 + i, right.get_record(i), right.get_child(i + 1));
+  }
+  if (right.get_right_sibling() != 0) {
+    set_right_sibling(right.get_right_sibling(), right.get_high_key());
+  }
+
+  right.page.write_int32(OFFSET_REMOVED, 1);
+  right.page.write_int32(OFFSET_RIGHT_SIBLING, page.get_page_number());
+  return true;
 }
 
-std::unique_ptr<BPlusTreeSplit> BPlusTreeDir::insert_record(const BPlusTreeRecord& record) {
-  auto child_count = get_child_count();
-  assert(child_count >= 1);
-  auto record_count = child_count - 1;
+void BPlusTreeDir::remove_at(int32_t idx) {
+  // the dir is rebuilt without the record, so its bytes can be reused
+  char old_bytes[Page::SIZE];
+  std::memcpy(old_bytes, page.get_bytes(), Page::SIZE);
+  const auto record_count = get_record_count();
+  const auto right_sibling = get_right_sibling();
 
-  auto dir_index = record_count > 0 ? search_child_idx(record) : 0;
-  auto page_pointer = get_child(dir_index);
+  clear(get_child(0), get_level());
+  for (int32_t i = 0; i < record_count; i++) {
+    if (i != idx) {
+      insert_at(i < idx ? i : i - 1, read_record(old_bytes, i), read_right_child(old_bytes, i));
+    }
+  }
+  if (right_sibling != 0) {
+    set_right_sibling(right_sibling, read_high_key(old_bytes));
+  }
+}
 
-  std::unique_ptr<BPlusTreeSplit> split = nullptr;
+std::unique_ptr<BPlusTreeSplit> BPlusTreeDir::insert_separator(const BPlusTreeSplit& child_split) {
+  auto child_idx = search_child_idx(child_split.record);
 
-  if (page_pointer < 0) {
-    // negative number: pointer to dir
-    BPlusTreeDir child(bpt, -1 * page_pointer);
-    split = child.insert_record(record);
-  } else {
-    // positive number: pointer to leaf
-    BPlusTreeLeaf child(bpt, page_pointer);
-    split = child.insert_record(record);
+  // Case 1: no need to split this node, the new child goes at the right of child_idx
+  if (static_cast<int32_t>(RECORD_OVERHEAD + child_split.record.size) <= get_free_space()) {
+    insert_at(child_idx, child_split.record, child_split.encoded_page_number);
+    return nullptr;
   }
 
-  if (split != nullptr) {
-    auto split_child_idx = search_child_idx(split->record);
+  // The records (including the new one) are distributed in two dirs, and the record between them goes to
+  // the parent and becomes the high key of the left dir
+  char old_bytes[Page::SIZE];
+  std::memcpy(old_bytes, page.get_bytes(), Page::SIZE);
+  const auto record_count = get_record_count();
+  const auto first_child = get_child(0);
+  const auto level = get_level();
+  const auto right_sibling = get_right_sibling();
+  const auto high_key = read_high_key(old_bytes);
+
+  auto entry_record = [&](int32_t i) {
+    if (i < child_idx) {
+      return read_record(old_bytes, i);
+    } else if (i == child_idx) {
+      return child_split.record;
+    } else {
+      return read_record(old_bytes, i - 1);
+    }
+  };
+  auto entry_child = [&](int32_t i) {
+    if (i < child_idx) {
+      return read_right_child(old_bytes, i);
+    } else if (i == child_idx) {
+      return child_split.encoded_page_number;
+    } else {
+      return read_right_child(old_bytes, i - 1);
+    }
+  };
+  const int32_t total_count = record_count + 1;
 
-    // Case 1: no need to split this node
-    if (record_count < max_records) {
-      // shift right records and children
-      for (int i = record_count; i >= split_child_idx; i--) {
-        set_record(i, get_record(i - 1));
-        set_child(i + 1, get_child(i));
-      }
+  // records [0, middle) go to the left dir, records (middle, total_count) to the right one. The middle
+  // leaving the fullest dir with less bytes is chosen
+  std::vector<size_t> acc_size(total_count + 1);
+  for (int32_t i = 0; i < total_count; i++) {
+    acc_size[i + 1] = acc_size[i] + RECORD_OVERHEAD + entry_record(i).size;
+  }
+  int32_t middle = 0;
+  size_t best_size = SIZE_MAX;
+  for (int32_t i = 0; i < total_count; i++) {
+    auto size = OFFSET_SLOTS + std::max(
+        acc_size[i] + entry_record(i).size,
+        acc_size[total_count] - acc_size[i + 1] + high_key.size
+    );
+    if (size < best_size) {
+      best_size = size;
+      middle = i;
+    }
+  }
+  assert(best_size <= Page::SIZE);
+  auto separator = entry_record(middle);
 
-      set_record(split_child_idx, split->record);
-      set_child(split_child_idx + 1, split->encoded_page_number);
-      set_child_count(child_count + 1);
+  auto fill_left = [&](BPlusTreeDir& lhs, const BPlusTreeDir& rhs) {
+    lhs.clear(first_child, level);
+    for (int32_t i = 0; i < middle; i++) {
+      lhs.insert_at(i, entry_record(i), entry_child(i));
     }
-    // Case 2: we need to split this node and this node is not the root
-    else if (page.get_page_number() != 0) {
-      // TODO: Problema 3
+    lhs.set_right_sibling(rhs.page.get_page_number(), separator);
+  };
+  auto fill_right = [&](BPlusTreeDir& rhs) {
+    rhs.clear(entry_child(middle), level);
+    for (int32_t i = middle + 1; i < total_count; i++) {
+      rhs.insert_at(i - middle - 1, entry_record(i), entry_child(i));
     }
-    // Case 3: root split
-    else {
-      auto last_record = get_record(max_records - 1);
-      auto last_child = get_child(max_children - 1);
-
-      if (split_child_idx == max_children - 1) {
-        last_record = split->record;
-        last_child = split->encoded_page_number;
-      } else {
-        // shift and insert
-        for (int i = max_records - 1; i > split_child_idx; i--) {
-          set_record(i, get_record(i - 1));
-          set_child(i + 1, get_child(i));
-        }
-        set_record(split_child_idx, split->record);
-        set_child(split_child_idx + 1, split->encoded_page_number);
-      }
-      constexpr auto middle_index = (max_records + 1) / 2;
-
-      BPlusTreeDir new_lhs_dir(bpt);
-      BPlusTreeDir new_rhs_dir(bpt);
-
-      // write left records from 0 to (middle_index-1)
-      // write left children from 0 to middle_index
-      for (int i = 0; i < middle_index; i++) {
-        new_lhs_dir.set_child(i, this->get_child(i));
-        new_lhs_dir.set_record(i, this->get_record(i));
-      }
-      auto split_record = get_record(middle_index);
-      new_lhs_dir.set_child(middle_index, this->get_child(middle_index));
-
-      // write right records from (middle_index+1) to the end and the last record saved before
-      // write right children from (middle_index+1) to the end and the last child saved before
-      int j = 0;
-      for (int i = middle_index + 1; i < max_records; i++, j++) {
-        new_rhs_dir.set_child(j, this->get_child(i));
-        new_rhs_dir.set_record(j, this->get_record(i));
-      }
-      new_rhs_dir.set_child(j, this->get_child(max_children - 1));
-      new_rhs_dir.set_child(j + 1, last_child);
-      new_rhs_dir.set_record(j, last_record);
-
-      // update counts
-      new_lhs_dir.set_child_count(middle_index + 1);
-      new_rhs_dir.set_child_count((max_children + 1) - (middle_index + 1));
-
-      this->set_child_count(2);
-      this->set_child(0, new_lhs_dir.page.get_page_number() * -1);
-      this->set_child(1, new_rhs_dir.page.get_page_number() * -1);
-      this->set_record(0, split_record);
+    if (right_sibling != 0) {
+      rhs.set_right_sibling(right_sibling, high_key);
     }
+  };
+
+  // Case 2: we need to split this node and this node is not the root. The new dir is written before
+  // this one points to it
+  if (page.get_page_number() != 0) {
+    BPlusTreeDir new_dir(bpt);
+    fill_right(new_dir);
+    fill_left(*this, new_dir);
+    return std::make_unique<BPlusTreeSplit>(separator, -1 * new_dir.page.get_page_number());
   }
 
+  // Case 3: root split, the root stays at page 0 one level higher, with the two new dirs as children
+  BPlusTreeDir new_lhs_dir(bpt);
+  BPlusTreeDir new_rhs_dir(bpt);
+  fill_right(new_rhs_dir);
+  fill_left(new_lhs_dir, new_rhs_dir);
+
+  clear(-1 * new_lhs_dir.page.get_page_number(), level + 1);
+  insert_at(0, separator, -1 * new_rhs_dir.page.get_page_number());
   return nullptr;
 }
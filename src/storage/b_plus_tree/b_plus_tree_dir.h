@@ -2,47 +2,87 @@
 
 #include <memory>
 
+#include "storage/b_plus_tree/b_plus_tree_slot_search.h"
 #include "storage/b_plus_tree/b_plus_tree_utils.h"
 #include "storage/page.h"
 
 class BPlusTree;
 
 /*
-  Page layup:
-  - First we have the child count (cc)
-  - Then we have (cc) children, cc >= 1
-  - Then we may have an empty space (unless cc == max_children)
-  - Then we have (cc-1) records
+  Page layout:
+  - First we have the record count (rc), the node has (rc + 1) children
+  - Then we have the first child
+  - Then we have the offset where the record data begins (db)
+  - Then we have the right sibling, the next dir of the same level (0 if there is none)
+  - Then we have the level of the dir: 1 if the children are leaves, 2 if they are dirs of level 1, etc.
+  - Then we have the offset and the size of the high key (int32), inside the record data
+  - Then we have the size of the prefix (ps) shared by all the records, the common prefix of the first and
+    the last record
+  - Then we have 1 if the dir was removed from the tree by a merge, 0 otherwise
+  - Then we have the first free page of the dir file (only used in the root, see BPlusTree)
+  - Then we have (rc) slots, sorted by record. Each slot has the head of the record after the first (ps)
+    bytes (uint32, see BPlusTreeSlotSearch), and the offset and the size of the record (uint16)
+  - Then we have the free space
+  - Then we have the record data, from (db) to the end of the page. Each record is preceded by the child
+    at its right (int32). Records are BPlusTreeRecords separating children: every record in child i is
+    lower than record i, and records in child i + 1 are greater or equal.
+  Children are encoded as negative numbers if they are dirs and positive (or 0) if they are leaves.
+
+  Dirs of the same level are linked as a B-link tree: every record of a dir is lower than its high key,
+  and greater records are in its right sibling (or further right). A split moves the greater records to
+  a new right sibling before the separator is inserted in the parent, so a search reaching a dir that
+  was split meanwhile moves right instead of descending (see BPlusTree::find_node).
+  The root (page 0) has no right sibling and no high key.
+
+  As leaves (see BPlusTreeLeaf), a dir left with few records is merged with a sibling: the separator
+  between them (from the parent) and the records of the right dir move to the left dir, and the right dir
+  is removed, keeping the left dir as its right sibling.
  */
 class BPlusTreeDir {
   friend class BPlusTree;
+  friend class BPlusTreeBuilder;
+  friend class BPlusTreeDirCache;
 
 public:
-  using record_t = BPlusTreeRecord;
+  using record_count_t = int32_t;
   using child_t = int32_t;
-  using child_count_t = int32_t;
+  using data_begin_t = int32_t;
+  using right_sibling_t = int32_t;
+  using level_t = int32_t;
+  using high_key_t = int32_t;
+  using prefix_size_t = int32_t;
+  using removed_t = int32_t;
+  using first_free_t = int32_t;
 
-  static constexpr int32_t max_records =
-      (Page::SIZE - sizeof(child_count_t) - sizeof(child_t)) / (sizeof(child_t) + sizeof(record_t));
+  static constexpr auto OFFSET_RECORD_COUNT = 0;
 
-  static constexpr int32_t max_children = max_records + 1;
+  static constexpr auto OFFSET_FIRST_CHILD = sizeof(record_count_t);
 
-  static constexpr auto max_space_used =
-      sizeof(child_count_t) + max_records * sizeof(record_t) + max_children * sizeof(child_t);
+  static constexpr auto OFFSET_DATA_BEGIN = OFFSET_FIRST_CHILD + sizeof(child_t);
 
-  static constexpr auto OFFSET_CHILD_COUNT = 0;
+  static constexpr auto OFFSET_RIGHT_SIBLING = OFFSET_DATA_BEGIN + sizeof(data_begin_t);
 
-  static constexpr auto OFFSET_CHILDREN = sizeof(child_t);
+  static constexpr auto OFFSET_LEVEL = OFFSET_RIGHT_SIBLING + sizeof(right_sibling_t);
 
-  static constexpr auto OFFSET_RECORD = OFFSET_CHILDREN + (max_children) * sizeof(child_t);
+  static constexpr auto OFFSET_HIGH_KEY = OFFSET_LEVEL + sizeof(level_t);
 
-  static_assert(max_space_used <= Page::SIZE);
+  static constexpr auto OFFSET_PREFIX_SIZE = OFFSET_HIGH_KEY + 2 * sizeof(high_key_t);
 
-  static_assert(OFFSET_CHILD_COUNT % alignof(child_count_t) == 0, "child count should be aligned");
+  static constexpr auto OFFSET_REMOVED = OFFSET_PREFIX_SIZE + sizeof(prefix_size_t);
 
-  static_assert(OFFSET_CHILDREN % alignof(child_t) == 0, "children should be aligned");
+  static constexpr auto OFFSET_FIRST_FREE = OFFSET_REMOVED + sizeof(removed_t);
 
-  static_assert(OFFSET_RECORD % alignof(record_t) == 0, "records should be aligned");
+  static constexpr auto OFFSET_SLOTS = OFFSET_FIRST_FREE + sizeof(first_free_t);
+
+  static constexpr auto SLOT_SIZE = sizeof(uint32_t) + 2 * sizeof(uint16_t);
+
+  static_assert(SLOT_SIZE == BPlusTreeSlotSearch::SLOT_SIZE);
+
+  // bytes used by each record besides its own bytes: its slot and the child at its right
+  static constexpr auto RECORD_OVERHEAD = SLOT_SIZE + sizeof(child_t);
+
+  // a full dir plus a new record can always be split in two non-empty dirs that fit with their high keys
+  static_assert(OFFSET_SLOTS + 4 * (RECORD_OVERHEAD + BPlusTreeRecord::MAX_SIZE) <= Page::SIZE);
 
   BPlusTreeDir(const BPlusTree& bpt, int32_t page_number);
 
@@ -51,31 +91,74 @@ public:
 
   ~BPlusTreeDir();
 
-  std::unique_ptr<BPlusTreeSplit> insert_record(const BPlusTreeRecord& record);
+  // inserts the separator of a split child. Returns nullptr if this dir was not split.
+  // The caller must have the exclusive latch and this dir must be the one where the separator goes
+  // (not greater or equal than the high key)
+  std::unique_ptr<BPlusTreeSplit> insert_separator(const BPlusTreeSplit& child_split);
 
-  void delete_record(const BPlusTreeRecord& record);
+  // moves `separator`, the record of the parent between this dir and `right` (its right sibling), and the
+  // records of `right` into this dir and removes `right`, if they fit in `max_size` bytes. Returns false
+  // if they don't fit. The caller must have the exclusive latch of both dirs and of their parent
+  bool merge_right(BPlusTreeDir& right, const BPlusTreeRecord& separator, size_t max_size);
 
-  // returns the leaf page number
-  BPlusTreeSearchResult search_leaf(const BPlusTreeRecord& record);
+  // removes the record `idx` and the child at its right, after that child was merged into the child at its
+  // left. The caller must have the exclusive latch
+  void remove_at(int32_t idx);
 
 private:
-  int32_t search_child_idx(const BPlusTreeRecord& record);
-
   const BPlusTree& bpt;
 
   Page& page;
 
-  int32_t get_child_count() const;
+  // leaves the dir empty, as the root of a new B+tree having the leaf 0 as its only child
+  void init();
+
+  // returns the index of the child where the record should be
+  int32_t search_child_idx(const BPlusTreeRecord& record) const;
+
+  // returns true if the record is not in this dir, but in its right sibling (or further right)
+  bool goes_right(const BPlusTreeRecord& record) const;
+
+  int32_t get_record_count() const;
+
+  // valid index goes from [0, get_record_count()]
+  int32_t get_child(int32_t index) const;
+
+  // valid index goes from [0, get_record_count() - 1]
+  BPlusTreeRecord get_record(int32_t index) const;
+
+  int32_t get_level() const;
+
+  // true if the dir was merged into the dir that is now its right sibling (see merge_right)
+  bool is_removed() const;
+
+  // bytes used by the header, slots, records, children and high key
+  size_t get_used_size() const;
+
+  int32_t get_right_sibling() const;
+
+  // returns an empty record if there is no right sibling
+  BPlusTreeRecord get_high_key() const;
+
+  int32_t get_data_begin() const;
+
+  int32_t get_free_space() const;
+
+  // leaves the dir with a single child and no right sibling
+  void clear(int32_t first_child, int32_t level);
+
+  // inserts record at position idx, with `right_child` as the child at its right, shifting the next
+  // slots. There must be enough free space
+  void insert_at(int32_t idx, const BPlusTreeRecord& record, int32_t right_child);
 
-  // valid index goes from [0, get_key_count() - 1]
-  int32_t get_child(size_t index) const;
+  void set_right_sibling(int32_t right_sibling, const BPlusTreeRecord& high_key);
 
-  // valid index goes from [0, get_child_count() - 2]
-  BPlusTreeRecord get_record(size_t index) const;
+  int32_t get_prefix_size() const;
 
-  void set_child_count(int32_t child_count);
+  // sets the prefix size after the first or the last record changed, updating the heads if it changed
+  void update_prefix_size();
 
-  void set_child(size_t index, int32_t child);
+  void set_record_count(int32_t record_count);
 
-  void set_record(size_t index, const BPlusTreeRecord& record);
+  void set_data_begin(int32_t data_begin);
 };
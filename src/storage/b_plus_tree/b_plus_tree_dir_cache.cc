@@ -0,0 +1,152 @@
+#include "b_plus_tree_dir_cache.h"
+
+#include <algorithm>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/b_plus_tree/b_plus_tree_dir.h"
+
+static constexpr int32_t SLOTS_PER_LINE = 64 / BPlusTreeSlotSearch::SLOT_SIZE;
+
+BPlusTreeDirCache::BPlusTreeDirCache(const BPlusTree& bpt)
+    : key_offsets({0}) {
+  add_node(bpt, 0, -1);
+  top_level = nodes[0].level;
+  min_level = top_level;
+
+  // each level is read from its leftmost dir following the right siblings, so it also has the dirs that
+  // are not in their parent yet
+  auto lowest_level = std::max(1, top_level - MAX_LEVELS + 1);
+  int32_t level_begin = 0;
+  while (min_level > lowest_level) {
+    const auto level = min_level - 1;
+    const auto level_end = static_cast<int32_t>(nodes.size());
+    auto page_number = -1 * nodes[level_begin].first_child;
+    bool complete = true;
+    while (page_number != 0 && complete) {
+      complete = nodes.size() < MAX_DIRS && add_node(bpt, page_number, level);
+      page_number = complete ? nodes.back().right_sibling : 0;
+    }
+    if (!complete) {
+      // a dir was merged meanwhile or there are too many, the level is left out
+      nodes.resize(level_end);
+      break;
+    }
+    level_begin = level_end;
+    min_level = level;
+  }
+
+  std::unordered_map<int32_t, int32_t> node_of_page;
+  for (int32_t i = 0; i < static_cast<int32_t>(nodes.size()); i++) {
+    node_of_page[nodes[i].page_number] = i;
+  }
+  auto get_node = [&](int32_t page_number) {
+    auto it = node_of_page.find(page_number);
+    return it == node_of_page.end() ? -1 : it->second;
+  };
+  child_nodes.assign(slot_lines.size() * SLOTS_PER_LINE, -1);
+  for (auto& node : nodes) {
+    node.right_sibling_node = node.right_sibling == 0 ? -1 : get_node(node.right_sibling);
+    if (node.level == min_level) {
+      node.first_child_node = -1;
+      continue;
+    }
+    node.first_child_node = get_node(-1 * node.first_child);
+    for (int32_t i = 0; i < node.record_count; i++) {
+      child_nodes[node.first_slot + i] = get_node(-1 * get_slot(node, i).child);
+    }
+  }
+}
+
+bool BPlusTreeDirCache::add_node(const BPlusTree& bpt, int32_t page_number, int32_t level) {
+  BPlusTreeDir dir(bpt, page_number);
+  std::shared_lock<std::shared_mutex> lck(dir.page.latch);
+  if (dir.is_removed() || (level >= 0 && dir.get_level() != level)) {
+    return false;
+  }
+
+  Node node;
+  node.page_number = page_number;
+  node.level = dir.get_level();
+  node.record_count = dir.get_record_count();
+  node.prefix_size = dir.get_prefix_size();
+  node.first_child = dir.get_child(0);
+  node.right_sibling = dir.get_right_sibling();
+  node.first_slot = static_cast<int32_t>(slot_lines.size()) * SLOTS_PER_LINE;
+  node.first_key = static_cast<int32_t>(key_offsets.size()) - 1;
+
+  slot_lines.resize(slot_lines.size() + (node.record_count + SLOTS_PER_LINE - 1) / SLOTS_PER_LINE);
+  auto slots = reinterpret_cast<Slot*>(slot_lines.data()) + node.first_slot;
+  auto add_key = [&](const BPlusTreeRecord& key) {
+    key_bytes.insert(key_bytes.end(), key.bytes, key.bytes + key.size);
+    key_offsets.push_back(static_cast<uint32_t>(key_bytes.size()));
+  };
+  for (int32_t i = 0; i < node.record_count; i++) {
+    auto record = dir.get_record(i);
+    slots[i].head = record.get_head(node.prefix_size);
+    slots[i].child = dir.get_child(i + 1);
+    add_key(record);
+  }
+  add_key(dir.get_high_key());
+  nodes.push_back(node);
+  return true;
+}
+
+int32_t BPlusTreeDirCache::search_child_idx(const Node& node, const BPlusTreeRecord& record) const {
+  // number of records lower or equal than `record`
+  if (node.record_count == 0) {
+    return 0;
+  }
+
+  auto prefix = get_key(node.first_key).bytes;
+  auto prefix_cmp = std::memcmp(record.bytes, prefix, std::min<size_t>(record.size, node.prefix_size));
+  if (prefix_cmp < 0 || (prefix_cmp == 0 && static_cast<int32_t>(record.size) < node.prefix_size)) {
+    return 0;
+  } else if (prefix_cmp > 0) {
+    return node.record_count;
+  }
+
+  auto slots = reinterpret_cast<const char*>(&get_slot(node, 0));
+  auto head = record.get_head(node.prefix_size);
+  int32_t from = BPlusTreeSlotSearch::lower_bound(slots, 0, node.record_count, head, false);
+  int32_t to = BPlusTreeSlotSearch::lower_bound(slots, from, node.record_count, head, true);
+
+  while (from < to) {
+    auto mid = (from + to) / 2;
+    if (record < get_key(node.first_key + mid)) {
+      to = mid;
+    } else {
+      from = mid + 1;
+    }
+  }
+  return from;
+}
+
+int32_t BPlusTreeDirCache::find(const BPlusTreeRecord& record, int32_t level, int32_t* node_level) const {
+  int32_t node_idx = 0;
+  while (true) {
+    auto& node = nodes[node_idx];
+    *node_level = node.level;
+
+    if (node.right_sibling != 0 && !(record < get_key(node.first_key + node.record_count))) {
+      if (node.right_sibling_node < 0) {
+        return node.right_sibling;
+      }
+      node_idx = node.right_sibling_node;
+      continue;
+    }
+    if (node.level == level) {
+      return node.page_number;
+    }
+
+    auto child_idx = search_child_idx(node, record);
+    auto child = child_idx == 0 ? node.first_child : get_slot(node, child_idx - 1).child;
+    auto child_node = child_idx == 0 ? node.first_child_node : child_nodes[node.first_slot + child_idx - 1];
+    if (child_node < 0) {
+      *node_level = node.level - 1;
+      return node.level == 1 ? child : -1 * child; // leaves are positive, dirs negative
+    }
+    node_idx = child_node;
+  }
+}
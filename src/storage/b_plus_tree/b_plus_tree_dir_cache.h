@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "storage/b_plus_tree/b_plus_tree_slot_search.h"
+#include "storage/b_plus_tree/b_plus_tree_utils.h"
+
+class BPlusTree;
+
+/*
+  Read-only copy of the upper levels of a BPlusTree, so descents read those dirs from memory instead of
+  pinning their pages. It has the top MAX_LEVELS levels (the root and the levels below it, but not the
+  leaves), or fewer if they would have more than MAX_DIRS dirs.
+
+  The separators of each dir are stored as in the dir page (see BPlusTreeDir): a slot array with the head
+  of each separator, searched with BPlusTreeSlotSearch, and the separators themselves, compared only when
+  their head is the same than the one of the key. The slots of each dir begin at a cache line.
+
+  The copy is not updated when the B+tree changes, but it is still valid after splits: a dir that was split
+  after the copy was read only lost its greater separators, so a descent reaching it through the copy moves
+  right (see BPlusTree::find_node). It must be discarded before reusing the pages of merged nodes that it
+  may point to.
+ */
+class BPlusTreeDirCache {
+public:
+  static constexpr int32_t MAX_LEVELS = 3;
+
+  static constexpr size_t MAX_DIRS = 1024;
+
+  // the copy is read again when more than 1/STALE_FRACTION of its separators were inserted after reading it
+  static constexpr int64_t STALE_FRACTION = 8;
+
+  // reads the upper levels of the B+tree, latching (shared) one dir at a time
+  BPlusTreeDirCache(const BPlusTree& bpt);
+
+  // prevent accidental copies
+  BPlusTreeDirCache(const BPlusTreeDirCache& other) = delete;
+
+  // level of the root when the copy was read
+  int32_t get_top_level() const {
+    return top_level;
+  }
+
+  // level of the lowest dirs of the copy
+  int32_t get_min_level() const {
+    return min_level;
+  }
+
+  int64_t get_separator_count() const {
+    return static_cast<int64_t>(key_offsets.size() - 1 - nodes.size());
+  }
+
+  // descends the copy towards the record down to the node at `level` (the leaf if it is 0), that must be
+  // lower than get_top_level(). Returns the page number of that node, or of the dir where the descent left
+  // the copy (a dir below the copy or a right sibling not in the copy), writing its level into node_level
+  int32_t find(const BPlusTreeRecord& record, int32_t level, int32_t* node_level) const;
+
+private:
+  // same layout than the slots of a dir page, the child is the one at the right of the separator
+  struct Slot {
+    uint32_t head;
+
+    int32_t child;
+  };
+
+  static_assert(sizeof(Slot) == BPlusTreeSlotSearch::SLOT_SIZE);
+
+  struct alignas(64) SlotLine {
+    Slot slots[64 / sizeof(Slot)];
+  };
+
+  struct Node {
+    int32_t page_number;
+
+    int32_t level;
+
+    int32_t record_count;
+
+    int32_t prefix_size;
+
+    // children are encoded as in dirs (negative for dirs, positive for leaves)
+    int32_t first_child;
+
+    int32_t right_sibling;
+
+    // index of the nodes of the first child and right sibling, -1 if they are not in the copy
+    int32_t first_child_node;
+
+    int32_t right_sibling_node;
+
+    // index of the first slot in `slot_lines`, a multiple of the slots per line
+    int32_t first_slot;
+
+    // index of the offset of the first separator in `key_offsets`, the separators are followed by the high
+    // key
+    int32_t first_key;
+  };
+
+  int32_t top_level;
+
+  int32_t min_level;
+
+  // nodes of each level from left to right, the root first
+  std::vector<Node> nodes;
+
+  std::vector<SlotLine> slot_lines;
+
+  // index of the node of the child of each slot, -1 if it is not in the copy
+  std::vector<int32_t> child_nodes;
+
+  std::vector<char> key_bytes;
+
+  // the key `i` is [key_offsets[i], key_offsets[i + 1]) in key_bytes
+  std::vector<uint32_t> key_offsets;
+
+  // copies the dir, returns false if it was removed or it is not at `level`
+  bool add_node(const BPlusTree& bpt, int32_t page_number, int32_t level);
+
+  const Slot& get_slot(const Node& node, int32_t idx) const {
+    return reinterpret_cast<const Slot*>(slot_lines.data())[node.first_slot + idx];
+  }
+
+  BPlusTreeRecord get_key(int32_t key_idx) const {
+    auto offset = key_offsets[key_idx];
+    return BPlusTreeRecord(key_bytes.data() + offset, key_offsets[key_idx + 1] - offset);
+  }
+
+  // same as BPlusTreeDir::search_child_idx
+  int32_t search_child_idx(const Node& node, const BPlusTreeRecord& record) const;
+};
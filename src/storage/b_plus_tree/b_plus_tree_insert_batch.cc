@@ -0,0 +1,30 @@
+#include "b_plus_tree_insert_batch.h"
+
+#include "storage/b_plus_tree/b_plus_tree.h"
+
+BPlusTreeInsertBatch::BPlusTreeInsertBatch(BPlusTree& bpt)
+    : bpt(bpt),
+      offsets({0}) {}
+
+void BPlusTreeInsertBatch::add(const Record& record, RID rid) {
+  char entry[BPlusTreeRecord::MAX_SIZE];
+  auto entry_size = bpt.encode_entry(record, rid, entry);
+  bytes.insert(bytes.end(), entry, entry + entry_size);
+  offsets.push_back(bytes.size());
+
+  if (bytes.size() > MAX_BYTES) {
+    flush();
+  }
+}
+
+void BPlusTreeInsertBatch::flush() {
+  std::vector<BPlusTreeRecord> entries;
+  entries.reserve(offsets.size() - 1);
+  for (size_t i = 0; i + 1 < offsets.size(); i++) {
+    entries.emplace_back(bytes.data() + offsets[i], offsets[i + 1] - offsets[i]);
+  }
+  bpt.insert_entries(entries);
+
+  bytes.clear();
+  offsets.resize(1);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "relational_model/record.h"
+#include "storage/heap_file/rid.h"
+
+class BPlusTree;
+
+// Entries of many records to insert into a B+tree together (see BPlusTree::insert_entries). The entries
+// are encoded from the records when they are added, so the records do not need to be kept.
+class BPlusTreeInsertBatch {
+public:
+  // the entries are inserted when they take more than this, bounding the memory used
+  static constexpr size_t MAX_BYTES = 4 * 1024 * 1024;
+
+  BPlusTreeInsertBatch(BPlusTree& bpt);
+
+  // prevent accidental copies
+  BPlusTreeInsertBatch(const BPlusTreeInsertBatch& other) = delete;
+
+  void add(const Record& record, RID rid);
+
+  // inserts the entries added since the last flush
+  void flush();
+
+  BPlusTree& bpt;
+
+private:
+  // the entries one after the other, the entry i is in [offsets[i], offsets[i + 1])
+  std::vector<char> bytes;
+
+  std::vector<size_t> offsets;
+};
@@ -1,19 +1,50 @@
 #include "b_plus_tree_iter.h"
 
+#include <shared_mutex>
+
+#include "storage/heap_file/heap_file.h"
+
+// writes the value encoded at `in` into out, returns the size of the encoding
+static size_t decode_value(DataType datatype, const char* in, Value& out) {
+  switch (datatype) {
+  case DataType::INT: {
+    out.value.as_int = KeyEncoding::decode_int(in);
+    return KeyEncoding::INT_SIZE;
+  }
+  case DataType::STR: {
+    auto str = KeyEncoding::decode_str(in);
+    out.set_str(str.data(), str.size());
+    return str.size() + 1;
+  }
+  }
+  return 0; // unreachable
+}
+
+// writes the value encoded at `in` as the next row of the column `col`, returns the size of the encoding
+static size_t decode_value(DataType datatype, const char* in, ColumnBatch& batch, size_t col) {
+  switch (datatype) {
+  case DataType::INT: {
+    batch.columns[col].ints[batch.size] = KeyEncoding::decode_int(in);
+    return KeyEncoding::INT_SIZE;
+  }
+  case DataType::STR: {
+    auto str = KeyEncoding::decode_str(in);
+    batch.set_str(col, batch.size, str.data(), str.size());
+    return str.size() + 1;
+  }
+  }
+  return 0; // unreachable
+}
+
 BPlusTreeIter::BPlusTreeIter(
-    const BPlusTree& bpt,
-    const Value& min,
-    const Value& max,
-    int64_t key_column_idx,
-    BPlusTreeRecord min_record,
-    BPlusTreeRecord max_record
+    const BPlusTree& bpt, const std::vector<Value>& min, const std::vector<Value>& max, bool index_only
 )
     : bpt(bpt),
-      min(min),
-      max(max),
-      key_column_idx(key_column_idx),
-      min_record(min_record),
-      max_record(max_record) {}
+      guard(bpt),
+      index_only(index_only),
+      min_key_size(KeyEncoding::encode(min, min_key)),
+      max_key_size(KeyEncoding::encode(max, max_key)),
+      entry(entry_bytes, 0) {}
 
 void BPlusTreeIter::begin(Record& _out) {
   out = &_out;
@@ -21,36 +52,122 @@ void BPlusTreeIter::begin(Record& _out) {
 }
 
 void BPlusTreeIter::reset() {
-  auto search_leaf_res = bpt.root->search_leaf(min_record);
-  current_leaf = std::make_unique<BPlusTreeLeaf>(bpt, search_leaf_res.leaf_page_number);
-  current_leaf_pos = search_leaf_res.pos;
+  // the key alone goes before every entry having that key
+  auto leaf_page_number = bpt.find_node(BPlusTreeRecord(min_key, min_key_size), 0);
+  current_leaf = std::make_unique<BPlusTreeLeaf>(bpt, leaf_page_number);
+  valid_pos = false;
+  has_entry = false;
 }
 
-bool BPlusTreeIter::next() {
+bool BPlusTreeIter::advance() {
   while (true) {
-    if (current_leaf_pos < current_leaf->get_record_count()) {
-      auto pos = current_leaf_pos++;
-      auto current_record = current_leaf->get_record(pos);
+    std::shared_lock<std::shared_mutex> lck(current_leaf->page.latch);
+
+    if (current_leaf->is_removed()) {
+      // its entries were moved to the leaf at its left
+      auto left_page_number = current_leaf->get_next_page_number();
+      lck.unlock();
+      current_leaf = std::make_unique<BPlusTreeLeaf>(bpt, left_page_number);
+      valid_pos = false;
+      continue;
+    }
+    if (!valid_pos || current_leaf->get_version() != current_leaf_version) {
+      if (has_entry) {
+        // no entry is between the last one and the last one followed by a zero byte
+        entry_bytes[entry.size] = '\0';
+        current_leaf_pos = current_leaf->search_index(BPlusTreeRecord(entry_bytes, entry.size + 1));
+      } else {
+        current_leaf_pos = current_leaf->search_index(BPlusTreeRecord(min_key, min_key_size));
+      }
+      current_leaf_version = current_leaf->get_version();
+      valid_pos = true;
+    }
 
-      if (max_record < current_record) {
+    if (current_leaf_pos < current_leaf->get_record_count()) {
+      entry = current_leaf->get_record(current_leaf_pos, entry_bytes);
+      entry_key_size = bpt.get_key_size(entry);
+      has_entry = true;
+      if (KeyEncoding::is_after_max(entry.bytes, entry_key_size, max_key, max_key_size)) {
         // in this case we know all next records will be greater than max
         return false;
       }
+      current_leaf_pos++;
+      return true;
+    }
 
-      bpt.heap_file.get_record(current_record.rid, *out);
-      auto value = out->values[key_column_idx];
+    auto next_page_number = current_leaf->get_next_page_number();
+    if (next_page_number == 0) {
+      // there is no next leaf
+      return false;
+    }
+    // every entry of the next leaf is greater than the entries already returned
+    lck.unlock();
+    current_leaf = std::make_unique<BPlusTreeLeaf>(bpt, next_page_number);
+    valid_pos = false;
+  }
+}
 
-      // important to check this as we lose information for strings in key serializing
-      if (value >= min && value <= max) {
-        return true;
-      }
-    } else if (current_leaf->get_next_page_number() != 0) {
-      current_leaf = std::make_unique<BPlusTreeLeaf>(bpt, current_leaf->get_next_page_number());
-      current_leaf_pos = 0;
-    } else {
-        // there is no next leaf
-        return false;
+void BPlusTreeIter::read_entry(Record& out) const {
+  auto& columns = bpt.heap_file.schema.columns;
+  size_t offset = 0;
+  for (auto col : bpt.key_columns) {
+    offset += decode_value(columns[col].datatype, entry.bytes + offset, out.values[col]);
+  }
+  offset += BPlusTreeRecord::RID_SIZE;
+  for (auto col : bpt.include_columns) {
+    offset += decode_value(columns[col].datatype, entry.bytes + offset, out.values[col]);
+  }
+}
+
+void BPlusTreeIter::read_entry(ColumnBatch& batch) const {
+  auto& columns = bpt.heap_file.schema.columns;
+  size_t offset = 0;
+  for (auto col : bpt.key_columns) {
+    offset += decode_value(columns[col].datatype, entry.bytes + offset, batch, col);
+  }
+  offset += BPlusTreeRecord::RID_SIZE;
+  for (auto col : bpt.include_columns) {
+    offset += decode_value(columns[col].datatype, entry.bytes + offset, batch, col);
+  }
+  batch.size++;
+}
+
+bool BPlusTreeIter::next() {
+  if (!advance()) {
+    return false;
+  }
+  if (index_only) {
+    read_entry(*out);
+  } else {
+    bpt.heap_file.get_record(entry.get_rid(entry_key_size), *out);
+  }
+  return true;
+}
+
+bool BPlusTreeIter::next_rid(RID* rid) {
+  if (current_leaf == nullptr) {
+    reset();
+  }
+  if (!advance()) {
+    return false;
+  }
+  *rid = entry.get_rid(entry_key_size);
+  return true;
+}
+
+bool BPlusTreeIter::next_batch(ColumnBatch& batch) {
+  batch.clear();
+  if (current_leaf == nullptr) {
+    reset();
+  }
+
+  if (index_only) {
+    while (!batch.full() && advance()) {
+      read_entry(batch);
     }
+    return batch.size > 0;
   }
-  return false;
+
+  bpt.heap_file.append_records_to_batch([this](RID* rid) { return next_rid(rid); }, batch);
+  return batch.size > 0;
 }
@@ -1,42 +1,80 @@
 #pragma once
 
+#include "relational_model/key_encoding.h"
 #include "relational_model/relation_iter.h"
 #include "storage/b_plus_tree/b_plus_tree.h"
 #include "storage/b_plus_tree/b_plus_tree_leaf.h"
 
+// Returns the records with min <= key <= max. Keys are compared encoded inside the leaves, so only the
+// records that qualify are read from the heap file. When max has fewer values than key columns, only that
+// prefix of the keys is compared against it. If `index_only` is true the heap file is not read
+// and only the key and INCLUDE columns are returned.
+// Inserts may run concurrently: the current leaf is latched (shared) only while reading it, and if it
+// changed since the last read the position is searched again after the last entry returned. Deletes may
+// run concurrently too: if the current leaf was merged into the leaf at its left, the position is searched
+// there.
 class BPlusTreeIter : public RelationIter {
 public:
   BPlusTreeIter(
-      const BPlusTree& bpt,
-      const Value& min,
-      const Value& max,
-      int64_t key_column_idx,
-      BPlusTreeRecord min_record,
-      BPlusTreeRecord max_record
+      const BPlusTree& bpt, const std::vector<Value>& min, const std::vector<Value>& max, bool index_only
   );
 
   virtual void begin(Record& out) override;
 
   virtual bool next() override;
 
+  virtual bool next_batch(ColumnBatch& batch) override;
+
   virtual void reset() override;
 
+  // moves to the next entry and writes its RID, without reading the heap file. Returns false if there are
+  // no more entries. It does not need begin() to be called
+  bool next_rid(RID* rid);
+
 private:
   const BPlusTree& bpt;
 
-  const Value min;
+  // the pinned leaf is not reused while the iterator is alive
+  BPlusTree::OperationGuard guard;
+
+  const bool index_only;
 
-  const Value max;
+  // encoded keys (without RID)
+  char min_key[BPlusTreeRecord::MAX_SIZE];
 
-  const int64_t key_column_idx;
+  char max_key[BPlusTreeRecord::MAX_SIZE];
 
-  const BPlusTreeRecord min_record;
+  size_t min_key_size;
 
-  const BPlusTreeRecord max_record;
+  size_t max_key_size;
 
   std::unique_ptr<BPlusTreeLeaf> current_leaf;
 
   Record* out;
 
-  int64_t current_leaf_pos;
+  int32_t current_leaf_pos;
+
+  // version of the current leaf when current_leaf_pos was computed
+  int32_t current_leaf_version;
+
+  // false when current_leaf_pos has to be searched again
+  bool valid_pos;
+
+  // copy of the last entry returned by advance(), with space for an extra byte used to search after it
+  char entry_bytes[BPlusTreeRecord::MAX_SIZE + 1];
+
+  BPlusTreeRecord entry;
+
+  // false if advance() has not returned an entry since the last reset
+  bool has_entry;
+
+  size_t entry_key_size;
+
+  // moves to the next entry with key <= max, returns false if there is no such entry
+  bool advance();
+
+  // writes the key and INCLUDE columns of the current entry
+  void read_entry(Record& out) const;
+
+  void read_entry(ColumnBatch& batch) const;
 };
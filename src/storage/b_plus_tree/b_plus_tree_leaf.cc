@@ -1,48 +1,224 @@
 #include "b_plus_tree_leaf.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "system/system.h"
 
+// returns the size that a leaf with the sorted `entries` would use (without high key), `acc_size` has the
+// accumulated sizes of slots and records: the entries [from, to) use acc_size[to] - acc_size[from] bytes
+// uncompressed
+static size_t leaf_size(const BPlusTreeRecord* entries, const size_t* acc_size, int32_t from, int32_t to) {
+  auto prefix_size = entries[from].common_prefix_size(entries[to - 1]);
+  auto suffixes_size = acc_size[to] - acc_size[from] - (to - from) * prefix_size;
+  return BPlusTreeLeaf::OFFSET_SLOTS + prefix_size + suffixes_size;
+}
+
 BPlusTreeLeaf::BPlusTreeLeaf(const BPlusTree& bpt, int32_t page_number)
     : bpt(bpt),
       page(buffer_mgr.get_page(bpt.leaf_file_id, page_number)) {}
 
 BPlusTreeLeaf::BPlusTreeLeaf(const BPlusTree& bpt)
     : bpt(bpt),
-      page(buffer_mgr.append_page(bpt.leaf_file_id)) {}
+      page(bpt.allocate_page(bpt.leaf_file_id)) {
+  init();
+}
 
 BPlusTreeLeaf::~BPlusTreeLeaf() {
   page.unpin();
 }
 
+void BPlusTreeLeaf::init() {
+  set_record_count(0);
+  set_next_page_number(0);
+  set_data_begin(Page::SIZE);
+  page.write_int32(OFFSET_PREFIX_SIZE, 0);
+  page.write_int32(OFFSET_HIGH_KEY, Page::SIZE);
+  page.write_int32(OFFSET_HIGH_KEY + sizeof(high_key_t), 0);
+  page.write_int32(OFFSET_REMOVED, 0);
+  page.write_int32(OFFSET_FIRST_FREE, 0);
+}
+
 std::unique_ptr<BPlusTreeSplit> BPlusTreeLeaf::insert_record(const BPlusTreeRecord& record) {
   const auto record_count = get_record_count();
+  const auto prefix = get_prefix();
+  auto index = search_index(record);
 
-  // border case, needs to be handled differently
-  if (record_count == 0) {
-    set_record(0, record);
-    set_record_count(1);
-    return nullptr;
+  if (record.size >= prefix.size && std::memcmp(record.bytes, prefix.bytes, prefix.size) == 0) {
+    BPlusTreeRecord suffix(record.bytes + prefix.size, record.size - prefix.size);
+
+    // avoid inserting duplicated record
+    if (index < record_count && get_suffix(index) == suffix) {
+      return nullptr;
+    }
+
+    if (static_cast<int32_t>(SLOT_SIZE + suffix.size) <= get_free_space()) {
+      insert_at(index, suffix);
+      return nullptr;
+    }
   }
-  auto index = search_index(record);
 
-  // avoid inserting duplicated record
-  if (index < max_records && get_record(index) == record) {
+  // The leaf has to be rebuilt with a shorter prefix or split. Decompress the records, including the new
+  // one, and the high key outside the page
+  auto page_high_key = get_high_key();
+  char high_key_bytes[BPlusTreeRecord::MAX_SIZE];
+  std::memcpy(high_key_bytes, page_high_key.bytes, page_high_key.size);
+  BPlusTreeRecord high_key(high_key_bytes, page_high_key.size);
+
+  const int32_t total_count = record_count + 1;
+  // deleted records leave unused bytes in the data, they are dropped here
+  std::vector<char> bytes(record_count * prefix.size + (Page::SIZE - get_data_begin()) + record.size);
+  std::vector<BPlusTreeRecord> entries;
+  std::vector<size_t> acc_size(total_count + 1);
+  entries.reserve(total_count);
+  size_t bytes_used = 0;
+  for (int32_t i = 0; i < total_count; i++) {
+    if (i == index) {
+      std::memcpy(bytes.data() + bytes_used, record.bytes, record.size);
+      entries.emplace_back(bytes.data() + bytes_used, record.size);
+    } else {
+      auto entry = get_record(i < index ? i : i - 1, bytes.data() + bytes_used);
+      entries.emplace_back(entry.bytes, entry.size);
+    }
+    bytes_used += entries.back().size;
+    acc_size[i + 1] = acc_size[i] + SLOT_SIZE + entries.back().size;
+  }
+
+  if (leaf_size(entries.data(), acc_size.data(), 0, total_count) + high_key.size <= Page::SIZE) {
+    rebuild(entries.data(), total_count, high_key);
     return nullptr;
   }
 
-  if (record_count < max_records) {
-    // TODO: Problema 1
-  } else {
-    // TODO: Problema 2
+  // Split: this leaf keeps the records [0, left_count) and a new leaf at its right gets the rest,
+  // choosing the split point that leaves the fullest leaf with less bytes.
+  // The separator, that is the high key of this leaf, is the shortest prefix of the first record of the
+  // new leaf that is greater than the last record of this leaf
+  auto separator_size = [&](int32_t left_count) {
+    return entries[left_count].common_prefix_size(entries[left_count - 1]) + 1;
+  };
+  int32_t left_count = 0;
+  size_t best_size = SIZE_MAX;
+  for (int32_t i = 1; i < total_count; i++) {
+    auto size = std::max(
+        leaf_size(entries.data(), acc_size.data(), 0, i) + separator_size(i),
+        leaf_size(entries.data(), acc_size.data(), i, total_count) + high_key.size
+    );
+    if (size < best_size) {
+      best_size = size;
+      left_count = i;
+    }
   }
+  assert(best_size <= Page::SIZE);
+
+  BPlusTreeRecord separator(entries[left_count].bytes, separator_size(left_count));
+
+  // the new leaf is not reachable until this leaf points to it
+  BPlusTreeLeaf new_leaf(bpt);
+  new_leaf.set_next_page_number(get_next_page_number());
+  new_leaf.rebuild(entries.data() + left_count, total_count - left_count, high_key);
+
+  set_next_page_number(new_leaf.page.get_page_number());
+  rebuild(entries.data(), left_count, separator);
+
+  return std::make_unique<BPlusTreeSplit>(separator, new_leaf.page.get_page_number());
+}
+
+void BPlusTreeLeaf::rebuild(const BPlusTreeRecord* entries, int32_t count, const BPlusTreeRecord& high_key) {
+  size_t prefix_size = count > 0 ? entries[0].common_prefix_size(entries[count - 1]) : 0;
+  auto prefix_begin = Page::SIZE - prefix_size;
+  if (prefix_size > 0) {
+    page.write(prefix_begin, prefix_size, entries[0].bytes);
+  }
+  page.write_int32(OFFSET_PREFIX_SIZE, prefix_size);
+
+  auto high_key_begin = prefix_begin - high_key.size;
+  if (high_key.size > 0) {
+    page.write(high_key_begin, high_key.size, high_key.bytes);
+  }
+  page.write_int32(OFFSET_HIGH_KEY, high_key_begin);
+  page.write_int32(OFFSET_HIGH_KEY + sizeof(high_key_t), high_key.size);
+
+  set_record_count(0);
+  set_data_begin(high_key_begin);
+
+  for (int32_t i = 0; i < count; i++) {
+    insert_at(i, BPlusTreeRecord(entries[i].bytes + prefix_size, entries[i].size - prefix_size));
+  }
+}
+
+void BPlusTreeLeaf::insert_at(int32_t idx, const BPlusTreeRecord& suffix) {
+  const auto record_count = get_record_count();
+  assert(static_cast<int32_t>(SLOT_SIZE + suffix.size) <= get_free_space());
+
+  auto data_begin = get_data_begin() - static_cast<int32_t>(suffix.size);
+  page.write(data_begin, suffix.size, suffix.bytes);
+  set_data_begin(data_begin);
+
+  auto slot_offset = OFFSET_SLOTS + idx * SLOT_SIZE;
+  page.move(slot_offset + SLOT_SIZE, slot_offset, (record_count - idx) * SLOT_SIZE);
+  auto head = suffix.get_head(0);
+  uint16_t location[2] = {static_cast<uint16_t>(data_begin), static_cast<uint16_t>(suffix.size)};
+  page.write(slot_offset, sizeof(head), reinterpret_cast<char*>(&head));
+  page.write(slot_offset + sizeof(head), sizeof(location), reinterpret_cast<char*>(location));
+  set_record_count(record_count + 1);
+  page.write_int32(OFFSET_VERSION, get_version() + 1);
 }
 
-void BPlusTreeLeaf::delete_record(const BPlusTreeRecord& record) {
+bool BPlusTreeLeaf::delete_record(const BPlusTreeRecord& record) {
   const auto record_count = get_record_count();
-  if (record_count == 0) {
-    return;
+  const auto prefix = get_prefix();
+  if (record.size < prefix.size || std::memcmp(record.bytes, prefix.bytes, prefix.size) != 0) {
+    return false;
   }
-  // TODO: Bonus
+  BPlusTreeRecord suffix(record.bytes + prefix.size, record.size - prefix.size);
+  auto index = search_index(record);
+  if (index == record_count || !(get_suffix(index) == suffix)) {
+    return false;
+  }
+
+  // the bytes of the suffix stay unused until the leaf is rebuilt. The prefix is still shared by the
+  // remaining records
+  auto slot_offset = OFFSET_SLOTS + index * SLOT_SIZE;
+  page.move(slot_offset, slot_offset + SLOT_SIZE, (record_count - index - 1) * SLOT_SIZE);
+  set_record_count(record_count - 1);
+  page.write_int32(OFFSET_VERSION, get_version() + 1);
+  return true;
+}
+
+bool BPlusTreeLeaf::merge_right(BPlusTreeLeaf& right, size_t max_size) {
+  // decompress the records of both leaves, the records of `right` are greater
+  const auto left_count = get_record_count();
+  const int32_t total_count = left_count + right.get_record_count();
+  std::vector<char> bytes(
+      left_count * get_prefix().size + (Page::SIZE - get_data_begin())
+      + right.get_record_count() * right.get_prefix().size + (Page::SIZE - right.get_data_begin())
+  );
+  std::vector<BPlusTreeRecord> entries;
+  std::vector<size_t> acc_size(total_count + 1);
+  entries.reserve(total_count);
+  size_t bytes_used = 0;
+  for (int32_t i = 0; i < total_count; i++) {
+    auto& leaf = i < left_count ? *this : right;
+    auto entry = leaf.get_record(i < left_count ? i : i - left_count, bytes.data() + bytes_used);
+    entries.emplace_back(entry.bytes, entry.size);
+    bytes_used += entry.size;
+    acc_size[i + 1] = acc_size[i] + SLOT_SIZE + entry.size;
+  }
+
+  auto high_key = right.get_high_key();
+  auto size = total_count > 0 ? leaf_size(entries.data(), acc_size.data(), 0, total_count) : OFFSET_SLOTS;
+  if (size + high_key.size > max_size) {
+    return false;
+  }
+
+  rebuild(entries.data(), total_count, high_key);
+  set_next_page_number(right.get_next_page_number());
+  page.write_int32(OFFSET_VERSION, get_version() + 1);
+
+  right.page.write_int32(OFFSET_REMOVED, 1);
+  right.set_next_page_number(page.get_page_number());
+  right.page.write_int32(OFFSET_VERSION, right.get_version() + 1);
+  return true;
 }
 
 int32_t BPlusTreeLeaf::get_record_count() const {
@@ -50,7 +226,7 @@ int32_t BPlusTreeLeaf::get_record_count() const {
 }
 
 void BPlusTreeLeaf::set_record_count(int32_t record_count) {
-  page.write_int32(0, record_count);
+  page.write_int32(OFFSET_RECORD_COUNT, record_count);
 }
 
 int32_t BPlusTreeLeaf::get_next_page_number() const {
@@ -58,46 +234,93 @@ int32_t BPlusTreeLeaf::get_next_page_number() const {
 }
 
 void BPlusTreeLeaf::set_next_page_number(int32_t n) {
-  page.write_int32(4, n);
+  page.write_int32(OFFSET_NEXT_LEAF, n);
+}
+
+int32_t BPlusTreeLeaf::get_data_begin() const {
+  return page.read_int32(OFFSET_DATA_BEGIN);
+}
+
+void BPlusTreeLeaf::set_data_begin(int32_t data_begin) {
+  page.write_int32(OFFSET_DATA_BEGIN, data_begin);
+}
+
+int32_t BPlusTreeLeaf::get_free_space() const {
+  return get_data_begin() - static_cast<int32_t>(OFFSET_SLOTS + get_record_count() * SLOT_SIZE);
+}
+
+int32_t BPlusTreeLeaf::get_version() const {
+  return page.read_int32(OFFSET_VERSION);
+}
+
+bool BPlusTreeLeaf::is_removed() const {
+  return page.read_int32(OFFSET_REMOVED) != 0;
+}
+
+size_t BPlusTreeLeaf::get_used_size() const {
+  const auto record_count = get_record_count();
+  size_t size = OFFSET_SLOTS + get_prefix().size + get_high_key().size + record_count * SLOT_SIZE;
+  for (int32_t i = 0; i < record_count; i++) {
+    size += get_suffix(i).size;
+  }
+  return size;
+}
+
+BPlusTreeRecord BPlusTreeLeaf::get_prefix() const {
+  auto prefix_size = page.read_int32(OFFSET_PREFIX_SIZE);
+  return BPlusTreeRecord(page.get_bytes() + Page::SIZE - prefix_size, prefix_size);
 }
 
-BPlusTreeRecord BPlusTreeLeaf::get_record(int32_t idx) const {
-  auto offset = OFFSET_RECORDS + idx * sizeof(BPlusTreeRecord);
-  auto key = page.read_int64(offset);
-  auto page_num = page.read_int32(offset + 8);
-  auto dir_slot = page.read_int32(offset + 12);
-  return BPlusTreeRecord(key, RID(page_num, dir_slot));
+BPlusTreeRecord BPlusTreeLeaf::get_high_key() const {
+  auto offset = page.read_int32(OFFSET_HIGH_KEY);
+  auto size = page.read_int32(OFFSET_HIGH_KEY + sizeof(high_key_t));
+  return BPlusTreeRecord(page.get_bytes() + offset, size);
 }
 
-void BPlusTreeLeaf::set_record(int32_t idx, const BPlusTreeRecord& record) {
-  auto offset = OFFSET_RECORDS + idx * sizeof(BPlusTreeRecord);
-  page.write_int64(offset, record.encoded_key);
-  page.write_int32(offset + 8, record.rid.page_num);
-  page.write_int32(offset + 12, record.rid.dir_slot);
+bool BPlusTreeLeaf::goes_right(const BPlusTreeRecord& record) const {
+  return get_next_page_number() != 0 && !(record < get_high_key());
+}
+
+BPlusTreeRecord BPlusTreeLeaf::get_suffix(int32_t idx) const {
+  uint16_t location[2];
+  auto slot_offset = OFFSET_SLOTS + idx * SLOT_SIZE;
+  std::memcpy(location, page.get_bytes() + slot_offset + sizeof(uint32_t), sizeof(location));
+  return BPlusTreeRecord(page.get_bytes() + location[0], location[1]);
+}
+
+BPlusTreeRecord BPlusTreeLeaf::get_record(int32_t idx, char* out) const {
+  auto prefix = get_prefix();
+  auto suffix = get_suffix(idx);
+  std::memcpy(out, prefix.bytes, prefix.size);
+  std::memcpy(out + prefix.size, suffix.bytes, suffix.size);
+  return BPlusTreeRecord(out, prefix.size + suffix.size);
 }
 
 int32_t BPlusTreeLeaf::search_index(const BPlusTreeRecord& record) const {
-  auto from = 0;
-  auto to = get_record_count() - 1;
+  // compare the prefix once, then only the suffixes
+  auto prefix = get_prefix();
+  auto prefix_cmp = std::memcmp(record.bytes, prefix.bytes, std::min(record.size, prefix.size));
+  if (prefix_cmp < 0 || (prefix_cmp == 0 && record.size < prefix.size)) {
+    return 0;
+  } else if (prefix_cmp > 0) {
+    return get_record_count();
+  }
+  BPlusTreeRecord suffix(record.bytes + prefix.size, record.size - prefix.size);
+
+  // only the suffixes with the same head than `suffix` have to be compared
+  auto slots = page.get_bytes() + OFFSET_SLOTS;
+  auto head = suffix.get_head(0);
+  int32_t from = BPlusTreeSlotSearch::lower_bound(slots, 0, get_record_count(), head, false);
+  int32_t to = BPlusTreeSlotSearch::lower_bound(slots, from, get_record_count(), head, true);
 
+  // the result is in [from, to]
   while (from < to) {
     auto mid = (from + to) / 2;
-
-    auto mid_record = get_record(mid);
-    if (record < mid_record) {
-      to = mid - 1;
-      continue;
-    } else if (mid_record < record) {
+    if (get_suffix(mid) < suffix) {
       from = mid + 1;
-      continue;
+    } else {
+      to = mid;
     }
-    // record is equal
-    return mid;
-  }
-  // from >= to
-  if (get_record(from) < record) {
-    return from + 1;
-  } else {
-    return from;
   }
+  return from;
 }
@@ -1,40 +1,74 @@
-
 #pragma once
 
 #include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/b_plus_tree/b_plus_tree_slot_search.h"
 #include "storage/b_plus_tree/b_plus_tree_utils.h"
 
 /*
-  Page layup:
+  Page layout:
   - First we have the record count (rc)
   - Then we have the next leaf page number
-  - Then we have (rc) records
+  - Then we have the offset where the record data begins (db)
+  - Then we have the size of the prefix (ps) shared by all the records of the leaf
+  - Then we have the offset and the size of the high key (int32), inside the record data
+  - Then we have the version, incremented on every change of the records
+  - Then we have 1 if the leaf was removed from the tree by a merge, 0 otherwise
+  - Then we have the first free page of the leaf file (only used in the leaf 0, see BPlusTree)
+  - Then we have (rc) slots, sorted by record. Each slot has the head of the record suffix (uint32, see
+    BPlusTreeSlotSearch), and the offset and the size of the suffix (uint16)
+  - Then we have the free space
+  - Then we have the suffix data, from (db) to (Page::SIZE - ps). Records are variable size
+    BPlusTreeRecords (encoded key + RID) and only the bytes after the prefix are stored
+  - Then we have the prefix, in the last (ps) bytes of the page
+  The prefix is the common prefix of the first and last records when the leaf is rebuilt (after a split,
+  or when a record not having the prefix is inserted), so keys with long common prefixes are stored once.
+
+  Every record of a leaf is lower than its high key, and greater records are in the next leaf (or further
+  right). The last leaf has no high key. As in dirs (see BPlusTreeDir), a split moves the greater records
+  to a new next leaf, so a search reaching a leaf that was split meanwhile moves right.
+
+  A leaf left with few records by deletes is merged with a sibling (see BPlusTree::merge_children): the
+  records of the right leaf move to the left one and the right leaf is removed. A removed leaf keeps the
+  left leaf as its next leaf, so a search or an iterator reaching it moves there.
  */
 class BPlusTreeLeaf {
+  friend class BPlusTree;
+  friend class BPlusTreeBuilder;
+
 public:
   using record_count_t = int32_t;
   using next_leaf_t = int32_t;
-  using record_t = BPlusTreeRecord;
-
-  static constexpr int32_t max_records =
-      (Page::SIZE - sizeof(record_count_t) - sizeof(next_leaf_t)) / (sizeof(record_t));
-
-  static constexpr auto max_space_used =
-      sizeof(record_count_t) + sizeof(next_leaf_t) + max_records * sizeof(record_t);
+  using data_begin_t = int32_t;
+  using prefix_size_t = int32_t;
+  using high_key_t = int32_t;
+  using version_t = int32_t;
+  using removed_t = int32_t;
+  using first_free_t = int32_t;
 
   static constexpr auto OFFSET_RECORD_COUNT = 0;
 
   static constexpr auto OFFSET_NEXT_LEAF = sizeof(record_count_t);
 
-  static constexpr auto OFFSET_RECORDS = sizeof(record_count_t) + sizeof(next_leaf_t);
+  static constexpr auto OFFSET_DATA_BEGIN = OFFSET_NEXT_LEAF + sizeof(next_leaf_t);
+
+  static constexpr auto OFFSET_PREFIX_SIZE = OFFSET_DATA_BEGIN + sizeof(data_begin_t);
+
+  static constexpr auto OFFSET_HIGH_KEY = OFFSET_PREFIX_SIZE + sizeof(prefix_size_t);
+
+  static constexpr auto OFFSET_VERSION = OFFSET_HIGH_KEY + 2 * sizeof(high_key_t);
 
-  static_assert(max_space_used <= Page::SIZE);
+  static constexpr auto OFFSET_REMOVED = OFFSET_VERSION + sizeof(version_t);
 
-  static_assert(OFFSET_RECORD_COUNT % alignof(record_count_t) == 0, "record count should be aligned");
+  static constexpr auto OFFSET_FIRST_FREE = OFFSET_REMOVED + sizeof(removed_t);
 
-  static_assert(OFFSET_NEXT_LEAF % alignof(next_leaf_t) == 0, "next leaf should be aligned");
+  static constexpr auto OFFSET_SLOTS = OFFSET_FIRST_FREE + sizeof(first_free_t);
 
-  static_assert(OFFSET_RECORDS % alignof(record_t) == 0, "records should be aligned");
+  static constexpr auto SLOT_SIZE = sizeof(uint32_t) + 2 * sizeof(uint16_t);
+
+  static_assert(SLOT_SIZE == BPlusTreeSlotSearch::SLOT_SIZE);
+
+  // a full leaf plus a new record can always be split in two leaves that fit with their high keys
+  static_assert(OFFSET_SLOTS + 4 * (SLOT_SIZE + BPlusTreeRecord::MAX_SIZE) <= Page::SIZE);
 
   BPlusTreeLeaf(const BPlusTree& bpt, int32_t page_number);
 
@@ -43,9 +77,20 @@ public:
 
   ~BPlusTreeLeaf();
 
+  // leaves the leaf empty, as the only leaf of a new B+tree
+  void init();
+
+  // returns nullptr if the leaf was not split. The caller must have the exclusive latch and this leaf
+  // must be the one where the record goes (see goes_right)
   std::unique_ptr<BPlusTreeSplit> insert_record(const BPlusTreeRecord& record);
 
-  void delete_record(const BPlusTreeRecord& record);
+  // returns false if the record is not in the leaf. The caller must have the exclusive latch and this leaf
+  // must be the one where the record goes (see goes_right)
+  bool delete_record(const BPlusTreeRecord& record);
+
+  // moves the records of `right`, the next leaf, into this leaf and removes `right`, if they fit in
+  // `max_size` bytes. Returns false if they don't fit. The caller must have the exclusive latch of both
+  bool merge_right(BPlusTreeLeaf& right, size_t max_size);
 
   const BPlusTree& bpt;
 
@@ -56,17 +101,50 @@ public:
   // returns 0 if there is no next leaf (page 0 is always the leftmost leaf)
   int32_t get_next_page_number() const;
 
-  BPlusTreeRecord get_record(int32_t idx) const;
+  // writes the record into out, that must have space for BPlusTreeRecord::MAX_SIZE bytes
+  BPlusTreeRecord get_record(int32_t idx, char* out) const;
 
-  void set_record(int32_t idx, const BPlusTreeRecord& record);
+  // the bytes of the prefix, suffixes and high key are valid while this object exists
+  BPlusTreeRecord get_prefix() const;
 
-  void set_record_count(int32_t);
+  BPlusTreeRecord get_suffix(int32_t idx) const;
 
-  void set_next_page_number(int32_t);
+  // returns an empty record if there is no next leaf
+  BPlusTreeRecord get_high_key() const;
+
+  int32_t get_version() const;
+
+  // true if the leaf was merged into the leaf that is now its next leaf (see merge_right)
+  bool is_removed() const;
+
+  // bytes used by the header, slots, records and high key
+  size_t get_used_size() const;
+
+  // returns true if the record is not in this leaf, but in the next one (or further right)
+  bool goes_right(const BPlusTreeRecord& record) const;
 
   // returns the index of the lowest record that is greater or equal than the record received
   // if no such record exists (all records are lower) this method will return the record_count
-  // BE CAREFUL on that case, accessing that index (same as calling get_record(get_record_count()))
+  // BE CAREFUL on that case, accessing that index (same as calling get_suffix(get_record_count()))
   // is undefined behaviour and must be avoided
   int32_t search_index(const BPlusTreeRecord& record) const;
+
+private:
+  void set_record_count(int32_t);
+
+  int32_t get_data_begin() const;
+
+  void set_data_begin(int32_t);
+
+  int32_t get_free_space() const;
+
+  void set_next_page_number(int32_t);
+
+  // leaves the page with the sorted `entries`, using their common prefix, and the high key received
+  // (empty if there is no next leaf)
+  void rebuild(const BPlusTreeRecord* entries, int32_t count, const BPlusTreeRecord& high_key);
+
+  // inserts the suffix of a record at position idx, shifting the next slots. There must be enough
+  // free space
+  void insert_at(int32_t idx, const BPlusTreeRecord& suffix);
 };
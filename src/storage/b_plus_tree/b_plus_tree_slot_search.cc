@@ -0,0 +1,131 @@
+#include "b_plus_tree_slot_search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SLOT_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+// Each function returns how many slots in [from, to) have a head lower than `head` (lower or equal if
+// `or_equal` is true)
+using CountFunction = int32_t (*)(const char* slots, int32_t from, int32_t to, uint32_t head, bool or_equal);
+
+static int32_t count_scalar(const char* slots, int32_t from, int32_t to, uint32_t head, bool or_equal) {
+  int32_t count = 0;
+  for (int32_t i = from; i < to; i++) {
+    auto slot_head = BPlusTreeSlotSearch::get_head(slots, i);
+    count += slot_head < head || (or_equal && slot_head == head);
+  }
+  return count;
+}
+
+#ifdef SLOT_SEARCH_X86
+// Heads are unsigned but SIMD comparisons are signed, flipping the sign bit of both sides keeps the order.
+// Heads are in the even 32-bit lanes of the slots loaded, the other lanes are masked out.
+
+__attribute__((target("sse4.2")))
+static int32_t count_sse42(const char* slots, int32_t from, int32_t to, uint32_t head, bool or_equal) {
+  const __m128i sign = _mm_set1_epi32(INT32_MIN);
+  const __m128i key = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(head)), sign);
+  int32_t count = 0;
+  int32_t i = from;
+  for (; i + 2 <= to; i += 2) {
+    auto loaded = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(slots + i * BPlusTreeSlotSearch::SLOT_SIZE)
+    );
+    auto heads = _mm_xor_si128(loaded, sign);
+    if (or_equal) {
+      auto greater = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(heads, key))) & 0x5;
+      count += 2 - __builtin_popcount(greater);
+    } else {
+      auto lower = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, heads))) & 0x5;
+      count += __builtin_popcount(lower);
+    }
+  }
+  return count + count_scalar(slots, i, to, head, or_equal);
+}
+
+__attribute__((target("avx2")))
+static int32_t count_avx2(const char* slots, int32_t from, int32_t to, uint32_t head, bool or_equal) {
+  const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+  const __m256i key = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(head)), sign);
+  int32_t count = 0;
+  int32_t i = from;
+  for (; i + 4 <= to; i += 4) {
+    auto loaded = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(slots + i * BPlusTreeSlotSearch::SLOT_SIZE)
+    );
+    auto heads = _mm256_xor_si256(loaded, sign);
+    if (or_equal) {
+      auto greater = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(heads, key))) & 0x55;
+      count += 4 - __builtin_popcount(greater);
+    } else {
+      auto lower = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, heads))) & 0x55;
+      count += __builtin_popcount(lower);
+    }
+  }
+  return count + count_sse42(slots, i, to, head, or_equal);
+}
+#endif
+
+static bool is_supported(BPlusTreeSlotSearch::Implementation implementation) {
+  switch (implementation) {
+  case BPlusTreeSlotSearch::Implementation::SCALAR:
+    return true;
+  case BPlusTreeSlotSearch::Implementation::SSE42:
+#ifdef SLOT_SEARCH_X86
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+  case BPlusTreeSlotSearch::Implementation::AVX2:
+#ifdef SLOT_SEARCH_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+  return false; // unreachable
+}
+
+static CountFunction get_function(BPlusTreeSlotSearch::Implementation implementation) {
+  switch (implementation) {
+#ifdef SLOT_SEARCH_X86
+  case BPlusTreeSlotSearch::Implementation::AVX2:
+    return count_avx2;
+  case BPlusTreeSlotSearch::Implementation::SSE42:
+    return count_sse42;
+#endif
+  default:
+    return count_scalar;
+  }
+}
+
+static BPlusTreeSlotSearch::Implementation get_best_implementation() {
+#ifdef SLOT_SEARCH_X86
+  // needed because this runs during static initialization
+  __builtin_cpu_init();
+#endif
+  if (is_supported(BPlusTreeSlotSearch::Implementation::AVX2)) {
+    return BPlusTreeSlotSearch::Implementation::AVX2;
+  } else if (is_supported(BPlusTreeSlotSearch::Implementation::SSE42)) {
+    return BPlusTreeSlotSearch::Implementation::SSE42;
+  }
+  return BPlusTreeSlotSearch::Implementation::SCALAR;
+}
+
+static BPlusTreeSlotSearch::Implementation current_implementation = get_best_implementation();
+
+CountFunction BPlusTreeSlotSearch::count = get_function(current_implementation);
+
+BPlusTreeSlotSearch::Implementation BPlusTreeSlotSearch::get_implementation() {
+  return current_implementation;
+}
+
+bool BPlusTreeSlotSearch::set_implementation(Implementation implementation) {
+  if (!is_supported(implementation)) {
+    return false;
+  }
+  current_implementation = implementation;
+  count = get_function(implementation);
+  return true;
+}
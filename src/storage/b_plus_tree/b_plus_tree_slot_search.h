@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+/*
+  Search over the slot array of a B+tree node (see BPlusTreeLeaf and BPlusTreeDir). Each slot is SLOT_SIZE
+  bytes starting with the head of its record: the first HEAD_SIZE bytes after the prefix shared by all the
+  records of the node, read big-endian and padded with zeros (see BPlusTreeRecord::get_head).
+  Heads are sorted as their records, so the position of a key is found comparing heads, and only the
+  records having the same head than the key must be compared completely.
+
+  A binary search on the heads narrows the range to SCAN_SIZE slots, that are then compared at once with
+  AVX2 or SSE4.2 when the CPU supports them (checked at runtime), or one by one otherwise.
+ */
+class BPlusTreeSlotSearch {
+public:
+  static constexpr size_t HEAD_SIZE = sizeof(uint32_t);
+
+  static constexpr size_t SLOT_SIZE = 8;
+
+  // slots scanned after the binary search, 2 cache lines
+  static constexpr int32_t SCAN_SIZE = 16;
+
+  enum class Implementation { SCALAR, SSE42, AVX2 };
+
+  // returns the first index in [from, to) whose head is greater or equal than `head` (greater than `head`
+  // if `or_equal` is true), `to` if there is none
+  static int32_t lower_bound(const char* slots, int32_t from, int32_t to, uint32_t head, bool or_equal) {
+    while (to - from > SCAN_SIZE) {
+      auto mid = (from + to) / 2;
+      auto mid_head = get_head(slots, mid);
+      if (mid_head < head || (or_equal && mid_head == head)) {
+        from = mid + 1;
+      } else {
+        to = mid;
+      }
+    }
+    return from + count(slots, from, to, head, or_equal);
+  }
+
+  static uint32_t get_head(const char* slots, int32_t idx) {
+    uint32_t head;
+    std::memcpy(&head, slots + idx * SLOT_SIZE, HEAD_SIZE);
+    return head;
+  }
+
+  // returns the implementation used, the best one supported by the CPU unless it was changed
+  static Implementation get_implementation();
+
+  // returns false (not changing it) if the CPU does not support the implementation. Not thread-safe, used
+  // to compare them
+  static bool set_implementation(Implementation implementation);
+
+private:
+  // returns how many slots in [from, to) have a head lower than `head` (lower or equal if `or_equal`)
+  static int32_t (*count)(const char* slots, int32_t from, int32_t to, uint32_t head, bool or_equal);
+};
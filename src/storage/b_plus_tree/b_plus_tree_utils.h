@@ -1,46 +1,122 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <vector>
 
+#include "relational_model/key_encoding.h"
 #include "storage/heap_file/rid.h"
 
+// Entry of the B+tree: the key encoded with KeyEncoding, followed by the encoded RID and by the encoded
+// INCLUDE columns of the index (if any). Entries are unique and comparing them with memcmp gives the
+// order of (key, rid).
+// It does not own the bytes, that usually are inside a pinned page. Searches may use only the key part
+// (without RID), that goes before every entry having that key.
 struct BPlusTreeRecord {
-  int64_t encoded_key;
-  RID rid;
+  static constexpr size_t RID_SIZE = 2 * sizeof(int32_t);
 
-  BPlusTreeRecord(int64_t encoded_key, RID rid)
-      : encoded_key(encoded_key),
-        rid(rid) {}
+  // max size of an entry, including the INCLUDE columns (see get_max_size)
+  static constexpr size_t MAX_SIZE = 960;
+
+  const char* bytes;
+
+  size_t size;
+
+  BPlusTreeRecord(const char* bytes, size_t size)
+      : bytes(bytes),
+        size(size) {}
+
+  int compare(const BPlusTreeRecord& other) const {
+    return KeyEncoding::compare(bytes, size, other.bytes, other.size);
+  }
 
   bool operator<(const BPlusTreeRecord& other) const {
-    if (encoded_key < other.encoded_key) {
-      return true;
-    } else if (other.encoded_key < encoded_key) {
-      return false;
+    return compare(other) < 0;
+  }
+
+  bool operator==(const BPlusTreeRecord& other) const {
+    return size == other.size && std::memcmp(bytes, other.bytes, size) == 0;
+  }
+
+  // returns the 4 bytes starting at `offset` as a big-endian number, padded with zeros if the record is
+  // shorter. If a record is lower than other, its head is lower or equal (see BPlusTreeSlotSearch)
+  uint32_t get_head(size_t offset) const {
+    uint32_t head = 0;
+    for (size_t i = offset; i < offset + sizeof(head); i++) {
+      head = (head << 8) | (i < size ? static_cast<unsigned char>(bytes[i]) : 0);
     }
+    return head;
+  }
 
-    return rid < other.rid;
+  // number of leading bytes shared with other
+  size_t common_prefix_size(const BPlusTreeRecord& other) const {
+    size_t max_size = size < other.size ? size : other.size;
+    size_t i = 0;
+    while (i < max_size && bytes[i] == other.bytes[i]) {
+      i++;
+    }
+    return i;
   }
 
-  bool operator==(const BPlusTreeRecord& other) const {
-    return encoded_key == other.encoded_key && rid == other.rid;
+  // the RID goes right after the key
+  RID get_rid(size_t key_size) const {
+    return decode_rid(bytes + key_size);
+  }
+
+  // writes RID_SIZE bytes, ordered as RID::operator<
+  static size_t encode_rid(RID rid, char* out) {
+    encode_int32(rid.page_num, out);
+    encode_int32(rid.dir_slot, out + sizeof(int32_t));
+    return RID_SIZE;
+  }
+
+  static RID decode_rid(const char* in) {
+    return RID(decode_int32(in), decode_int32(in + sizeof(int32_t)));
+  }
+
+  // returns the max size of an entry of an index over these columns. The LSM and ART indexes store entries
+  // with the same layout, without INCLUDE columns
+  static size_t get_max_size(
+      const Schema& schema,
+      const std::vector<int64_t>& key_columns,
+      const std::vector<int64_t>& include_columns = {}
+  ) {
+    return KeyEncoding::max_encoded_size(schema, key_columns) + RID_SIZE
+        + KeyEncoding::max_encoded_size(schema, include_columns);
+  }
+
+private:
+  static void encode_int32(int32_t value, char* out) {
+    uint32_t flipped = static_cast<uint32_t>(value) ^ (UINT32_C(1) << 31);
+    for (size_t i = 0; i < sizeof(int32_t); i++) {
+      out[i] = static_cast<char>(flipped >> (8 * (sizeof(int32_t) - 1 - i)));
+    }
+  }
+
+  static int32_t decode_int32(const char* in) {
+    uint32_t flipped = 0;
+    for (size_t i = 0; i < sizeof(int32_t); i++) {
+      flipped = (flipped << 8) | static_cast<unsigned char>(in[i]);
+    }
+    return static_cast<int32_t>(flipped ^ (UINT32_C(1) << 31));
   }
 };
 
+// Result of splitting a node: `record` is the separator that goes to the parent. Every entry of the new
+// node is greater or equal than it, and every entry of the split node is lower
 struct BPlusTreeSplit {
+  char bytes[BPlusTreeRecord::MAX_SIZE];
+
   BPlusTreeRecord record;
-  int32_t encoded_page_number;
 
-  BPlusTreeSplit(BPlusTreeRecord record, int32_t encoded_page_number)
-      : record(record),
-        encoded_page_number(encoded_page_number) {}
-};
+  int32_t encoded_page_number;
 
-struct BPlusTreeSearchResult {
-  int32_t leaf_page_number;
-  int32_t pos;
+  BPlusTreeSplit(const BPlusTreeRecord& separator, int32_t encoded_page_number)
+      : record(bytes, separator.size),
+        encoded_page_number(encoded_page_number) {
+    std::memcpy(bytes, separator.bytes, separator.size);
+  }
 
-  BPlusTreeSearchResult(int32_t leaf_page_number, int32_t pos)
-      : leaf_page_number(leaf_page_number),
-        pos(pos) {}
+  // prevent copies, record points to bytes
+  BPlusTreeSplit(const BPlusTreeSplit& other) = delete;
 };
@@ -29,6 +29,11 @@ static void create_directories(const std::string& str) {
   std::filesystem::create_directories(str);
 }
 
+[[maybe_unused]]
+static void remove(const std::string& str) {
+  std::filesystem::remove(str);
+}
+
 [[maybe_unused]]
 static int64_t file_size(const std::string& file) {
   return std::filesystem::file_size(file);
@@ -0,0 +1,131 @@
+#include "hash_bucket.h"
+
+#include <vector>
+
+#include "storage/hash_index/hash_index.h"
+#include "system/system.h"
+
+HashBucket::HashBucket(const HashIndex& index, int32_t page_number)
+    : page(buffer_mgr.get_page(index.bucket_file_id, page_number)),
+      index(index) {}
+
+HashBucket::HashBucket(const HashIndex& index)
+    : page(buffer_mgr.append_page(index.bucket_file_id)),
+      index(index) {}
+
+HashBucket::~HashBucket() {
+  page.unpin();
+}
+
+void HashBucket::init(int32_t local_depth) {
+  clear(local_depth);
+  set_overflow_page_number(0);
+}
+
+void HashBucket::clear(int32_t local_depth) {
+  set_entry_count(0);
+  set_data_begin(Page::SIZE);
+  page.write_int32(OFFSET_LOCAL_DEPTH, local_depth);
+}
+
+int32_t HashBucket::get_entry_count() const {
+  return page.read_int32(OFFSET_ENTRY_COUNT);
+}
+
+void HashBucket::set_entry_count(int32_t entry_count) {
+  page.write_int32(OFFSET_ENTRY_COUNT, entry_count);
+}
+
+int32_t HashBucket::get_local_depth() const {
+  return page.read_int32(OFFSET_LOCAL_DEPTH);
+}
+
+int32_t HashBucket::get_overflow_page_number() const {
+  return page.read_int32(OFFSET_OVERFLOW);
+}
+
+void HashBucket::set_overflow_page_number(int32_t overflow_page_number) {
+  page.write_int32(OFFSET_OVERFLOW, overflow_page_number);
+}
+
+int32_t HashBucket::get_data_begin() const {
+  return page.read_int32(OFFSET_DATA_BEGIN);
+}
+
+void HashBucket::set_data_begin(int32_t data_begin) {
+  page.write_int32(OFFSET_DATA_BEGIN, data_begin);
+}
+
+uint32_t HashBucket::get_hash(int32_t idx) const {
+  uint32_t hash;
+  std::memcpy(&hash, page.get_bytes() + OFFSET_SLOTS + idx * SLOT_SIZE, sizeof(hash));
+  return hash;
+}
+
+std::string_view HashBucket::get_entry(int32_t idx) const {
+  uint16_t location[2];
+  auto slot_offset = OFFSET_SLOTS + idx * SLOT_SIZE;
+  std::memcpy(location, page.get_bytes() + slot_offset + sizeof(uint32_t), sizeof(location));
+  return std::string_view(page.get_bytes() + location[0], location[1]);
+}
+
+bool HashBucket::insert(uint32_t hash, std::string_view entry) {
+  const auto entry_count = get_entry_count();
+  auto needed = static_cast<int32_t>(SLOT_SIZE + entry.size());
+  auto slots_end = static_cast<int32_t>(OFFSET_SLOTS + entry_count * SLOT_SIZE);
+
+  if (get_data_begin() - slots_end < needed) {
+    // the bytes of removed entries may give the space needed
+    int32_t used = 0;
+    for (int32_t i = 0; i < entry_count; i++) {
+      used += get_entry(i).size();
+    }
+    if (static_cast<int32_t>(Page::SIZE) - used - slots_end < needed) {
+      return false;
+    }
+    compact();
+  }
+
+  auto data_begin = get_data_begin() - static_cast<int32_t>(entry.size());
+  page.write(data_begin, entry.size(), entry.data());
+  set_data_begin(data_begin);
+
+  auto slot_offset = slots_end;
+  uint16_t location[2] = {static_cast<uint16_t>(data_begin), static_cast<uint16_t>(entry.size())};
+  page.write(slot_offset, sizeof(hash), reinterpret_cast<char*>(&hash));
+  page.write(slot_offset + sizeof(hash), sizeof(location), reinterpret_cast<char*>(location));
+  set_entry_count(entry_count + 1);
+  return true;
+}
+
+bool HashBucket::remove(uint32_t hash, std::string_view entry) {
+  const auto entry_count = get_entry_count();
+  for (int32_t i = 0; i < entry_count; i++) {
+    if (get_hash(i) == hash && get_entry(i) == entry) {
+      // slots are not sorted, the last one takes the place of the removed one
+      auto last_offset = OFFSET_SLOTS + (entry_count - 1) * SLOT_SIZE;
+      page.move(OFFSET_SLOTS + i * SLOT_SIZE, last_offset, SLOT_SIZE);
+      set_entry_count(entry_count - 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void HashBucket::compact() {
+  const auto entry_count = get_entry_count();
+  std::vector<char> bytes(Page::SIZE);
+  std::memcpy(bytes.data(), page.get_bytes(), Page::SIZE);
+
+  int32_t data_begin = Page::SIZE;
+  for (int32_t i = 0; i < entry_count; i++) {
+    auto slot_offset = OFFSET_SLOTS + i * SLOT_SIZE;
+    uint16_t location[2];
+    std::memcpy(location, bytes.data() + slot_offset + sizeof(uint32_t), sizeof(location));
+    data_begin -= location[1];
+    page.write(data_begin, location[1], bytes.data() + location[0]);
+    location[0] = static_cast<uint16_t>(data_begin);
+    page.write(slot_offset + sizeof(uint32_t), sizeof(location), reinterpret_cast<char*>(location));
+  }
+  set_data_begin(data_begin);
+}
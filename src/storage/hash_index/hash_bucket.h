@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "relational_model/key_encoding.h"
+#include "storage/heap_file/rid.h"
+#include "storage/page.h"
+
+class HashIndex;
+
+/*
+  Page layout:
+  - First we have the entry count (ec)
+  - Then we have the local depth (ld): every entry of the bucket has the same last (ld) bits of its hash
+  - Then we have the overflow page number, the next page of the bucket (0 if there is none)
+  - Then we have the offset where the entry data begins (db)
+  - Then we have (ec) slots, not sorted. Each slot has the hash of the entry (uint32), and the offset and the
+    size of the entry (uint16)
+  - Then we have the free space
+  - Then we have the entry data, from (db) to the end of the page. Each entry is the key encoded with
+    KeyEncoding followed by the RID
+  Deleting an entry removes its slot, and its bytes are reclaimed when the page needs the space.
+
+  A bucket has more pages (overflow pages) only when its entries can't be split by their hashes, e.g. if
+  there are many entries with the same key.
+ */
+class HashBucket {
+public:
+  using entry_count_t = int32_t;
+  using local_depth_t = int32_t;
+  using overflow_t = int32_t;
+  using data_begin_t = int32_t;
+
+  static constexpr auto OFFSET_ENTRY_COUNT = 0;
+
+  static constexpr auto OFFSET_LOCAL_DEPTH = sizeof(entry_count_t);
+
+  static constexpr auto OFFSET_OVERFLOW = OFFSET_LOCAL_DEPTH + sizeof(local_depth_t);
+
+  static constexpr auto OFFSET_DATA_BEGIN = OFFSET_OVERFLOW + sizeof(overflow_t);
+
+  static constexpr auto OFFSET_SLOTS = OFFSET_DATA_BEGIN + sizeof(data_begin_t);
+
+  static constexpr auto SLOT_SIZE = sizeof(uint32_t) + 2 * sizeof(uint16_t);
+
+  static constexpr size_t RID_SIZE = 2 * sizeof(int32_t);
+
+  // bounds the size of composite keys (see HashIndex::get_max_entry_size)
+  static constexpr size_t MAX_ENTRY_SIZE = 1024;
+
+  // an empty page always has space for an entry
+  static_assert(OFFSET_SLOTS + SLOT_SIZE + MAX_ENTRY_SIZE <= Page::SIZE);
+
+  HashBucket(const HashIndex& index, int32_t page_number);
+
+  // used to create a new page
+  HashBucket(const HashIndex& index);
+
+  ~HashBucket();
+
+  Page& page;
+
+  // leaves the page empty, without overflow page
+  void init(int32_t local_depth);
+
+  // removes all the entries, keeping the overflow page
+  void clear(int32_t local_depth);
+
+  int32_t get_entry_count() const;
+
+  int32_t get_local_depth() const;
+
+  int32_t get_overflow_page_number() const;
+
+  void set_overflow_page_number(int32_t overflow_page_number);
+
+  uint32_t get_hash(int32_t idx) const;
+
+  // the bytes are valid while this object exists
+  std::string_view get_entry(int32_t idx) const;
+
+  // returns false if there is no space for the entry
+  bool insert(uint32_t hash, std::string_view entry);
+
+  // returns false if the entry is not in this page
+  bool remove(uint32_t hash, std::string_view entry);
+
+  static RID get_rid(std::string_view entry) {
+    RID rid;
+    std::memcpy(&rid.page_num, entry.data() + entry.size() - RID_SIZE, sizeof(rid.page_num));
+    std::memcpy(&rid.dir_slot, entry.data() + entry.size() - sizeof(rid.dir_slot), sizeof(rid.dir_slot));
+    return rid;
+  }
+
+  static size_t encode_rid(RID rid, char* out) {
+    std::memcpy(out, &rid.page_num, sizeof(rid.page_num));
+    std::memcpy(out + sizeof(rid.page_num), &rid.dir_slot, sizeof(rid.dir_slot));
+    return RID_SIZE;
+  }
+
+private:
+  const HashIndex& index;
+
+  int32_t get_data_begin() const;
+
+  void set_data_begin(int32_t data_begin);
+
+  void set_entry_count(int32_t entry_count);
+
+  // moves the entries to the end of the page, dropping the bytes of removed entries
+  void compact();
+};
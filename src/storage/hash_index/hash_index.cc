@@ -0,0 +1,269 @@
+#include "hash_index.h"
+
+#include <algorithm>
+
+#include "exceptions/exceptions.h"
+#include "relational_model/key_encoding.h"
+#include "storage/hash_index/hash_bucket.h"
+#include "storage/hash_index/hash_index_iter.h"
+#include "storage/heap_file/heap_file.h"
+#include "system/system.h"
+
+// directory entries in each page of the directory file, after the first one
+static constexpr size_t DIR_ENTRIES_PER_PAGE = Page::SIZE / sizeof(int32_t);
+
+HashIndex::HashIndex(
+    const HeapFile& heap_file, const std::vector<int64_t>& key_columns, const std::string& idx_name
+)
+    : heap_file(heap_file),
+      key_columns(key_columns),
+      dir_file_id(file_mgr.get_file_id(idx_name + ".dir")),
+      bucket_file_id(file_mgr.get_file_id(idx_name + ".bucket")) {
+  if (file_mgr.count_pages(dir_file_id) == 0) {
+    // new index: a single empty bucket
+    global_depth = 0;
+    directory.push_back(0);
+    HashBucket bucket(*this, 0);
+    bucket.init(0);
+    write_directory(0, 1);
+    return;
+  }
+
+  auto& header = buffer_mgr.get_page(dir_file_id, 0);
+  global_depth = header.read_int32(0);
+  header.unpin();
+
+  directory.resize(size_t(1) << global_depth);
+  for (size_t i = 0; i < directory.size(); i += DIR_ENTRIES_PER_PAGE) {
+    auto& page = buffer_mgr.get_page(dir_file_id, 1 + i / DIR_ENTRIES_PER_PAGE);
+    auto count = std::min(DIR_ENTRIES_PER_PAGE, directory.size() - i);
+    page.read(0, count * sizeof(int32_t), reinterpret_cast<char*>(&directory[i]));
+    page.unpin();
+  }
+}
+
+HashIndex::~HashIndex() = default;
+
+uint32_t HashIndex::hash(const char* key, size_t size) {
+  // FNV-1a, followed by the finalizer of MurmurHash3 so the last bits depend on every byte
+  uint64_t hash = UINT64_C(14695981039346656037);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ static_cast<unsigned char>(key[i])) * UINT64_C(1099511628211);
+  }
+  hash ^= hash >> 33;
+  hash *= UINT64_C(0xff51afd7ed558ccd);
+  hash ^= hash >> 33;
+  hash *= UINT64_C(0xc4ceb9fe1a85ec53);
+  hash ^= hash >> 33;
+  return static_cast<uint32_t>(hash);
+}
+
+size_t HashIndex::get_max_entry_size(const Schema& schema, const std::vector<int64_t>& key_columns) {
+  size_t size = HashBucket::RID_SIZE;
+  for (auto col : key_columns) {
+    size += KeyEncoding::max_encoded_size(schema.columns[col].datatype);
+  }
+  return size;
+}
+
+size_t HashIndex::encode_entry(const Record& record, RID rid, char* out) const {
+  auto size = KeyEncoding::encode(record, key_columns, out);
+  return size + HashBucket::encode_rid(rid, out + size);
+}
+
+std::unique_ptr<RelationIter> HashIndex::get_iter(
+    const std::vector<Value>& min, const std::vector<Value>& max
+) {
+  auto& columns = heap_file.schema.columns;
+  bool valid = min.size() == key_columns.size() && max.size() == key_columns.size();
+  for (size_t i = 0; valid && i < key_columns.size(); i++) {
+    valid = min[i].datatype == columns[key_columns[i]].datatype && min[i] == max[i];
+  }
+  if (!valid) {
+    throw QueryException("hash index only supports equality lookups on every column of the key");
+  }
+  return std::make_unique<HashIndexIter>(*this, min);
+}
+
+void HashIndex::insert_record(const Record& record, RID rid) {
+  char entry[HashBucket::MAX_ENTRY_SIZE];
+  auto entry_size = encode_entry(record, rid, entry);
+  insert_entry(hash(entry, entry_size - HashBucket::RID_SIZE), std::string_view(entry, entry_size));
+}
+
+void HashIndex::delete_record(const Record& record, RID rid) {
+  char entry[HashBucket::MAX_ENTRY_SIZE];
+  auto entry_size = encode_entry(record, rid, entry);
+  auto entry_hash = hash(entry, entry_size - HashBucket::RID_SIZE);
+
+  // empty buckets are not merged
+  auto page_number = get_bucket_page_number(entry_hash);
+  while (true) {
+    HashBucket bucket(*this, page_number);
+    if (bucket.remove(entry_hash, std::string_view(entry, entry_size))) {
+      return;
+    }
+    page_number = bucket.get_overflow_page_number();
+    if (page_number == 0) {
+      return;
+    }
+  }
+}
+
+void HashIndex::insert_entry(uint32_t entry_hash, std::string_view entry) {
+  while (true) {
+    auto page_number = get_bucket_page_number(entry_hash);
+
+    // overflow pages are never the page 0
+    int32_t last_page_number = page_number;
+    do {
+      HashBucket bucket(*this, last_page_number);
+      if (bucket.insert(entry_hash, entry)) {
+        return;
+      }
+      auto overflow_page_number = bucket.get_overflow_page_number();
+      if (overflow_page_number == 0) {
+        break;
+      }
+      last_page_number = overflow_page_number;
+    } while (true);
+
+    if (can_split(page_number, entry_hash)) {
+      // the bucket where the entry goes may be full again, so the insertion is tried again
+      split(page_number, entry_hash);
+      continue;
+    }
+
+    HashBucket last(*this, last_page_number);
+    HashBucket overflow(*this);
+    overflow.init(last.get_local_depth());
+    overflow.insert(entry_hash, entry);
+    last.set_overflow_page_number(overflow.page.get_page_number());
+    return;
+  }
+}
+
+bool HashIndex::can_split(int32_t page_number, uint32_t entry_hash) const {
+  HashBucket first(*this, page_number);
+  if (first.get_local_depth() == MAX_GLOBAL_DEPTH) {
+    return false;
+  }
+  // splits only separate hashes with different bits in the first MAX_GLOBAL_DEPTH bits
+  auto mask = (UINT32_C(1) << MAX_GLOBAL_DEPTH) - 1;
+  while (true) {
+    HashBucket bucket(*this, page_number);
+    for (int32_t i = 0; i < bucket.get_entry_count(); i++) {
+      if (((bucket.get_hash(i) ^ entry_hash) & mask) != 0) {
+        return true;
+      }
+    }
+    page_number = bucket.get_overflow_page_number();
+    if (page_number == 0) {
+      return false;
+    }
+  }
+}
+
+void HashIndex::split(int32_t page_number, uint32_t entry_hash) {
+  // collect the entries of all the pages of the bucket
+  std::vector<char> bytes;
+  std::vector<uint32_t> hashes;
+  std::vector<size_t> offsets = {0};
+  int32_t local_depth;
+  {
+    HashBucket first(*this, page_number);
+    local_depth = first.get_local_depth();
+  }
+  for (auto current = page_number; ;) {
+    HashBucket bucket(*this, current);
+    for (int32_t i = 0; i < bucket.get_entry_count(); i++) {
+      auto entry = bucket.get_entry(i);
+      bytes.insert(bytes.end(), entry.begin(), entry.end());
+      offsets.push_back(bytes.size());
+      hashes.push_back(bucket.get_hash(i));
+    }
+    current = bucket.get_overflow_page_number();
+    if (current == 0) {
+      break;
+    }
+  }
+
+  if (local_depth == global_depth) {
+    // double the directory, the new half points to the same buckets
+    auto old_size = directory.size();
+    directory.resize(2 * old_size);
+    std::copy_n(directory.begin(), old_size, directory.begin() + old_size);
+    global_depth++;
+    write_directory(0, directory.size());
+  }
+
+  // entries with the bit `local_depth` set go to the new bucket
+  HashBucket new_bucket(*this);
+  new_bucket.init(local_depth + 1);
+  auto new_page_number = new_bucket.page.get_page_number();
+
+  std::vector<HashedEntry> old_entries;
+  std::vector<HashedEntry> new_entries;
+  for (size_t i = 0; i < hashes.size(); i++) {
+    std::string_view entry(bytes.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    if ((hashes[i] >> local_depth) & 1) {
+      new_entries.push_back({hashes[i], entry});
+    } else {
+      old_entries.push_back({hashes[i], entry});
+    }
+  }
+  write_bucket(page_number, local_depth + 1, old_entries);
+  write_bucket(new_page_number, local_depth + 1, new_entries);
+
+  // the directory entries of the bucket are the ones ending with its last `local_depth` bits
+  size_t low_bits = entry_hash & ((UINT32_C(1) << local_depth) - 1);
+  size_t step = size_t(1) << (local_depth + 1);
+  for (size_t i = low_bits | (size_t(1) << local_depth); i < directory.size(); i += step) {
+    directory[i] = new_page_number;
+    write_directory(i, i + 1);
+  }
+}
+
+void HashIndex::write_bucket(
+    int32_t page_number, int32_t local_depth, const std::vector<HashedEntry>& entries
+) {
+  size_t i = 0;
+  while (true) {
+    HashBucket bucket(*this, page_number);
+    bucket.clear(local_depth);
+    while (i < entries.size() && bucket.insert(entries[i].hash, entries[i].entry)) {
+      i++;
+    }
+
+    // overflow pages left empty stay in the bucket, to be used by next inserts
+    page_number = bucket.get_overflow_page_number();
+    if (page_number == 0) {
+      if (i == entries.size()) {
+        return;
+      }
+      HashBucket overflow(*this);
+      overflow.init(local_depth);
+      page_number = overflow.page.get_page_number();
+      bucket.set_overflow_page_number(page_number);
+    }
+  }
+}
+
+void HashIndex::write_directory(size_t from, size_t to) {
+  auto& header = buffer_mgr.get_page(dir_file_id, 0);
+  header.write_int32(0, global_depth);
+  header.unpin();
+
+  while (from < to) {
+    auto page_number = 1 + from / DIR_ENTRIES_PER_PAGE;
+    auto page_end = std::min(to, page_number * DIR_ENTRIES_PER_PAGE);
+    auto& page = buffer_mgr.get_page(dir_file_id, page_number);
+    page.write(
+        (from % DIR_ENTRIES_PER_PAGE) * sizeof(int32_t),
+        (page_end - from) * sizeof(int32_t),
+        reinterpret_cast<const char*>(&directory[from])
+    );
+    page.unpin();
+    from = page_end;
+  }
+}
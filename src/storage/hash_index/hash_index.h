@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "relational_model/index.h"
+#include "relational_model/record.h"
+#include "storage/file_id.h"
+
+class HeapFile;
+
+/*
+  Extendible hashing index for equality lookups. The directory has 2^global_depth entries pointing to
+  bucket pages (see HashBucket), and a key goes to the entry given by the last global_depth bits of its
+  hash. When a bucket gets full it is split in two buckets with one more bit of local depth, doubling the
+  directory if the local depth was equal to the global depth.
+
+  The directory is kept in memory and written to its own file: the first page has the global depth and
+  the next pages the entries. So a lookup reads a single bucket page, unless the bucket has overflow pages.
+ */
+class HashIndex : public Index {
+public:
+  // the directory doubles at most up to 2^MAX_GLOBAL_DEPTH entries, fuller buckets get overflow pages
+  static constexpr int32_t MAX_GLOBAL_DEPTH = 24;
+
+  // the key is the concatenation of the `key_columns`
+  HashIndex(const HeapFile& heap_file, const std::vector<int64_t>& key_columns, const std::string& idx_name);
+
+  ~HashIndex();
+
+  void insert_record(const Record& record, RID rid) override;
+
+  void delete_record(const Record& record, RID rid) override;
+
+  using Index::get_iter;
+
+  // returns the records with key = min, min and max must be equal and have a value for every key column
+  std::unique_ptr<RelationIter> get_iter(
+      const std::vector<Value>& min, const std::vector<Value>& max
+  ) override;
+
+  IndexType get_type() override {
+    return IndexType::HASH;
+  }
+
+  const std::vector<int64_t>& get_key_columns() const override {
+    return key_columns;
+  }
+
+  // returns the max size of an entry of an index over these columns, it must not exceed
+  // HashBucket::MAX_ENTRY_SIZE
+  static size_t get_max_entry_size(const Schema& schema, const std::vector<int64_t>& key_columns);
+
+  int32_t get_global_depth() const {
+    return global_depth;
+  }
+
+  // returns the first page of the bucket where the keys with `hash` are
+  int32_t get_bucket_page_number(uint32_t hash) const {
+    return directory[hash & ((UINT32_C(1) << global_depth) - 1)];
+  }
+
+  // hash of an encoded key
+  static uint32_t hash(const char* key, size_t size);
+
+  const HeapFile& heap_file;
+
+  const std::vector<int64_t> key_columns;
+
+  const FileId dir_file_id;
+
+  const FileId bucket_file_id;
+
+private:
+  struct HashedEntry {
+    uint32_t hash;
+    std::string_view entry;
+  };
+
+  int32_t global_depth;
+
+  std::vector<int32_t> directory;
+
+  // writes the entry `key` and `rid` into out, returns its size
+  size_t encode_entry(const Record& record, RID rid, char* out) const;
+
+  void insert_entry(uint32_t hash, std::string_view entry);
+
+  // returns true if the bucket starting at page_number can be split to make space for an entry with
+  // `hash`, false if all its entries would stay in the same bucket
+  bool can_split(int32_t page_number, uint32_t hash) const;
+
+  // splits the bucket starting at page_number, where the entries with `hash` are
+  void split(int32_t page_number, uint32_t hash);
+
+  // writes the entries in the pages of the bucket starting at page_number, adding overflow pages if needed
+  void write_bucket(int32_t page_number, int32_t local_depth, const std::vector<HashedEntry>& entries);
+
+  // writes the global depth and the directory entries [from, to) to the directory file
+  void write_directory(size_t from, size_t to);
+};
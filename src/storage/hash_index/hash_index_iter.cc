@@ -0,0 +1,73 @@
+#include "hash_index_iter.h"
+
+#include "storage/heap_file/heap_file.h"
+#include "storage/heap_file/table_page.h"
+
+// writes the encoding of the values into out, returns its size
+static size_t encode_key(const std::vector<Value>& key, char* out) {
+  size_t size = 0;
+  for (auto& value : key) {
+    size += KeyEncoding::encode(value, out + size);
+  }
+  return size;
+}
+
+HashIndexIter::HashIndexIter(const HashIndex& index, const std::vector<Value>& key)
+    : index(index),
+      key_size(encode_key(key, this->key)),
+      key_hash(HashIndex::hash(this->key, key_size)) {}
+
+void HashIndexIter::begin(Record& _out) {
+  out = &_out;
+  reset();
+}
+
+void HashIndexIter::reset() {
+  current_bucket = std::make_unique<HashBucket>(index, index.get_bucket_page_number(key_hash));
+  current_pos = 0;
+}
+
+bool HashIndexIter::advance(RID* rid) {
+  while (true) {
+    while (current_pos < current_bucket->get_entry_count()) {
+      auto pos = current_pos++;
+      if (current_bucket->get_hash(pos) != key_hash) {
+        continue;
+      }
+      auto entry = current_bucket->get_entry(pos);
+      if (entry.size() == key_size + HashBucket::RID_SIZE && std::memcmp(entry.data(), key, key_size) == 0) {
+        *rid = HashBucket::get_rid(entry);
+        return true;
+      }
+    }
+    auto overflow_page_number = current_bucket->get_overflow_page_number();
+    if (overflow_page_number == 0) {
+      return false;
+    }
+    current_bucket = std::make_unique<HashBucket>(index, overflow_page_number);
+    current_pos = 0;
+  }
+}
+
+bool HashIndexIter::next() {
+  RID rid;
+  if (!advance(&rid)) {
+    return false;
+  }
+  index.heap_file.get_record(rid, *out);
+  return true;
+}
+
+bool HashIndexIter::next_batch(ColumnBatch& batch) {
+  batch.clear();
+  if (current_bucket == nullptr) {
+    reset();
+  }
+
+  RID rid;
+  while (!batch.full() && advance(&rid)) {
+    auto heap_page = index.heap_file.get_page(rid.page_num);
+    heap_page->append_to_batch(rid.dir_slot, rid.dir_slot + 1, batch, index.heap_file.schema, {}, {});
+  }
+  return batch.size > 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "relational_model/key_encoding.h"
+#include "relational_model/relation_iter.h"
+#include "storage/hash_index/hash_bucket.h"
+#include "storage/hash_index/hash_index.h"
+
+// Returns the records having a key, reading the pages of its bucket
+class HashIndexIter : public RelationIter {
+public:
+  HashIndexIter(const HashIndex& index, const std::vector<Value>& key);
+
+  virtual void begin(Record& out) override;
+
+  virtual bool next() override;
+
+  virtual bool next_batch(ColumnBatch& batch) override;
+
+  virtual void reset() override;
+
+private:
+  const HashIndex& index;
+
+  // encoded key
+  char key[HashBucket::MAX_ENTRY_SIZE];
+
+  const size_t key_size;
+
+  const uint32_t key_hash;
+
+  std::unique_ptr<HashBucket> current_bucket;
+
+  int32_t current_pos;
+
+  Record* out;
+
+  // moves to the next entry with the key, returns false if there is no such entry
+  bool advance(RID* rid);
+};
@@ -1,48 +1,99 @@
 #include "heap_file.h"
 
 #include "storage/heap_file/heap_file_iter.h"
-#include "storage/heap_file/heap_file_page.h"
 #include "system/system.h"
 
-HeapFile::HeapFile(TableId table_id, const Schema& schema, const std::string& table_name)
+static ColumnDictionaries make_dictionaries(const Schema& schema, const std::string& table_name) {
+  ColumnDictionaries res;
+  for (size_t i = 0; i < schema.columns.size(); i++) {
+    if (schema.columns[i].encoding == ColumnEncoding::DICTIONARY) {
+      res.push_back(std::make_unique<StringDictionary>(table_name + ".col" + std::to_string(i) + ".dict"));
+    } else {
+      res.push_back(nullptr);
+    }
+  }
+  return res;
+}
+
+HeapFile::HeapFile(TableId table_id, const Schema& schema, const std::string& table_name, TableFormat format)
     : schema(schema),
       file_id(file_mgr.get_file_id(table_name)),
-      table_id(table_id) {}
+      table_id(table_id),
+      format(format),
+      zone_map(std::make_unique<ZoneMap>(schema, table_name + ".zmap")),
+      codec(get_record_codec(schema)),
+      dictionaries(make_dictionaries(schema, table_name)),
+      pax_layout(schema) {}
+
+std::unique_ptr<TablePage> HeapFile::get_page(int64_t page_number) const {
+  switch (format) {
+  case TableFormat::ROW:
+    return std::make_unique<HeapFilePage>(file_id, page_number, dictionaries, codec);
+  case TableFormat::PAX:
+    return std::make_unique<PaxPage>(file_id, page_number, pax_layout, dictionaries);
+  }
+  return nullptr; // unreachable
+}
+
+bool HeapFile::try_insert_record(TablePage& page, const Record& record, RID* rid) {
+  if (!page.try_insert_record(record, rid)) {
+    return false;
+  }
+  zone_map->update(rid->page_num, record, page.get_dir_count() == 1);
+  return true;
+}
 
 RID HeapFile::insert_record(const Record& record) {
-  auto current_page = std::make_unique<HeapFilePage>(file_id, last_insert_page);
   RID res;
 
   // search block with available space and insert it there
-  while (true) {
-    if (current_page->try_insert_record(record, &res)) {
-      return res;
-    }
+  while (!with_page(last_insert_page, [&](auto& page) { return try_insert_record(page, record, &res); })) {
     last_insert_page++;
-    current_page = std::make_unique<HeapFilePage>(file_id, last_insert_page);
   }
+  return res;
+}
+
+RID HeapFile::insert_record(const Record& record, std::unique_ptr<TablePage>& current_page) {
+  if (current_page == nullptr || current_page->page.page_id.page_number != last_insert_page) {
+    current_page = get_page(last_insert_page);
+  }
+  RID res;
+
+  // search block with available space and insert it there
+  while (!try_insert_record(*current_page, record, &res)) {
+    last_insert_page++;
+    current_page = get_page(last_insert_page);
+  }
+  return res;
+}
+
+std::unique_ptr<HeapFileIter> HeapFile::get_record_iter(std::vector<bool> projection) const {
+  return std::make_unique<HeapFileIter>(*this, std::move(projection));
 }
 
-std::unique_ptr<HeapFileIter> HeapFile::get_record_iter() const {
-  return std::make_unique<HeapFileIter>(*this);
+std::unique_ptr<HeapFileFilteredIter>
+HeapFile::get_filtered_iter(std::vector<ColumnPredicate> predicates) const {
+  return std::make_unique<HeapFileFilteredIter>(*this, std::move(predicates));
 }
 
 void HeapFile::delete_record(RID rid) {
-  HeapFilePage page(file_id, rid.page_num);
-  page.delete_record(rid.dir_slot);
+  with_page(rid.page_num, [&](auto& page) { page.delete_record(rid.dir_slot); });
+  zone_map->mark_stale(rid.page_num);
 }
 
 void HeapFile::vacuum() {
   auto total_pages = file_mgr.count_pages(file_id);
+  Arena arena;
 
   for (auto i = 0; i < total_pages; i++) {
-    HeapFilePage page(file_id, i);
-    page.vacuum(schema);
+    auto page = get_page(i);
+    page->vacuum(schema, arena);
+    zone_map->rebuild(*page);
+    arena.reset();
   }
   last_insert_page = 0;
 }
 
 void HeapFile::get_record(RID rid, Record& out) const {
-  HeapFilePage page(file_id, rid.page_num);
-  page.get_record(rid.dir_slot, out);
+  with_page(rid.page_num, [&](auto& page) { page.get_record(rid.dir_slot, out); });
 }
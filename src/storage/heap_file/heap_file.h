@@ -3,11 +3,19 @@
 #include <memory>
 #include <string>
 
+#include "relational_model/column_predicate.h"
 #include "relational_model/record.h"
 #include "relational_model/table_info.h"
 #include "storage/file_id.h"
+#include "storage/heap_file/heap_file_filtered_iter.h"
 #include "storage/heap_file/heap_file_iter.h"
+#include "storage/heap_file/heap_file_page.h"
+#include "storage/heap_file/pax_page.h"
+#include "storage/heap_file/record_codec.h"
 #include "storage/heap_file/rid.h"
+#include "storage/heap_file/string_dictionary.h"
+#include "storage/heap_file/table_page.h"
+#include "storage/heap_file/zone_map.h"
 
 class HeapFile {
 public:
@@ -17,23 +25,83 @@ public:
 
   const TableId table_id;
 
-  HeapFile(TableId table_id, const Schema& schema, const std::string& table_name);
+  const TableFormat format;
+
+  // min/max of each column per page, used by filtered scans to skip pages
+  const std::unique_ptr<ZoneMap> zone_map;
+
+  // specialized serialization for the schema of the table, nullptr if there is none (see RecordCodec)
+  const RecordCodecDispatch* const codec;
+
+  // dictionaries of the columns with ColumnEncoding::DICTIONARY, nullptr for the other columns
+  const ColumnDictionaries dictionaries;
+
+  HeapFile(TableId table_id, const Schema& schema, const std::string& table_name, TableFormat format);
 
   // prevent accidental copies
   HeapFile(const HeapFile& other) = delete;
 
   RID insert_record(const Record& record);
 
+  // Same as insert_record(record), but starts looking for space in `current_page` if it is not nullptr.
+  // When it returns, `current_page` is the page where the record was inserted, so consecutive inserts
+  // pin a page only when the previous one gets full
+  RID insert_record(const Record& record, std::unique_ptr<TablePage>& current_page);
+
   void delete_record(RID rid);
 
   void get_record(RID rid, Record& out) const;
 
   void vacuum();
 
-  // Iterates over all results
-  std::unique_ptr<HeapFileIter> get_record_iter() const;
+  // Iterates over all results. If `projection` is not empty only the marked columns are written
+  std::unique_ptr<HeapFileIter> get_record_iter(std::vector<bool> projection = {}) const;
+
+  // Iterates over the records satisfying all the predicates (a conjunction). Throws a QueryException
+  // if a predicate references a column that does not exist or its constant has a different datatype
+  std::unique_ptr<HeapFileFilteredIter> get_filtered_iter(std::vector<ColumnPredicate> predicates) const;
+
+  // returns the page `page_number` using the layout of this file's format.
+  // The page stays pinned until the returned object is destroyed
+  std::unique_ptr<TablePage> get_page(int64_t page_number) const;
+
+  // Calls `f` with the page `page_number` (a HeapFilePage or a PaxPage, depending on the format) and
+  // returns its result. The page is constructed on the stack, so callers that don't keep the page after
+  // the call use this instead of get_page
+  template <typename F>
+  auto with_page(int64_t page_number, F&& f) const {
+    if (format == TableFormat::PAX) {
+      PaxPage page(file_id, page_number, pax_layout, dictionaries);
+      return f(page);
+    }
+    HeapFilePage page(file_id, page_number, dictionaries, codec);
+    return f(page);
+  }
+
+  // Appends to `batch` the records at the RIDs written by `next_rid`, a callable `bool(RID*)` that returns
+  // false when there are no more RIDs, until the batch is full. Used by the iterators of the indexes
+  template <typename NextRid>
+  void append_records_to_batch(NextRid&& next_rid, ColumnBatch& batch) const {
+    // records pointing to the same heap page are usually together, keep the last page pinned
+    std::unique_ptr<TablePage> page;
+
+    RID rid;
+    while (!batch.full() && next_rid(&rid)) {
+      if (page == nullptr || page->page.page_id.page_number != rid.page_num) {
+        page.reset(); // unpin before pinning the next one
+        page = get_page(rid.page_num);
+      }
+      page->append_to_batch(rid.dir_slot, rid.dir_slot + 1, batch, schema, {}, {});
+    }
+  }
 
 private:
+  // inserts the record in the page if it fits, updating the zone map
+  bool try_insert_record(TablePage& page, const Record& record, RID* rid);
+
+  // only used when format is PAX
+  const PaxLayout pax_layout;
+
   // remembers where was the last insert so it doesn't begin from the start
   // the next time
   int64_t last_insert_page = 0;
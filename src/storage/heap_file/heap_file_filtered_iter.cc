@@ -0,0 +1,100 @@
+#include "heap_file_filtered_iter.h"
+
+#include <algorithm>
+
+#include "exceptions/exceptions.h"
+#include "storage/heap_file/heap_file.h"
+#include "system/system.h"
+
+static std::vector<ColumnPredicate> sort_predicates(std::vector<ColumnPredicate>&& predicates) {
+  std::stable_sort(predicates.begin(), predicates.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.col_idx < rhs.col_idx;
+  });
+  return std::move(predicates);
+}
+
+HeapFileFilteredIter::HeapFileFilteredIter(
+    const HeapFile& heap_file, std::vector<ColumnPredicate>&& predicates
+)
+    : heap_file(heap_file),
+      predicates(sort_predicates(std::move(predicates))) {
+  const auto& columns = heap_file.schema.columns;
+  for (auto& predicate : this->predicates) {
+    if (predicate.col_idx < 0 || predicate.col_idx >= static_cast<int64_t>(columns.size())) {
+      throw QueryException("predicate column index out of range: " + std::to_string(predicate.col_idx));
+    }
+    if (predicate.constant.datatype != columns[predicate.col_idx].datatype) {
+      throw QueryException(
+          "predicate constant datatype does not match column `" + columns[predicate.col_idx].name + "`"
+      );
+    }
+    if (heap_file.dictionaries[predicate.col_idx] != nullptr) {
+      heap_file.dictionaries[predicate.col_idx]->bind(predicate);
+    }
+  }
+
+  total_pages = file_mgr.count_pages(heap_file.file_id);
+  load_page(0);
+}
+
+void HeapFileFilteredIter::begin(Record& out) {
+  this->out = &out;
+}
+
+bool HeapFileFilteredIter::load_page(int64_t page_number) {
+  // value starts as -1 because in next we always sum 1 before processing
+  current_page_record_pos = -1;
+  current_page_number = heap_file.zone_map->next_candidate_page(page_number, total_pages, predicates);
+
+  if (current_page_number < total_pages) {
+    current_page = heap_file.get_page(current_page_number);
+    // refresh the summary of pages we have to read anyway, so next scans may skip them
+    if (heap_file.zone_map->get_state(current_page_number) != ZoneMap::VALID) {
+      heap_file.zone_map->rebuild(*current_page);
+    }
+    return true;
+  } else {
+    current_page = nullptr;
+    return false;
+  }
+}
+
+bool HeapFileFilteredIter::next() {
+  while (current_page != nullptr) {
+    current_page_record_pos++;
+    if (current_page_record_pos >= static_cast<int64_t>(current_page->get_dir_count())) {
+      load_page(current_page_number + 1);
+      continue;
+    }
+
+    if (current_page->satisfies(current_page_record_pos, heap_file.schema, predicates)) {
+      current_page->get_record(current_page_record_pos, *out);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HeapFileFilteredIter::next_batch(ColumnBatch& batch) {
+  batch.clear();
+  while (current_page != nullptr && !batch.full()) {
+    auto dir_count = current_page->get_dir_count();
+    auto next_pos = current_page->append_to_batch(
+        current_page_record_pos + 1, dir_count, batch, heap_file.schema, {}, predicates
+    );
+    current_page_record_pos = next_pos - 1;
+
+    if (next_pos >= dir_count) {
+      load_page(current_page_number + 1);
+    }
+  }
+  return batch.size > 0;
+}
+
+void HeapFileFilteredIter::reset() {
+  load_page(0);
+}
+
+RID HeapFileFilteredIter::get_current_RID() const {
+  return RID(current_page_number, current_page_record_pos);
+}
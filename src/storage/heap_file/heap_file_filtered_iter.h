@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "relational_model/column_predicate.h"
+#include "relational_model/relation_iter.h"
+#include "storage/heap_file/table_page.h"
+#include "storage/heap_file/rid.h"
+
+class HeapFile;
+
+// Iterates over the records of a heap file that satisfy a conjunction of predicates.
+// Predicates are evaluated over the bytes of the page, and only records that pass all of
+// them are written into the output record. Pages that the zone map proves to have no matching records
+// are not read at all.
+class HeapFileFilteredIter : public RelationIter {
+public:
+  HeapFileFilteredIter(const HeapFile& heap_file, std::vector<ColumnPredicate>&& predicates);
+
+  virtual void begin(Record& out) override;
+
+  virtual bool next() override;
+
+  virtual bool next_batch(ColumnBatch& batch) override;
+
+  virtual void reset() override;
+
+  RID get_current_RID() const;
+
+private:
+  // moves to the first page at or after page_number that may contain matching records.
+  // returns false if there is no such page
+  bool load_page(int64_t page_number);
+
+  const HeapFile& heap_file;
+
+  // sorted by col_idx, predicates over dictionary encoded columns are bound to their dictionary
+  std::vector<ColumnPredicate> predicates;
+
+  std::unique_ptr<TablePage> current_page;
+
+  int64_t total_pages;
+
+  int64_t current_page_number;
+
+  int64_t current_page_record_pos;
+
+  Record* out;
+};
@@ -1,16 +1,16 @@
 #include "heap_file_iter.h"
 
 #include "storage/heap_file/heap_file.h"
-#include "storage/heap_file/heap_file_page.h"
 #include "system/system.h"
 
-HeapFileIter::HeapFileIter(const HeapFile& heap_file)
-    : heap_file(heap_file) {
+HeapFileIter::HeapFileIter(const HeapFile& heap_file, std::vector<bool> projection)
+    : heap_file(heap_file),
+      projection(std::move(projection)) {
   // value starts as -1 because in next we always sum 1 before processing
   current_page_record_pos = -1;
 
   current_page_number = 0;
-  current_page = std::make_unique<HeapFilePage>(heap_file.file_id, 0);
+  current_page = heap_file.get_page(0);
   total_pages = file_mgr.count_pages(heap_file.file_id);
 }
 
@@ -28,7 +28,7 @@ bool HeapFileIter::next() {
       current_page_number++;
 
       if (current_page_number < total_pages) {
-        current_page = std::make_unique<HeapFilePage>(heap_file.file_id, current_page_number);
+        current_page = heap_file.get_page(current_page_number);
         continue;
       } else {
         current_page = nullptr;
@@ -36,17 +36,39 @@ bool HeapFileIter::next() {
       }
     }
 
-    if (current_page->get_record(current_page_record_pos, *out)) {
+    if (current_page->get_record(current_page_record_pos, *out, projection)) {
       return true;
     }
   }
   return false;
 }
 
+bool HeapFileIter::next_batch(ColumnBatch& batch) {
+  batch.clear();
+  while (current_page != nullptr && !batch.full()) {
+    auto dir_count = current_page->get_dir_count();
+    auto next_pos = current_page->append_to_batch(
+        current_page_record_pos + 1, dir_count, batch, heap_file.schema, projection, {}
+    );
+    current_page_record_pos = next_pos - 1;
+
+    if (next_pos >= dir_count) {
+      current_page_record_pos = -1;
+      current_page_number++;
+      if (current_page_number < total_pages) {
+        current_page = heap_file.get_page(current_page_number);
+      } else {
+        current_page = nullptr;
+      }
+    }
+  }
+  return batch.size > 0;
+}
+
 void HeapFileIter::reset() {
   current_page_record_pos = -1;
   current_page_number = 0;
-  current_page = std::make_unique<HeapFilePage>(heap_file.file_id, 0);
+  current_page = heap_file.get_page(0);
 }
 
 RID HeapFileIter::get_current_RID() const {
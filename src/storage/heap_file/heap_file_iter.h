@@ -3,19 +3,22 @@
 #include <memory>
 
 #include "relational_model/relation_iter.h"
-#include "storage/heap_file/heap_file_page.h"
+#include "storage/heap_file/table_page.h"
 #include "storage/heap_file/rid.h"
 
 class HeapFile;
 
 class HeapFileIter : public RelationIter {
 public:
-  HeapFileIter(const HeapFile& heap_file);
+  // if `projection` is not empty only the marked columns are written into the output record
+  HeapFileIter(const HeapFile& heap_file, std::vector<bool> projection);
 
   virtual void begin(Record& out) override;
 
   virtual bool next() override;
 
+  virtual bool next_batch(ColumnBatch& batch) override;
+
   virtual void reset() override;
 
   RID get_current_RID() const;
@@ -23,7 +26,9 @@ public:
 private:
   const HeapFile& heap_file;
 
-  std::unique_ptr<HeapFilePage> current_page;
+  const std::vector<bool> projection;
+
+  std::unique_ptr<TablePage> current_page;
 
   int64_t total_pages;
 
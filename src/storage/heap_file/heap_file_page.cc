@@ -1,5 +1,6 @@
 #include "heap_file_page.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
@@ -7,8 +8,15 @@
 #include "storage/page.h"
 #include "system/system.h"
 
-HeapFilePage::HeapFilePage(FileId file_id, int64_t page_number)
-    : page(buffer_mgr.get_page(file_id, page_number)) {
+HeapFilePage::HeapFilePage(
+    FileId file_id,
+    int64_t page_number,
+    const ColumnDictionaries& dictionaries,
+    const RecordCodecDispatch* codec
+)
+    : TablePage(buffer_mgr.get_page(file_id, page_number)),
+      dictionaries(dictionaries),
+      codec(codec) {
   // if new page, initialize to be valid
   // new pages comes with all bytes setted at 0
   if (get_dir_count() == 0 && get_free_space() == 0) {
@@ -16,10 +24,6 @@ HeapFilePage::HeapFilePage(FileId file_id, int64_t page_number)
   }
 }
 
-HeapFilePage::~HeapFilePage() {
-  page.unpin();
-}
-
 void HeapFilePage::set_dir_count(int32_t new_dir_count) {
   page.write_int32(0, new_dir_count);
 }
@@ -44,27 +48,45 @@ int32_t HeapFilePage::get_dir(int32_t idx) const {
   return page.read_int32(8 + 4 * idx);
 }
 
-bool HeapFilePage::get_record(int32_t dir_pos, Record& out) const {
+bool HeapFilePage::get_record(int32_t dir_pos, Record& out, const std::vector<bool>& projection) const {
   auto offset = get_dir(dir_pos);
   if (offset <= 0) {
     return false;
   }
 
-  for (auto& v : out.values) {
+  if (codec != nullptr && projection.empty()) {
+    codec->decode(page.get_bytes() + offset, out);
+    return true;
+  }
+
+  for (size_t col = 0; col < out.values.size(); col++) {
+    auto& v = out.values[col];
+    bool projected = projection.empty() || projection[col];
     switch (v.datatype) {
     case DataType::INT: {
-      v.value.as_int = page.read_int64(offset);
+      if (projected) {
+        v.value.as_int = page.read_int64(offset);
+      }
       offset += sizeof(int64_t);
       break;
     }
     case DataType::STR: {
+      if (dictionaries[col] != nullptr) {
+        if (projected) {
+          auto& str = dictionaries[col]->decode(page.read_int32(offset));
+          v.set_str(str.data(), str.size());
+        }
+        offset += sizeof(StringDictionary::code_t);
+        break;
+      }
+
       uint8_t len = page.read_uint8(offset);
       offset += 1;
 
-      page.read(offset, len, v.value.as_str);
+      if (projected) {
+        v.set_str(page.get_bytes() + offset, len);
+      }
       offset += len;
-
-      v.value.as_str[len] = '\0';
       break;
     }
     }
@@ -73,25 +95,159 @@ bool HeapFilePage::get_record(int32_t dir_pos, Record& out) const {
   return true;
 }
 
-void HeapFilePage::delete_record(int32_t dir_pos) {
-  set_dir(dir_pos, -1);
-}
+bool HeapFilePage::satisfies(
+    int32_t dir_pos, const Schema& schema, const std::vector<ColumnPredicate>& predicates
+) const {
+  auto offset = get_dir(dir_pos);
+  if (offset <= 0) {
+    return false;
+  }
 
-bool HeapFilePage::try_insert_record(const Record& record, RID* out_record_id) {
-  int32_t needed_record_size = 0;
-  for (size_t i = 0; i < record.values.size(); i++) {
-    switch (record.values[i].datatype) {
+  const char* bytes = page.get_bytes();
+  auto predicate = predicates.begin();
+
+  for (int64_t col = 0; predicate != predicates.end(); col++) {
+    switch (schema.columns[col].datatype) {
     case DataType::INT: {
-      needed_record_size += sizeof(int64_t);
+      int64_t value;
+      std::memcpy(&value, bytes + offset, sizeof(int64_t));
+      for (; predicate != predicates.end() && predicate->col_idx == col; ++predicate) {
+        auto constant = predicate->constant.value.as_int;
+        int cmp = value < constant ? -1 : (constant < value ? 1 : 0);
+        if (!compare_matches(predicate->op, cmp)) {
+          return false;
+        }
+      }
+      offset += sizeof(int64_t);
       break;
     }
     case DataType::STR: {
-      // one additional byte for the strlen at beginning
-      needed_record_size += 1 + strlen(record.values[i].value.as_str);
+      if (dictionaries[col] != nullptr) {
+        StringDictionary::code_t code;
+        std::memcpy(&code, bytes + offset, sizeof(code));
+        for (; predicate != predicates.end() && predicate->col_idx == col; ++predicate) {
+          if (!dictionaries[col]->matches(*predicate, code)) {
+            return false;
+          }
+        }
+        offset += sizeof(code);
+        break;
+      }
+
+      uint8_t len = static_cast<uint8_t>(bytes[offset]);
+      const char* str = bytes + offset + 1;
+      for (; predicate != predicates.end() && predicate->col_idx == col; ++predicate) {
+        const char* constant = predicate->constant.value.as_str;
+        size_t constant_len = strlen(constant);
+        int cmp = std::memcmp(str, constant, std::min<size_t>(len, constant_len));
+        if (cmp == 0) {
+          cmp = len < constant_len ? -1 : (constant_len < len ? 1 : 0);
+        }
+        if (!compare_matches(predicate->op, cmp)) {
+          return false;
+        }
+      }
+      offset += 1 + len;
       break;
     }
     }
   }
+  return true;
+}
+
+int32_t HeapFilePage::append_to_batch(
+    int32_t begin_dir_pos,
+    int32_t end_dir_pos,
+    ColumnBatch& batch,
+    const Schema& schema,
+    const std::vector<bool>& projection,
+    const std::vector<ColumnPredicate>& predicates
+) const {
+  const char* bytes = page.get_bytes();
+  end_dir_pos = std::min(end_dir_pos, get_dir_count());
+  int32_t dir_pos = begin_dir_pos;
+
+  for (; dir_pos < end_dir_pos && !batch.full(); dir_pos++) {
+    auto offset = get_dir(dir_pos);
+    if (offset <= 0) {
+      continue;
+    }
+    // qualified call to avoid the virtual dispatch
+    if (!predicates.empty() && !HeapFilePage::satisfies(dir_pos, schema, predicates)) {
+      continue;
+    }
+
+    if (codec != nullptr && projection.empty()) {
+      codec->decode_to_batch(bytes + offset, batch);
+      batch.size++;
+      continue;
+    }
+
+    auto row = batch.size;
+    for (size_t col = 0; col < batch.columns.size(); col++) {
+      auto& column = batch.columns[col];
+      bool projected = projection.empty() || projection[col];
+      switch (column.datatype) {
+      case DataType::INT: {
+        if (projected) {
+          std::memcpy(&column.ints[row], bytes + offset, sizeof(int64_t));
+        }
+        offset += sizeof(int64_t);
+        break;
+      }
+      case DataType::STR: {
+        if (dictionaries[col] != nullptr) {
+          if (projected) {
+            StringDictionary::code_t code;
+            std::memcpy(&code, bytes + offset, sizeof(code));
+            auto& str = dictionaries[col]->decode(code);
+            batch.set_str(col, row, str.data(), str.size());
+          }
+          offset += sizeof(StringDictionary::code_t);
+          break;
+        }
+
+        uint8_t len = static_cast<uint8_t>(bytes[offset]);
+        if (projected) {
+          batch.set_str(col, row, bytes + offset + 1, len);
+        }
+        offset += 1 + len;
+        break;
+      }
+      }
+    }
+    batch.size++;
+  }
+  return dir_pos;
+}
+
+void HeapFilePage::delete_record(int32_t dir_pos) {
+  set_dir(dir_pos, -1);
+}
+
+bool HeapFilePage::try_insert_record(const Record& record, RID* out_record_id) {
+  int32_t needed_record_size = 0;
+  if (codec != nullptr) {
+    needed_record_size = codec->encoded_size(record);
+  } else {
+    for (size_t i = 0; i < record.values.size(); i++) {
+      switch (record.values[i].datatype) {
+      case DataType::INT: {
+        needed_record_size += sizeof(int64_t);
+        break;
+      }
+      case DataType::STR: {
+        if (dictionaries[i] != nullptr) {
+          needed_record_size += sizeof(StringDictionary::code_t);
+        } else {
+          // one additional byte for the strlen at beginning
+          needed_record_size += 1 + strlen(record.values[i].value.as_str);
+        }
+        break;
+      }
+      }
+    }
+  }
 
   int32_t dir_pos = 0;
   auto dir_count = get_dir_count();
@@ -121,7 +277,15 @@ bool HeapFilePage::try_insert_record(const Record& record, RID* out_record_id) {
 
   *out_record_id = RID(page.page_id.page_number, dir_pos);
 
-  for (auto& v : record.values) {
+  if (codec != nullptr) {
+    char record_buf[Page::SIZE];
+    codec->encode(record, record_buf);
+    page.write(offset, needed_record_size, record_buf);
+    return true;
+  }
+
+  for (size_t i = 0; i < record.values.size(); i++) {
+    auto& v = record.values[i];
     switch (v.datatype) {
     case DataType::INT: {
       page.write_int64(offset, v.value.as_int);
@@ -129,7 +293,13 @@ bool HeapFilePage::try_insert_record(const Record& record, RID* out_record_id) {
       break;
     }
     case DataType::STR: {
-      char* str = v.value.as_str;
+      if (dictionaries[i] != nullptr) {
+        page.write_int32(offset, dictionaries[i]->encode(v.value.as_str));
+        offset += sizeof(StringDictionary::code_t);
+        break;
+      }
+
+      const char* str = v.value.as_str;
       uint8_t len = strlen(str);
       page.write_int8(offset, len);
       offset += 1;
@@ -143,13 +313,13 @@ bool HeapFilePage::try_insert_record(const Record& record, RID* out_record_id) {
   return true;
 }
 
-void HeapFilePage::vacuum(const Schema& schema) {
-  char* page_buf = new char[Page::SIZE];
+void HeapFilePage::vacuum(const Schema& schema, Arena& arena) {
+  char* page_buf = arena.allocate_buffer(Page::SIZE);
 
   int32_t dir_count = 0;
   int32_t free_space = Page::SIZE - 2 * sizeof(int32_t);
   auto dirs = reinterpret_cast<int32_t*>(page_buf + 2 * sizeof(int32_t));
-  Record record_buf(schema);
+  Record record_buf(schema, arena);
 
   for (int32_t i = 0; i < get_dir_count(); i++) {
     if (get_dir(i) < 0) {
@@ -165,8 +335,12 @@ void HeapFilePage::vacuum(const Schema& schema) {
         break;
       }
       case DataType::STR: {
-        // one additional byte for the strlen at beginning
-        record_size += 1 + strlen(record_buf.values[i].value.as_str);
+        if (dictionaries[i] != nullptr) {
+          record_size += sizeof(StringDictionary::code_t);
+        } else {
+          // one additional byte for the strlen at beginning
+          record_size += 1 + strlen(record_buf.values[i].value.as_str);
+        }
         break;
       }
       }
@@ -183,5 +357,4 @@ void HeapFilePage::vacuum(const Schema& schema) {
   page.write(0, Page::SIZE, page_buf);
   page.write_int32(0, dir_count);
   page.write_int32(4, free_space);
-  delete[] page_buf;
 }
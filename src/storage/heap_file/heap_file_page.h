@@ -2,37 +2,63 @@
 
 #include <cstdint>
 
-#include "relational_model/record.h"
-#include "storage/heap_file/rid.h"
-#include "storage/page.h"
+#include "storage/heap_file/record_codec.h"
+#include "storage/heap_file/string_dictionary.h"
+#include "storage/heap_file/table_page.h"
 
-class HeapFilePage {
+/*
+  Page layout (TableFormat::ROW):
+  - First we have the directory count (dc)
+  - Then we have the free space
+  - Then we have (dc) directory entries, with the offset of each record (negative if deleted)
+  - Then we have the free space
+  - Then we have the records, each one with all its values serialized together. STR values are stored
+    as (uint8 length, bytes), or as a 4 byte code if the column is dictionary encoded
+ */
+class HeapFilePage : public TablePage {
 public:
-  Page& page;
+  // `codec` may be nullptr, in that case records are serialized looking at the datatype of each value
+  HeapFilePage(
+      FileId file_id,
+      int64_t page_number,
+      const ColumnDictionaries& dictionaries,
+      const RecordCodecDispatch* codec
+  );
 
-  HeapFilePage(FileId file_id, int64_t page_number);
+  bool try_insert_record(const Record& record, RID* out_record_id) override;
 
-  ~HeapFilePage();
+  void vacuum(const Schema& schema, Arena& arena) override;
 
-  // returns true if record was inserted, false if no space available
-  // when the function returns true, the out_record_id is setted
-  bool try_insert_record(const Record& record, RID* out_record_id);
+  using TablePage::get_record;
 
-  void vacuum(const Schema& schema);
+  bool get_record(int32_t dir_pos, Record& out, const std::vector<bool>& projection) const override;
 
-  // returns false if dir_pos is marked as deleted
-  // return true and writes the record in out otherwise
-  bool get_record(int32_t dir_pos, Record& out) const;
+  bool satisfies(int32_t dir_pos, const Schema& schema, const std::vector<ColumnPredicate>& predicates)
+      const override;
 
-  void delete_record(int32_t dir_pos);
+  int32_t append_to_batch(
+      int32_t begin_dir_pos,
+      int32_t end_dir_pos,
+      ColumnBatch& batch,
+      const Schema& schema,
+      const std::vector<bool>& projection,
+      const std::vector<ColumnPredicate>& predicates
+  ) const override;
 
-  int32_t get_dir_count() const;
+  void delete_record(int32_t dir_pos) override;
+
+  int32_t get_dir_count() const override;
 
   int32_t get_free_space() const;
 
   int32_t get_dir(int32_t idx) const;
 
 private:
+  const ColumnDictionaries& dictionaries;
+
+  // specialized codec for the schema of the page, nullptr if there is none
+  const RecordCodecDispatch* const codec;
+
   void set_dir_count(int32_t new_dir_count);
 
   void set_free_space(int32_t new_free_space);
@@ -0,0 +1,367 @@
+#include "pax_page.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "system/system.h"
+
+PaxLayout::PaxLayout(const Schema& schema) {
+  int32_t int_count = 0;
+  int32_t str_count = 0;
+  int32_t code_count = 0;
+  for (const auto& col : schema.columns) {
+    switch (col.datatype) {
+    case DataType::INT: {
+      int_count++;
+      break;
+    }
+    case DataType::STR: {
+      if (col.encoding == ColumnEncoding::DICTIONARY) {
+        code_count++;
+      } else {
+        str_count++;
+      }
+      break;
+    }
+    }
+  }
+
+  // one additional byte for the flag of the slot
+  const int32_t fixed_record_size = int_count * sizeof(int64_t)
+                                  + code_count * sizeof(StringDictionary::code_t)
+                                  + str_count * sizeof(uint16_t) + 1;
+  const int32_t available = Page::SIZE - OFFSET_COLUMNS;
+
+  capacity = available / (fixed_record_size + str_count * (1 + EXPECTED_STRLEN));
+
+  // when possible, make sure a record with the longest strings always fits in an empty page
+  const int32_t max_var_size = str_count * (1 + Value::MAX_STRLEN);
+  if (available - max_var_size >= fixed_record_size) {
+    capacity = std::min(capacity, (available - max_var_size) / fixed_record_size);
+  }
+  capacity = std::max(capacity, 1);
+
+  // INT mini columns go first to keep them aligned
+  column_offsets.resize(schema.columns.size());
+  int32_t offset = OFFSET_COLUMNS;
+  for (size_t i = 0; i < schema.columns.size(); i++) {
+    if (schema.columns[i].datatype == DataType::INT) {
+      column_offsets[i] = offset;
+      offset += capacity * sizeof(int64_t);
+    }
+  }
+  for (size_t i = 0; i < schema.columns.size(); i++) {
+    if (schema.columns[i].encoding == ColumnEncoding::DICTIONARY) {
+      column_offsets[i] = offset;
+      offset += capacity * sizeof(StringDictionary::code_t);
+    }
+  }
+  for (size_t i = 0; i < schema.columns.size(); i++) {
+    if (schema.columns[i].datatype == DataType::STR && schema.columns[i].encoding == ColumnEncoding::PLAIN) {
+      column_offsets[i] = offset;
+      offset += capacity * sizeof(uint16_t);
+    }
+  }
+  flags_offset = offset;
+  fixed_end = flags_offset + capacity;
+}
+
+PaxPage::PaxPage(
+    FileId file_id, int64_t page_number, const PaxLayout& layout, const ColumnDictionaries& dictionaries
+)
+    : TablePage(buffer_mgr.get_page(file_id, page_number)),
+      layout(layout),
+      dictionaries(dictionaries) {
+  // if new page, initialize to be valid
+  // new pages comes with all bytes setted at 0
+  if (get_var_begin() == 0) {
+    page.write_int32(PaxLayout::OFFSET_VAR_BEGIN, Page::SIZE);
+  }
+}
+
+int32_t PaxPage::get_dir_count() const {
+  return page.read_int32(PaxLayout::OFFSET_RECORD_COUNT);
+}
+
+int32_t PaxPage::get_var_begin() const {
+  return page.read_int32(PaxLayout::OFFSET_VAR_BEGIN);
+}
+
+bool PaxPage::is_used(int32_t slot) const {
+  return page.get_bytes()[layout.flags_offset + slot] != 0;
+}
+
+int64_t PaxPage::get_int(size_t col, int32_t slot) const {
+  int64_t res;
+  std::memcpy(&res, page.get_bytes() + layout.column_offsets[col] + slot * sizeof(int64_t), sizeof(int64_t));
+  return res;
+}
+
+StringDictionary::code_t PaxPage::get_code(size_t col, int32_t slot) const {
+  StringDictionary::code_t res;
+  std::memcpy(&res, page.get_bytes() + layout.column_offsets[col] + slot * sizeof(res), sizeof(res));
+  return res;
+}
+
+uint16_t PaxPage::get_str_offset(size_t col, int32_t slot) const {
+  uint16_t offset;
+  std::memcpy(
+      &offset, page.get_bytes() + layout.column_offsets[col] + slot * sizeof(uint16_t), sizeof(uint16_t)
+  );
+  return offset;
+}
+
+bool PaxPage::get_record(int32_t slot, Record& out, const std::vector<bool>& projection) const {
+  if (slot >= get_dir_count() || !is_used(slot)) {
+    return false;
+  }
+
+  for (size_t col = 0; col < out.values.size(); col++) {
+    if (!projection.empty() && !projection[col]) {
+      continue;
+    }
+    auto& v = out.values[col];
+    switch (v.datatype) {
+    case DataType::INT: {
+      v.value.as_int = get_int(col, slot);
+      break;
+    }
+    case DataType::STR: {
+      if (dictionaries[col] != nullptr) {
+        auto& str = dictionaries[col]->decode(get_code(col, slot));
+        v.set_str(str.data(), str.size());
+        break;
+      }
+      auto offset = get_str_offset(col, slot);
+      uint8_t len = page.read_uint8(offset);
+      v.set_str(page.get_bytes() + offset + 1, len);
+      break;
+    }
+    }
+  }
+  return true;
+}
+
+bool PaxPage::satisfies(
+    int32_t slot, const Schema& schema, const std::vector<ColumnPredicate>& predicates
+) const {
+  if (slot >= get_dir_count() || !is_used(slot)) {
+    return false;
+  }
+
+  for (auto& predicate : predicates) {
+    int cmp = 0;
+    switch (schema.columns[predicate.col_idx].datatype) {
+    case DataType::INT: {
+      auto value = get_int(predicate.col_idx, slot);
+      auto constant = predicate.constant.value.as_int;
+      cmp = value < constant ? -1 : (constant < value ? 1 : 0);
+      break;
+    }
+    case DataType::STR: {
+      if (dictionaries[predicate.col_idx] != nullptr) {
+        if (!dictionaries[predicate.col_idx]->matches(predicate, get_code(predicate.col_idx, slot))) {
+          return false;
+        }
+        continue;
+      }
+      auto str = page.get_bytes() + get_str_offset(predicate.col_idx, slot);
+      size_t len = static_cast<uint8_t>(str[0]);
+      const char* constant = predicate.constant.value.as_str;
+      size_t constant_len = strlen(constant);
+      cmp = std::memcmp(str + 1, constant, std::min(len, constant_len));
+      if (cmp == 0) {
+        cmp = len < constant_len ? -1 : (constant_len < len ? 1 : 0);
+      }
+      break;
+    }
+    }
+    if (!compare_matches(predicate.op, cmp)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int32_t PaxPage::append_to_batch(
+    int32_t begin_slot,
+    int32_t end_slot,
+    ColumnBatch& batch,
+    const Schema& schema,
+    const std::vector<bool>& projection,
+    const std::vector<ColumnPredicate>& predicates
+) const {
+  // first select the slots, then copy each mini column at once
+  int32_t selected[ColumnBatch::CAPACITY];
+  size_t selected_count = 0;
+  const size_t room = ColumnBatch::CAPACITY - batch.size;
+
+  end_slot = std::min(end_slot, get_dir_count());
+  int32_t slot = begin_slot;
+  for (; slot < end_slot && selected_count < room; slot++) {
+    if (!is_used(slot)) {
+      continue;
+    }
+    // qualified call to avoid the virtual dispatch
+    if (!predicates.empty() && !PaxPage::satisfies(slot, schema, predicates)) {
+      continue;
+    }
+    selected[selected_count++] = slot;
+  }
+
+  const char* bytes = page.get_bytes();
+  for (size_t col = 0; col < batch.columns.size(); col++) {
+    if (!projection.empty() && !projection[col]) {
+      continue;
+    }
+    auto& column = batch.columns[col];
+    switch (column.datatype) {
+    case DataType::INT: {
+      const char* mini_column = bytes + layout.column_offsets[col];
+      int64_t* dst = column.ints.data() + batch.size;
+      for (size_t i = 0; i < selected_count; i++) {
+        std::memcpy(dst + i, mini_column + selected[i] * sizeof(int64_t), sizeof(int64_t));
+      }
+      break;
+    }
+    case DataType::STR: {
+      if (dictionaries[col] != nullptr) {
+        for (size_t i = 0; i < selected_count; i++) {
+          auto& str = dictionaries[col]->decode(get_code(col, selected[i]));
+          batch.set_str(col, batch.size + i, str.data(), str.size());
+        }
+        break;
+      }
+      for (size_t i = 0; i < selected_count; i++) {
+        auto str = bytes + get_str_offset(col, selected[i]);
+        batch.set_str(col, batch.size + i, str + 1, static_cast<uint8_t>(str[0]));
+      }
+      break;
+    }
+    }
+  }
+  batch.size += selected_count;
+  return slot;
+}
+
+void PaxPage::delete_record(int32_t slot) {
+  page.write_int8(layout.flags_offset + slot, 0);
+}
+
+bool PaxPage::try_insert_record(const Record& record, RID* out_record_id) {
+  auto record_count = get_dir_count();
+
+  // reuse the first deleted slot if any
+  int32_t slot = 0;
+  while (slot < record_count && is_used(slot)) {
+    slot++;
+  }
+  if (slot == layout.capacity) {
+    return false;
+  }
+
+  int32_t needed_var_size = 0;
+  for (size_t col = 0; col < record.values.size(); col++) {
+    auto& v = record.values[col];
+    if (v.datatype == DataType::STR && dictionaries[col] == nullptr) {
+      // one additional byte for the strlen at beginning
+      needed_var_size += 1 + strlen(v.value.as_str);
+    }
+  }
+
+  auto var_begin = get_var_begin();
+  if (var_begin - needed_var_size < layout.fixed_end) {
+    return false;
+  }
+
+  for (size_t col = 0; col < record.values.size(); col++) {
+    auto& v = record.values[col];
+    switch (v.datatype) {
+    case DataType::INT: {
+      page.write_int64(layout.column_offsets[col] + slot * sizeof(int64_t), v.value.as_int);
+      break;
+    }
+    case DataType::STR: {
+      if (dictionaries[col] != nullptr) {
+        auto code = dictionaries[col]->encode(v.value.as_str);
+        page.write(
+            layout.column_offsets[col] + slot * sizeof(code), sizeof(code), reinterpret_cast<char*>(&code)
+        );
+        break;
+      }
+      const char* str = v.value.as_str;
+      uint8_t len = strlen(str);
+      var_begin -= 1 + len;
+      page.write_int8(var_begin, len);
+      page.write(var_begin + 1, len, str);
+
+      uint16_t offset = var_begin;
+      page.write(
+          layout.column_offsets[col] + slot * sizeof(uint16_t),
+          sizeof(uint16_t),
+          reinterpret_cast<char*>(&offset)
+      );
+      break;
+    }
+    }
+  }
+
+  page.write_int8(layout.flags_offset + slot, 1);
+  page.write_int32(PaxLayout::OFFSET_VAR_BEGIN, var_begin);
+  if (slot == record_count) {
+    page.write_int32(PaxLayout::OFFSET_RECORD_COUNT, record_count + 1);
+  }
+
+  *out_record_id = RID(page.page_id.page_number, slot);
+  return true;
+}
+
+void PaxPage::vacuum(const Schema& schema, Arena& arena) {
+  char* page_buf = arena.allocate_buffer(Page::SIZE);
+  std::memset(page_buf, 0, Page::SIZE);
+
+  int32_t record_count = 0;
+  int32_t var_begin = Page::SIZE;
+
+  for (int32_t slot = 0; slot < get_dir_count(); slot++) {
+    if (!is_used(slot)) {
+      continue;
+    }
+
+    for (size_t col = 0; col < schema.columns.size(); col++) {
+      switch (schema.columns[col].datatype) {
+      case DataType::INT: {
+        int64_t value = get_int(col, slot);
+        std::memcpy(
+            page_buf + layout.column_offsets[col] + record_count * sizeof(int64_t), &value, sizeof(int64_t)
+        );
+        break;
+      }
+      case DataType::STR: {
+        if (dictionaries[col] != nullptr) {
+          auto code = get_code(col, slot);
+          auto code_offset = layout.column_offsets[col] + record_count * sizeof(code);
+          std::memcpy(page_buf + code_offset, &code, sizeof(code));
+          break;
+        }
+        auto str = page.get_bytes() + get_str_offset(col, slot);
+        uint8_t len = static_cast<uint8_t>(str[0]);
+        var_begin -= 1 + len;
+        std::memcpy(page_buf + var_begin, str, 1 + len);
+
+        uint16_t offset = var_begin;
+        std::memcpy(
+            page_buf + layout.column_offsets[col] + record_count * sizeof(uint16_t), &offset, sizeof(uint16_t)
+        );
+        break;
+      }
+      }
+    }
+    page_buf[layout.flags_offset + record_count] = 1;
+    record_count++;
+  }
+
+  page.write(0, Page::SIZE, page_buf);
+  page.write_int32(PaxLayout::OFFSET_RECORD_COUNT, record_count);
+  page.write_int32(PaxLayout::OFFSET_VAR_BEGIN, var_begin);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "relational_model/schema.h"
+#include "storage/heap_file/string_dictionary.h"
+#include "storage/heap_file/table_page.h"
+
+// Positions of each mini column inside a PaxPage. It only depends on the schema, so it is computed once
+// per HeapFile.
+struct PaxLayout {
+  static constexpr int32_t OFFSET_RECORD_COUNT = 0;
+
+  static constexpr int32_t OFFSET_VAR_BEGIN = sizeof(int32_t);
+
+  static constexpr int32_t OFFSET_COLUMNS = 2 * sizeof(int32_t);
+
+  // expected average length of STR values, used to split the page between fixed and variable size data
+  static constexpr int32_t EXPECTED_STRLEN = 16;
+
+  // max records per page
+  int32_t capacity;
+
+  // start of the mini column of each column
+  std::vector<int32_t> column_offsets;
+
+  // start of the array of flags (1 byte per slot, 0 means deleted)
+  int32_t flags_offset;
+
+  // strings are stored in the range [fixed_end, Page::SIZE), growing from the end of the page
+  int32_t fixed_end;
+
+  PaxLayout(const Schema& schema);
+};
+
+/*
+  Page layout (TableFormat::PAX):
+  - First we have the record count (rc), slots in [0, rc) are used or deleted
+  - Then we have the start of the variable size area
+  - Then we have the INT mini columns, `capacity` int64 values each
+  - Then we have the dictionary encoded STR mini columns, `capacity` 4 byte codes each
+  - Then we have the STR mini columns, `capacity` uint16 offsets each, pointing to the variable size area
+  - Then we have `capacity` flags telling if each slot has a record
+  - Then we have the free space
+  - Then we have the variable size area, with strings stored as (uint8 length, bytes)
+ */
+class PaxPage : public TablePage {
+public:
+  PaxPage(
+      FileId file_id, int64_t page_number, const PaxLayout& layout, const ColumnDictionaries& dictionaries
+  );
+
+  bool try_insert_record(const Record& record, RID* out_record_id) override;
+
+  void vacuum(const Schema& schema, Arena& arena) override;
+
+  using TablePage::get_record;
+
+  bool get_record(int32_t slot, Record& out, const std::vector<bool>& projection) const override;
+
+  bool satisfies(int32_t slot, const Schema& schema, const std::vector<ColumnPredicate>& predicates)
+      const override;
+
+  int32_t append_to_batch(
+      int32_t begin_slot,
+      int32_t end_slot,
+      ColumnBatch& batch,
+      const Schema& schema,
+      const std::vector<bool>& projection,
+      const std::vector<ColumnPredicate>& predicates
+  ) const override;
+
+  void delete_record(int32_t slot) override;
+
+  int32_t get_dir_count() const override;
+
+private:
+  const PaxLayout& layout;
+
+  const ColumnDictionaries& dictionaries;
+
+  int32_t get_var_begin() const;
+
+  bool is_used(int32_t slot) const;
+
+  int64_t get_int(size_t col, int32_t slot) const;
+
+  StringDictionary::code_t get_code(size_t col, int32_t slot) const;
+
+  // returns the offset of the length of the string, followed by its bytes
+  uint16_t get_str_offset(size_t col, int32_t slot) const;
+};
@@ -0,0 +1,69 @@
+#include "record_codec.h"
+
+#include <array>
+#include <utility>
+
+// Column i of the codec built for `Mask` is STR if the bit i of the mask is set, INT otherwise
+template <size_t Mask, size_t... Is>
+static constexpr RecordCodecDispatch make_codec(std::index_sequence<Is...>) {
+  return RecordCodecDispatch::of<RecordCodec<((Mask >> Is) & 1 ? DataType::STR : DataType::INT)...>>();
+}
+
+// one codec for every combination of datatypes of N columns
+template <size_t N, size_t... Masks>
+static constexpr std::array<RecordCodecDispatch, sizeof...(Masks)>
+make_mixed_codecs(std::index_sequence<Masks...>) {
+  return {make_codec<Masks>(std::make_index_sequence<N>{})...};
+}
+
+// codecs for N INT columns, for N in [1, sizeof...(Ns)]
+template <size_t... Ns>
+static constexpr std::array<RecordCodecDispatch, sizeof...(Ns)> make_int_codecs(std::index_sequence<Ns...>) {
+  return {make_codec<0>(std::make_index_sequence<Ns + 1>{})...};
+}
+
+static constexpr auto mixed_codecs_1 = make_mixed_codecs<1>(std::make_index_sequence<1 << 1>{});
+static constexpr auto mixed_codecs_2 = make_mixed_codecs<2>(std::make_index_sequence<1 << 2>{});
+static constexpr auto mixed_codecs_3 = make_mixed_codecs<3>(std::make_index_sequence<1 << 3>{});
+static constexpr auto mixed_codecs_4 = make_mixed_codecs<4>(std::make_index_sequence<1 << 4>{});
+
+static_assert(RecordCodecDispatch::MAX_MIXED_COLUMNS == 4, "a table of codecs is needed for each size");
+
+static_assert(RecordCodecDispatch::MAX_INT_COLUMNS >= RecordCodecDispatch::MAX_MIXED_COLUMNS);
+
+static constexpr auto int_codecs =
+    make_int_codecs(std::make_index_sequence<RecordCodecDispatch::MAX_INT_COLUMNS>{});
+
+const RecordCodecDispatch* get_record_codec(const Schema& schema) {
+  const auto column_count = schema.columns.size();
+  if (column_count == 0 || column_count > RecordCodecDispatch::MAX_INT_COLUMNS) {
+    return nullptr;
+  }
+
+  size_t mask = 0;
+  for (size_t i = 0; i < column_count; i++) {
+    if (schema.columns[i].encoding != ColumnEncoding::PLAIN) {
+      return nullptr;
+    }
+    if (schema.columns[i].datatype == DataType::STR) {
+      mask |= size_t(1) << i;
+    }
+  }
+
+  if (mask == 0) {
+    return &int_codecs[column_count - 1];
+  }
+
+  switch (column_count) {
+  case 1:
+    return &mixed_codecs_1[mask];
+  case 2:
+    return &mixed_codecs_2[mask];
+  case 3:
+    return &mixed_codecs_3[mask];
+  case 4:
+    return &mixed_codecs_4[mask];
+  default:
+    return nullptr;
+  }
+}
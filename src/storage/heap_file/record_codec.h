@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "relational_model/column_batch.h"
+#include "relational_model/record.h"
+#include "relational_model/schema.h"
+
+// Serializes records of a schema known at compile time, with the same format used by HeapFilePage:
+// INT as 8 bytes and STR as (uint8 length, bytes). The datatype of each column is resolved at compile
+// time, so there is no branching per column, and the offsets of the columns before the first STR are
+// constants. When all columns are INT the record has a fixed size and no length is parsed at all.
+//
+// Example: RecordCodec<DataType::INT, DataType::STR, DataType::INT>
+template <DataType... Types>
+struct RecordCodec {
+  static constexpr size_t column_count = sizeof...(Types);
+
+  static constexpr bool all_int = ((Types == DataType::INT) && ...);
+
+  // only meaningful if all_int
+  static constexpr int32_t fixed_size = column_count * sizeof(int64_t);
+
+  static void decode(const char* bytes, Record& out) {
+    decode_column<0, Types...>(bytes, out.values.data());
+  }
+
+  // writes the record as the row batch.size of the batch, without incrementing batch.size
+  static void decode_to_batch(const char* bytes, ColumnBatch& batch) {
+    decode_batch_column<0, Types...>(bytes, batch);
+  }
+
+  static int32_t encoded_size(const Record& record) {
+    if constexpr (all_int) {
+      return fixed_size;
+    } else {
+      return size_column<0, Types...>(record.values.data());
+    }
+  }
+
+  static void encode(const Record& record, char* bytes) {
+    encode_column<0, Types...>(record.values.data(), bytes);
+  }
+
+private:
+  template <size_t I, DataType T, DataType... Rest>
+  static void decode_column(const char* bytes, Value* values) {
+    if constexpr (T == DataType::INT) {
+      std::memcpy(&values[I].value.as_int, bytes, sizeof(int64_t));
+      bytes += sizeof(int64_t);
+    } else {
+      uint8_t len = static_cast<uint8_t>(*bytes);
+      values[I].set_str(bytes + 1, len);
+      bytes += 1 + len;
+    }
+    if constexpr (sizeof...(Rest) > 0) {
+      decode_column<I + 1, Rest...>(bytes, values);
+    }
+  }
+
+  template <size_t I, DataType T, DataType... Rest>
+  static void decode_batch_column(const char* bytes, ColumnBatch& batch) {
+    if constexpr (T == DataType::INT) {
+      std::memcpy(&batch.columns[I].ints[batch.size], bytes, sizeof(int64_t));
+      bytes += sizeof(int64_t);
+    } else {
+      uint8_t len = static_cast<uint8_t>(*bytes);
+      batch.set_str(I, batch.size, bytes + 1, len);
+      bytes += 1 + len;
+    }
+    if constexpr (sizeof...(Rest) > 0) {
+      decode_batch_column<I + 1, Rest...>(bytes, batch);
+    }
+  }
+
+  template <size_t I, DataType T, DataType... Rest>
+  static int32_t size_column(const Value* values) {
+    int32_t size;
+    if constexpr (T == DataType::INT) {
+      size = sizeof(int64_t);
+    } else {
+      // one additional byte for the strlen at beginning
+      size = 1 + std::strlen(values[I].value.as_str);
+    }
+    if constexpr (sizeof...(Rest) > 0) {
+      return size + size_column<I + 1, Rest...>(values);
+    } else {
+      return size;
+    }
+  }
+
+  template <size_t I, DataType T, DataType... Rest>
+  static void encode_column(const Value* values, char* bytes) {
+    if constexpr (T == DataType::INT) {
+      std::memcpy(bytes, &values[I].value.as_int, sizeof(int64_t));
+      bytes += sizeof(int64_t);
+    } else {
+      uint8_t len = std::strlen(values[I].value.as_str);
+      *bytes = static_cast<char>(len);
+      std::memcpy(bytes + 1, values[I].value.as_str, len);
+      bytes += 1 + len;
+    }
+    if constexpr (sizeof...(Rest) > 0) {
+      encode_column<I + 1, Rest...>(values, bytes);
+    }
+  }
+};
+
+// Type erased RecordCodec instance, so a specialized codec can be selected at runtime
+struct RecordCodecDispatch {
+  static constexpr size_t MAX_MIXED_COLUMNS = 4;
+
+  static constexpr size_t MAX_INT_COLUMNS = 16;
+
+  void (*decode)(const char* bytes, Record& out);
+
+  void (*decode_to_batch)(const char* bytes, ColumnBatch& batch);
+
+  int32_t (*encoded_size)(const Record& record);
+
+  void (*encode)(const Record& record, char* bytes);
+
+  template <class Codec>
+  static constexpr RecordCodecDispatch of() {
+    return {&Codec::decode, &Codec::decode_to_batch, &Codec::encoded_size, &Codec::encode};
+  }
+};
+
+// Returns the specialized codec matching the datatypes of the schema, or nullptr if there is none and
+// the generic path has to be used. Specializations exist for every schema up to
+// RecordCodecDispatch::MAX_MIXED_COLUMNS columns and for INT only schemas up to MAX_INT_COLUMNS columns.
+// Schemas with dictionary encoded columns are never specialized.
+const RecordCodecDispatch* get_record_codec(const Schema& schema);
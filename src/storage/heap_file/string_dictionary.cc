@@ -0,0 +1,88 @@
+#include "string_dictionary.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "system/system.h"
+
+StringDictionary::StringDictionary(const std::string& filename) {
+  auto file_path = file_mgr.get_file_path(filename);
+  file.open(file_path, std::ios::out | std::ios::app);
+  if (file.fail()) {
+    throw std::runtime_error("Could not open file " + filename);
+  }
+  file.close();
+  file.open(file_path, std::ios::in | std::ios::out | std::ios::binary);
+
+  char buf[Value::MAX_STRLEN];
+  while (true) {
+    auto len = file.get();
+    if (len == std::char_traits<char>::eof()) {
+      break;
+    }
+    file.read(buf, len);
+    if (!file.good()) {
+      throw std::runtime_error("Error reading dictionary " + filename);
+    }
+    auto& str = strings.emplace_back(buf, len);
+    codes.insert({str, strings.size() - 1});
+  }
+  // clear the eof flag and move to the end to append new strings
+  file.clear();
+  file.seekp(0, file.end);
+}
+
+StringDictionary::~StringDictionary() {
+  file.close();
+}
+
+StringDictionary::code_t StringDictionary::encode(std::string_view str) {
+  auto found = codes.find(str);
+  if (found != codes.end()) {
+    return found->second;
+  }
+
+  code_t code = strings.size();
+  auto& new_str = strings.emplace_back(str);
+  codes.insert({new_str, code});
+
+  file.put(static_cast<char>(str.size()));
+  file.write(str.data(), str.size());
+  return code;
+}
+
+bool StringDictionary::find(std::string_view str, code_t* out) const {
+  auto found = codes.find(str);
+  if (found != codes.end()) {
+    *out = found->second;
+    return true;
+  }
+  return false;
+}
+
+void StringDictionary::bind(ColumnPredicate& predicate) const {
+  const char* constant = predicate.constant.value.as_str;
+  code_t code;
+  if (predicate.op == CompareOp::EQ || predicate.op == CompareOp::NE) {
+    // no need to compare the strings
+    bool is_eq = predicate.op == CompareOp::EQ;
+    predicate.matching_codes.assign(strings.size(), !is_eq);
+    if (find(constant, &code)) {
+      predicate.matching_codes[code] = is_eq;
+    }
+    return;
+  }
+
+  predicate.matching_codes.resize(strings.size());
+  for (size_t i = 0; i < strings.size(); i++) {
+    predicate.matching_codes[i] = compare_matches(predicate.op, std::strcmp(strings[i].c_str(), constant));
+  }
+}
+
+bool StringDictionary::matches(const ColumnPredicate& predicate, code_t code) const {
+  if (code < predicate.matching_codes.size()) {
+    return predicate.matching_codes[code];
+  }
+  // the string was added after the predicate was bound
+  return compare_matches(predicate.op, std::strcmp(strings[code].c_str(), predicate.constant.value.as_str));
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "relational_model/column_predicate.h"
+
+// Maps the distinct strings of a dictionary encoded column to dense integer codes. Codes are assigned
+// in insertion order and never change. The dictionary is persisted in its own file, appending each new
+// string as (uint8 length, bytes), so the position of a string in the file is its code.
+class StringDictionary {
+public:
+  using code_t = uint32_t;
+
+  StringDictionary(const std::string& filename);
+
+  ~StringDictionary();
+
+  // prevent accidental copies
+  StringDictionary(const StringDictionary& other) = delete;
+
+  // returns the code of `str`, adding it to the dictionary if it is new
+  code_t encode(std::string_view str);
+
+  // returns false if `str` is not in the dictionary
+  bool find(std::string_view str, code_t* out) const;
+
+  const std::string& decode(code_t code) const {
+    return strings[code];
+  }
+
+  size_t size() const {
+    return strings.size();
+  }
+
+  // Evaluates the predicate (over a column encoded with this dictionary) once for every string,
+  // setting `predicate.matching_codes`. Records can then be filtered only looking at their codes
+  void bind(ColumnPredicate& predicate) const;
+
+  // Evaluates a predicate bound with `bind` for a record whose column has `code`
+  bool matches(const ColumnPredicate& predicate, code_t code) const;
+
+private:
+  std::fstream file;
+
+  // deque is used so the strings are never moved, and the string_views in `codes` remain valid
+  std::deque<std::string> strings;
+
+  std::unordered_map<std::string_view, code_t> codes;
+};
+
+// One dictionary per column of a table, nullptr for the columns that are not dictionary encoded
+using ColumnDictionaries = std::vector<std::unique_ptr<StringDictionary>>;
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "relational_model/column_batch.h"
+#include "relational_model/column_predicate.h"
+#include "relational_model/record.h"
+#include "storage/heap_file/rid.h"
+#include "storage/page.h"
+#include "system/arena.h"
+
+// ROW stores whole records together (see HeapFilePage).
+// PAX stores the values of each column together inside the page (see PaxPage).
+enum class TableFormat { ROW, PAX };
+
+// Common interface of the page layouts a HeapFile can use. Records inside a page are addressed by a slot
+// number, so RID(page_number, slot) is valid for every format.
+// The page is pinned while this object is alive.
+class TablePage {
+public:
+  Page& page;
+
+  TablePage(Page& page)
+      : page(page) {}
+
+  virtual ~TablePage() {
+    page.unpin();
+  }
+
+  // prevent accidental copies
+  TablePage(const TablePage& other) = delete;
+
+  // returns true if record was inserted, false if no space available
+  // when the function returns true, the out_record_id is setted
+  virtual bool try_insert_record(const Record& record, RID* out_record_id) = 0;
+
+  // temporary buffers are allocated in the arena
+  virtual void vacuum(const Schema& schema, Arena& arena) = 0;
+
+  // returns false if slot is marked as deleted
+  // return true and writes the columns marked in `projection` into out otherwise.
+  // An empty projection means all columns, other columns of out are not modified
+  virtual bool get_record(int32_t slot, Record& out, const std::vector<bool>& projection) const = 0;
+
+  bool get_record(int32_t slot, Record& out) const {
+    return get_record(slot, out, {});
+  }
+
+  // returns true if the record at slot is not deleted and satisfies all the predicates.
+  // The predicates are evaluated over the serialized bytes, without materializing the record.
+  // `predicates` must be sorted by col_idx and each constant must have the datatype of its column
+  virtual bool
+  satisfies(int32_t slot, const Schema& schema, const std::vector<ColumnPredicate>& predicates) const = 0;
+
+  // Appends to the batch the records in slots [begin_slot, end_slot) that are not deleted and satisfy all
+  // the predicates (same requirements as satisfies), stopping when the batch is full.
+  // Only the columns marked in `projection` are written (all of them if it is empty).
+  // Returns the slot following the last one read.
+  virtual int32_t append_to_batch(
+      int32_t begin_slot,
+      int32_t end_slot,
+      ColumnBatch& batch,
+      const Schema& schema,
+      const std::vector<bool>& projection,
+      const std::vector<ColumnPredicate>& predicates
+  ) const = 0;
+
+  virtual void delete_record(int32_t slot) = 0;
+
+  // returns the number of slots used in the page, including deleted records
+  virtual int32_t get_dir_count() const = 0;
+};
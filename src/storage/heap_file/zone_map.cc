@@ -0,0 +1,179 @@
+#include "zone_map.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "relational_model/key_encoding.h"
+#include "storage/heap_file/table_page.h"
+#include "system/system.h"
+
+ZoneMap::ZoneMap(const Schema& schema, const std::string& filename)
+    : schema(schema),
+      file_id(file_mgr.get_file_id(filename)),
+      entry_size(sizeof(int64_t) + 2 * sizeof(int64_t) * schema.columns.size()),
+      entries_per_page(Page::SIZE / entry_size),
+      record_buf(schema) {}
+
+int64_t ZoneMap::encode_string_prefix(const char* str) {
+  return KeyEncoding::prefix64(str, std::strlen(str));
+}
+
+int64_t ZoneMap::encode(const Value& value) const {
+  switch (value.datatype) {
+  case DataType::INT:
+    return value.value.as_int;
+  case DataType::STR:
+    return encode_string_prefix(value.value.as_str);
+  }
+  return 0; // unreachable
+}
+
+int64_t ZoneMap::get_state(int64_t page_number) const {
+  if (entries_per_page == 0) {
+    return UNKNOWN;
+  }
+  auto& page = buffer_mgr.get_page(file_id, page_number / entries_per_page);
+  auto state = page.read_int64((page_number % entries_per_page) * entry_size);
+  page.unpin();
+  return state;
+}
+
+void ZoneMap::update(int64_t page_number, const Record& record, bool only_record) {
+  if (entries_per_page == 0) {
+    return;
+  }
+  auto& page = buffer_mgr.get_page(file_id, page_number / entries_per_page);
+  size_t offset = (page_number % entries_per_page) * entry_size;
+  auto state = page.read_int64(offset);
+
+  if (only_record) {
+    page.write_int64(offset, VALID);
+    for (size_t col = 0; col < record.values.size(); col++) {
+      auto encoded = encode(record.values[col]);
+      page.write_int64(offset + (1 + 2 * col) * sizeof(int64_t), encoded);
+      page.write_int64(offset + (2 + 2 * col) * sizeof(int64_t), encoded);
+    }
+  } else if (state != UNKNOWN) {
+    // widen the bounds, the state is kept
+    for (size_t col = 0; col < record.values.size(); col++) {
+      auto encoded = encode(record.values[col]);
+      auto min_offset = offset + (1 + 2 * col) * sizeof(int64_t);
+      auto max_offset = min_offset + sizeof(int64_t);
+      if (encoded < page.read_int64(min_offset)) {
+        page.write_int64(min_offset, encoded);
+      }
+      if (encoded > page.read_int64(max_offset)) {
+        page.write_int64(max_offset, encoded);
+      }
+    }
+  }
+  page.unpin();
+}
+
+void ZoneMap::mark_stale(int64_t page_number) {
+  if (entries_per_page == 0) {
+    return;
+  }
+  auto& page = buffer_mgr.get_page(file_id, page_number / entries_per_page);
+  size_t offset = (page_number % entries_per_page) * entry_size;
+  if (page.read_int64(offset) == VALID) {
+    page.write_int64(offset, STALE);
+  }
+  page.unpin();
+}
+
+void ZoneMap::rebuild(const TablePage& heap_page) {
+  if (entries_per_page == 0) {
+    return;
+  }
+  auto page_number = heap_page.page.get_page_number();
+  auto& page = buffer_mgr.get_page(file_id, page_number / entries_per_page);
+  size_t offset = (page_number % entries_per_page) * entry_size;
+
+  // an empty page ends with min > max, and every scan will skip it
+  for (size_t col = 0; col < schema.columns.size(); col++) {
+    page.write_int64(offset + (1 + 2 * col) * sizeof(int64_t), INT64_MAX);
+    page.write_int64(offset + (2 + 2 * col) * sizeof(int64_t), INT64_MIN);
+  }
+  page.write_int64(offset, VALID);
+  page.unpin();
+
+  auto dir_count = heap_page.get_dir_count();
+  for (int32_t i = 0; i < dir_count; i++) {
+    if (heap_page.get_record(i, record_buf)) {
+      update(page_number, record_buf, false);
+    }
+  }
+}
+
+bool ZoneMap::can_skip(const char* entry, const std::vector<ColumnPredicate>& predicates) const {
+  int64_t state;
+  std::memcpy(&state, entry, sizeof(int64_t));
+  if (state == UNKNOWN) {
+    return false;
+  }
+
+  for (auto& predicate : predicates) {
+    int64_t min, max;
+    std::memcpy(&min, entry + (1 + 2 * predicate.col_idx) * sizeof(int64_t), sizeof(int64_t));
+    std::memcpy(&max, entry + (2 + 2 * predicate.col_idx) * sizeof(int64_t), sizeof(int64_t));
+
+    if (min > max) {
+      return true; // page without records
+    }
+
+    // for strings only the prefix is known, so bounds equal to the constant prefix can't be discarded
+    bool exact = predicate.constant.datatype == DataType::INT;
+    auto c = encode(predicate.constant);
+
+    bool skip = false;
+    switch (predicate.op) {
+    case CompareOp::EQ:
+      skip = c < min || c > max;
+      break;
+    case CompareOp::NE:
+      skip = exact && min == c && max == c;
+      break;
+    case CompareOp::LT:
+      skip = exact ? min >= c : min > c;
+      break;
+    case CompareOp::LE:
+      skip = min > c;
+      break;
+    case CompareOp::GT:
+      skip = exact ? max <= c : max < c;
+      break;
+    case CompareOp::GE:
+      skip = max < c;
+      break;
+    }
+    if (skip) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int64_t ZoneMap::next_candidate_page(
+    int64_t page_number, int64_t total_pages, const std::vector<ColumnPredicate>& predicates
+) const {
+  if (entries_per_page == 0 || predicates.empty()) {
+    return page_number;
+  }
+
+  while (page_number < total_pages) {
+    // check all the entries stored in the same zone map page
+    auto& page = buffer_mgr.get_page(file_id, page_number / entries_per_page);
+    const char* bytes = page.get_bytes();
+    auto group_end = std::min(total_pages, (page_number / entries_per_page + 1) * entries_per_page);
+
+    for (; page_number < group_end; page_number++) {
+      if (!can_skip(bytes + (page_number % entries_per_page) * entry_size, predicates)) {
+        page.unpin();
+        return page_number;
+      }
+    }
+    page.unpin();
+  }
+  return total_pages;
+}
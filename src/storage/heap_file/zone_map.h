@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "relational_model/column_predicate.h"
+#include "relational_model/record.h"
+#include "storage/file_id.h"
+
+class TablePage;
+
+/*
+  Keeps the minimum and maximum value of every column for each page of a heap file, so filtered scans
+  can skip pages that cannot contain matching records. STR columns are summarized by their 8 byte prefix.
+
+  The zone map is persisted in its own file, with one fixed size entry per heap page:
+  - First we have the state of the entry (int64)
+  - Then we have (min, max) for each column (int64 each)
+ */
+class ZoneMap {
+public:
+  // the page was never summarized (e.g. it was written before the zone map existed), it can't be skipped
+  static constexpr int64_t UNKNOWN = 0;
+
+  // min/max are exact
+  static constexpr int64_t VALID = 1;
+
+  // records were deleted since the entry was computed. min/max are still a safe bound, but may be loose
+  static constexpr int64_t STALE = 2;
+
+  ZoneMap(const Schema& schema, const std::string& filename);
+
+  // prevent accidental copies
+  ZoneMap(const ZoneMap& other) = delete;
+
+  // must be called after `record` was inserted in the heap page `page_number`.
+  // `only_record` means the page did not have other (non-deleted) records before the insertion
+  void update(int64_t page_number, const Record& record, bool only_record);
+
+  void mark_stale(int64_t page_number);
+
+  // recomputes the entry of the page reading all its records, the entry becomes VALID
+  void rebuild(const TablePage& page);
+
+  int64_t get_state(int64_t page_number) const;
+
+  // returns the lowest page number in [page_number, total_pages) that may contain records satisfying all
+  // the predicates, or total_pages if there is no such page.
+  // `predicates` must have been validated against the schema
+  int64_t next_candidate_page(
+      int64_t page_number, int64_t total_pages, const std::vector<ColumnPredicate>& predicates
+  ) const;
+
+  // order preserving int64 encoding of the first 8 bytes of a string
+  static int64_t encode_string_prefix(const char* str);
+
+private:
+  const Schema& schema;
+
+  const FileId file_id;
+
+  const int64_t entry_size;
+
+  // 0 if the schema has too many columns to fit an entry in a page, in that case the zone map is disabled
+  const int64_t entries_per_page;
+
+  // reused when rebuilding an entry to avoid allocations
+  Record record_buf;
+
+  int64_t encode(const Value& value) const;
+
+  bool can_skip(const char* entry, const std::vector<ColumnPredicate>& predicates) const;
+};
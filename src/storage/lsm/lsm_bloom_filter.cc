@@ -0,0 +1,15 @@
+#include "lsm_bloom_filter.h"
+
+uint64_t LSMBloomFilter::hash(const char* key, size_t size) {
+  // FNV-1a, followed by the finalizer of MurmurHash3 so every bit depends on every byte
+  uint64_t hash = UINT64_C(14695981039346656037);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ static_cast<unsigned char>(key[i])) * UINT64_C(1099511628211);
+  }
+  hash ^= hash >> 33;
+  hash *= UINT64_C(0xff51afd7ed558ccd);
+  hash ^= hash >> 33;
+  hash *= UINT64_C(0xc4ceb9fe1a85ec53);
+  hash ^= hash >> 33;
+  return hash;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "storage/page.h"
+
+// Bloom filter over the keys of a run (see LSMRun), so equality lookups skip the runs not having the key.
+// Its bits are stored in whole pages of the run file.
+class LSMBloomFilter {
+public:
+  static constexpr size_t BITS_PER_KEY = 10;
+
+  // with BITS_PER_KEY, about 1% of the lookups of a missing key read the run
+  static constexpr uint32_t HASH_COUNT = 7;
+
+  static constexpr size_t WORDS_PER_PAGE = Page::SIZE / sizeof(uint64_t);
+
+  // hash of an encoded key
+  static uint64_t hash(const char* key, size_t size);
+
+  // returns the pages needed for a filter of `key_count` keys
+  static int64_t get_page_count(size_t key_count) {
+    auto bits = key_count * BITS_PER_KEY;
+    auto bits_per_page = WORDS_PER_PAGE * 64;
+    return static_cast<int64_t>((bits + bits_per_page - 1) / bits_per_page);
+  }
+
+  // a filter with all bits at 0 using `page_count` pages
+  LSMBloomFilter(int64_t page_count)
+      : words(page_count * WORDS_PER_PAGE) {}
+
+  void add(uint64_t key_hash) {
+    auto h1 = static_cast<uint32_t>(key_hash);
+    auto h2 = static_cast<uint32_t>(key_hash >> 32);
+    for (uint32_t i = 0; i < HASH_COUNT; i++) {
+      auto bit = (h1 + i * h2) % (words.size() * 64);
+      words[bit / 64] |= UINT64_C(1) << (bit % 64);
+    }
+  }
+
+  // false if no key with this hash was added
+  bool may_contain(uint64_t key_hash) const {
+    if (words.empty()) {
+      return false;
+    }
+    auto h1 = static_cast<uint32_t>(key_hash);
+    auto h2 = static_cast<uint32_t>(key_hash >> 32);
+    for (uint32_t i = 0; i < HASH_COUNT; i++) {
+      auto bit = (h1 + i * h2) % (words.size() * 64);
+      if ((words[bit / 64] & (UINT64_C(1) << (bit % 64))) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // stored as they are in the pages of the filter
+  std::vector<uint64_t> words;
+};
@@ -0,0 +1,28 @@
+#include "lsm_cursor.h"
+
+LSMMerge::LSMMerge(std::vector<std::unique_ptr<LSMCursor>> cursors)
+    : cursors(std::move(cursors)),
+      current(-1) {}
+
+bool LSMMerge::next() {
+  if (current >= 0) {
+    // older copies of the current entry are skipped, the current cursor moves last because the others are
+    // compared against its entry
+    auto entry = cursors[current]->get_entry();
+    for (size_t i = current + 1; i < cursors.size(); i++) {
+      if (cursors[i]->valid() && cursors[i]->get_entry() == entry) {
+        cursors[i]->next();
+      }
+    }
+    cursors[current]->next();
+  }
+
+  // when several cursors have the smallest entry, the first one (the newest) is taken
+  current = -1;
+  for (size_t i = 0; i < cursors.size(); i++) {
+    if (cursors[i]->valid() && (current < 0 || cursors[i]->get_entry() < cursors[current]->get_entry())) {
+      current = i;
+    }
+  }
+  return current >= 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Entries of a sorted source of an LSMIndex (the memtable or a run), in order. Each entry is the encoded
+// key followed by the RID, and deleted entries are kept to hide the same entry in older sources.
+class LSMCursor {
+public:
+  virtual ~LSMCursor() = default;
+
+  // false when there are no more entries
+  virtual bool valid() const = 0;
+
+  // only valid until next() is called
+  virtual std::string_view get_entry() const = 0;
+
+  virtual bool is_deleted() const = 0;
+
+  virtual void next() = 0;
+};
+
+// Cursor over a copy of a part of the memtable
+class LSMMemtableCursor : public LSMCursor {
+public:
+  // entries must be sorted, the second value tells if the entry is deleted
+  LSMMemtableCursor(std::vector<std::pair<std::string, bool>> entries)
+      : entries(std::move(entries)),
+        pos(0) {}
+
+  bool valid() const override {
+    return pos < entries.size();
+  }
+
+  std::string_view get_entry() const override {
+    return entries[pos].first;
+  }
+
+  bool is_deleted() const override {
+    return entries[pos].second;
+  }
+
+  void next() override {
+    pos++;
+  }
+
+private:
+  std::vector<std::pair<std::string, bool>> entries;
+
+  size_t pos;
+};
+
+// Merges sorted sources, returning each entry once: when it is in several sources, from the newest one.
+class LSMMerge {
+public:
+  // cursors must be ordered from the newest source to the oldest one
+  LSMMerge(std::vector<std::unique_ptr<LSMCursor>> cursors);
+
+  // moves to the next entry, returns false if there are no more entries
+  bool next();
+
+  // the current entry, only valid until next() is called
+  std::string_view get_entry() const {
+    return cursors[current]->get_entry();
+  }
+
+  bool is_deleted() const {
+    return cursors[current]->is_deleted();
+  }
+
+private:
+  std::vector<std::unique_ptr<LSMCursor>> cursors;
+
+  // position in cursors of the current entry, -1 before the first call to next()
+  int64_t current;
+};
@@ -0,0 +1,385 @@
+#include "lsm_index.h"
+
+#include <algorithm>
+
+#include "relational_model/key_encoding.h"
+#include "storage/b_plus_tree/b_plus_tree_utils.h"
+#include "storage/heap_file/heap_file.h"
+#include "storage/lsm/lsm_index_iter.h"
+#include "system/system.h"
+
+// values of each run in the manifest: id, level, data pages, Bloom filter pages and entries
+static constexpr size_t MANIFEST_RUN_VALUES = 5;
+
+// returns the size of the key at the beginning of an entry
+static size_t get_key_size(std::string_view entry) {
+  return entry.size() - BPlusTreeRecord::RID_SIZE;
+}
+
+// true if the run may have entries in [min_entry, max_entry]
+static bool overlaps(const LSMRun& run, std::string_view min_entry, std::string_view max_entry) {
+  return std::string_view(run.get_max_entry()) >= min_entry
+      && std::string_view(run.get_min_entry()) <= max_entry;
+}
+
+// appends to `inputs` the runs of `runs` overlapping the runs already in `inputs`
+static void add_overlapping(
+    const std::vector<std::shared_ptr<LSMRun>>& runs, std::vector<std::shared_ptr<LSMRun>>& inputs
+) {
+  std::string_view min_entry = inputs[0]->get_min_entry();
+  std::string_view max_entry = inputs[0]->get_max_entry();
+  for (size_t i = 1; i < inputs.size(); i++) {
+    min_entry = std::min(min_entry, std::string_view(inputs[i]->get_min_entry()));
+    max_entry = std::max(max_entry, std::string_view(inputs[i]->get_max_entry()));
+  }
+  for (auto& run : runs) {
+    if (overlaps(*run, min_entry, max_entry)) {
+      inputs.push_back(run);
+    }
+  }
+}
+
+LSMIndex::LSMIndex(
+    const HeapFile& heap_file, const std::vector<int64_t>& key_columns, const std::string& idx_name
+)
+    : heap_file(heap_file),
+      key_columns(key_columns),
+      key_datatypes(heap_file.schema.get_datatypes(key_columns)),
+      idx_name(idx_name),
+      manifest_file_id(file_mgr.get_file_id(idx_name + ".manifest")),
+      levels(1),
+      compaction_keys(1),
+      next_run_id(0),
+      compacting(false),
+      stopping(false) {
+  auto page_count = file_mgr.count_pages(manifest_file_id);
+  if (page_count > 0) {
+    std::vector<int64_t> manifest(page_count * Page::SIZE / sizeof(int64_t));
+    file_mgr.read_pages(manifest_file_id, 0, page_count, reinterpret_cast<char*>(manifest.data()));
+    next_run_id = manifest[0];
+    auto run_count = manifest[1];
+    for (int64_t i = 0; i < run_count; i++) {
+      auto values = &manifest[2 + i * MANIFEST_RUN_VALUES];
+      auto level = static_cast<size_t>(values[1]);
+      if (level >= levels.size()) {
+        levels.resize(level + 1);
+        compaction_keys.resize(level + 1);
+      }
+      levels[level].push_back(
+          std::make_shared<LSMRun>(get_run_filename(values[0]), values[0], values[2], values[3], values[4])
+      );
+    }
+  }
+  compaction_thread = std::thread(&LSMIndex::compaction_loop, this);
+}
+
+LSMIndex::~LSMIndex() {
+  {
+    std::lock_guard<std::mutex> lck(mutex);
+    stopping = true;
+  }
+  compaction_cv.notify_one();
+  compaction_thread.join();
+
+  std::unique_lock<std::mutex> lck(mutex);
+  flush_memtable(lck, 1);
+}
+
+std::string LSMIndex::get_run_filename(int64_t run_id) const {
+  return idx_name + "." + std::to_string(run_id) + ".run";
+}
+
+int64_t LSMIndex::get_level_max_bytes(size_t level) {
+  auto res = L1_MAX_BYTES;
+  for (size_t i = 1; i < level; i++) {
+    res *= LEVEL_SIZE_RATIO;
+  }
+  return res;
+}
+
+std::unique_ptr<RelationIter> LSMIndex::get_iter(
+    const std::vector<Value>& min, const std::vector<Value>& max
+) {
+  check_bound(min, key_datatypes);
+  check_bound(max, key_datatypes);
+  return std::make_unique<LSMIndexIter>(*this, min, max);
+}
+
+void LSMIndex::insert_record(const Record& record, RID rid) {
+  write_entry(record, rid, false);
+}
+
+void LSMIndex::delete_record(const Record& record, RID rid) {
+  write_entry(record, rid, true);
+}
+
+void LSMIndex::write_entry(const Record& record, RID rid, bool deleted) {
+  char entry[LSMRun::MAX_ENTRY_SIZE];
+  auto size = KeyEncoding::encode(record, key_columns, entry);
+  size += BPlusTreeRecord::encode_rid(rid, entry + size);
+
+  std::unique_lock<std::mutex> lck(mutex);
+  // inserts wait while the level 0 has too many runs, so compactions keep up with them
+  done_cv.wait(lck, [&] { return levels[0].size() < L0_STOP_RUNS; });
+
+  memtable.add(std::string_view(entry, size), deleted);
+  if (memtable.get_size_bytes() >= MEMTABLE_MAX_BYTES) {
+    flush_memtable(lck, MEMTABLE_MAX_BYTES);
+  }
+}
+
+void LSMIndex::flush() {
+  std::unique_lock<std::mutex> lck(mutex);
+  flush_memtable(lck, 1);
+}
+
+void LSMIndex::flush_memtable(std::unique_lock<std::mutex>& lck, size_t min_bytes) {
+  // a single memtable is written at a time, so the runs of level 0 are added in order
+  done_cv.wait(lck, [&] { return immutable_memtable == nullptr; });
+  if (memtable.empty() || memtable.get_size_bytes() < min_bytes) {
+    return;
+  }
+
+  // new entries go to an empty memtable while the full one is written, scans read both
+  auto flushed = std::make_shared<const LSMMemtable>(std::move(memtable));
+  memtable = LSMMemtable();
+  immutable_memtable = flushed;
+  auto run_id = next_run_id++;
+  lck.unlock();
+
+  LSMRunWriter writer(get_run_filename(run_id), run_id);
+  for (auto& [entry, deleted] : flushed->get_entries()) {
+    writer.add(entry, get_key_size(entry), deleted);
+  }
+  auto run = writer.finish();
+
+  lck.lock();
+  levels[0].push_back(std::move(run));
+  immutable_memtable = nullptr;
+  write_manifest();
+  done_cv.notify_all();
+  compaction_cv.notify_one();
+}
+
+void LSMIndex::wait_for_compactions() {
+  std::unique_lock<std::mutex> lck(mutex);
+  Compaction compaction;
+  done_cv.wait(lck, [&] {
+    return !compacting && immutable_memtable == nullptr && !pick_compaction(compaction);
+  });
+}
+
+std::vector<size_t> LSMIndex::get_run_counts() const {
+  std::lock_guard<std::mutex> lck(mutex);
+  std::vector<size_t> res;
+  for (auto& runs : levels) {
+    res.push_back(runs.size());
+  }
+  return res;
+}
+
+bool LSMIndex::pick_compaction(Compaction& compaction) const {
+  compaction.inputs.clear();
+  if (levels[0].size() >= L0_MAX_RUNS) {
+    // runs of level 0 overlap, so all of them are merged together
+    compaction.inputs.assign(levels[0].rbegin(), levels[0].rend());
+    compaction.upper_count = compaction.inputs.size();
+    compaction.output_level = 1;
+  } else {
+    for (size_t level = 1; level < levels.size() && compaction.inputs.empty(); level++) {
+      int64_t level_bytes = 0;
+      for (auto& run : levels[level]) {
+        level_bytes += run->get_size_bytes();
+      }
+      if (level_bytes <= get_level_max_bytes(level)) {
+        continue;
+      }
+      // the first run after the last one compacted from this level, starting again after the last run
+      auto& runs = levels[level];
+      auto& compaction_key = compaction_keys[level];
+      auto it = std::find_if(runs.begin(), runs.end(), [&](auto& run) {
+        return run->get_min_entry() > compaction_key;
+      });
+      compaction.inputs.push_back(it == runs.end() ? runs.front() : *it);
+      compaction.upper_count = 1;
+      compaction.output_level = level + 1;
+    }
+    if (compaction.inputs.empty()) {
+      return false;
+    }
+  }
+
+  auto output_level = compaction.output_level;
+  if (output_level < levels.size()) {
+    add_overlapping(levels[output_level], compaction.inputs);
+  }
+  compaction.drop_deleted = true;
+  for (auto level = output_level + 1; level < levels.size(); level++) {
+    compaction.drop_deleted = compaction.drop_deleted && levels[level].empty();
+  }
+  return true;
+}
+
+std::vector<std::shared_ptr<LSMRun>> LSMIndex::run_compaction(const Compaction& compaction) {
+  auto& inputs = compaction.inputs;
+  if (inputs.size() == 1 && compaction.output_level > 1) {
+    // the run does not overlap with the next level, so it is moved without rewriting it
+    return {inputs[0]};
+  }
+
+  std::vector<std::unique_ptr<LSMCursor>> cursors;
+  for (size_t i = 0; i < compaction.upper_count; i++) {
+    cursors.push_back(std::make_unique<LSMRunCursor>(inputs[i], std::string_view(), true));
+  }
+  if (compaction.upper_count < inputs.size()) {
+    std::vector<std::shared_ptr<LSMRun>> lower_runs(inputs.begin() + compaction.upper_count, inputs.end());
+    cursors.push_back(std::make_unique<LSMLevelCursor>(std::move(lower_runs), std::string_view(), true));
+  }
+  LSMMerge merge(std::move(cursors));
+
+  std::vector<std::shared_ptr<LSMRun>> outputs;
+  std::unique_ptr<LSMRunWriter> writer;
+  while (merge.next()) {
+    if (compaction.drop_deleted && merge.is_deleted()) {
+      continue;
+    }
+    if (writer == nullptr) {
+      auto run_id = next_run_id++;
+      writer = std::make_unique<LSMRunWriter>(get_run_filename(run_id), run_id);
+    }
+    auto entry = merge.get_entry();
+    writer->add(entry, get_key_size(entry), merge.is_deleted());
+    if (writer->get_size_bytes() >= RUN_MAX_BYTES) {
+      outputs.push_back(writer->finish());
+      writer.reset();
+    }
+  }
+  if (writer != nullptr) {
+    outputs.push_back(writer->finish());
+  }
+  return outputs;
+}
+
+void LSMIndex::install_compaction(
+    const Compaction& compaction, std::vector<std::shared_ptr<LSMRun>> outputs
+) {
+  auto& inputs = compaction.inputs;
+  for (auto& runs : levels) {
+    runs.erase(
+        std::remove_if(
+            runs.begin(),
+            runs.end(),
+            [&](auto& run) { return std::find(inputs.begin(), inputs.end(), run) != inputs.end(); }
+        ),
+        runs.end()
+    );
+  }
+  // the files of the inputs are removed when no scan uses them
+  for (auto& input : inputs) {
+    if (std::find(outputs.begin(), outputs.end(), input) == outputs.end()) {
+      input->obsolete = true;
+    }
+  }
+
+  auto output_level = compaction.output_level;
+  if (output_level >= levels.size()) {
+    levels.resize(output_level + 1);
+    compaction_keys.resize(output_level + 1);
+  }
+  if (output_level > 1) {
+    compaction_keys[output_level - 1] = inputs[0]->get_max_entry();
+  }
+  auto& runs = levels[output_level];
+  runs.insert(runs.end(), outputs.begin(), outputs.end());
+  std::sort(runs.begin(), runs.end(), [](auto& a, auto& b) {
+    return a->get_min_entry() < b->get_min_entry();
+  });
+  write_manifest();
+}
+
+void LSMIndex::compaction_loop() {
+  std::unique_lock<std::mutex> lck(mutex);
+  while (!stopping) {
+    Compaction compaction;
+    if (!pick_compaction(compaction)) {
+      compaction_cv.wait(lck);
+      continue;
+    }
+    compacting = true;
+    lck.unlock();
+
+    auto outputs = run_compaction(compaction);
+
+    lck.lock();
+    install_compaction(compaction, std::move(outputs));
+    compacting = false;
+    done_cv.notify_all();
+  }
+}
+
+void LSMIndex::write_manifest() const {
+  std::vector<int64_t> manifest = {next_run_id, 0};
+  for (size_t level = 0; level < levels.size(); level++) {
+    for (auto& run : levels[level]) {
+      auto run_level = static_cast<int64_t>(level);
+      manifest.insert(
+          manifest.end(),
+          {run->id, run_level, run->data_page_count, run->bloom_page_count, run->entry_count}
+      );
+      manifest[1]++;
+    }
+  }
+  auto values_per_page = Page::SIZE / sizeof(int64_t);
+  auto page_count = (manifest.size() + values_per_page - 1) / values_per_page;
+  manifest.resize(page_count * values_per_page);
+  file_mgr.write_pages(manifest_file_id, 0, page_count, reinterpret_cast<const char*>(manifest.data()));
+}
+
+std::vector<std::unique_ptr<LSMCursor>> LSMIndex::get_cursors(
+    std::string_view min_key, std::string_view max_key, const uint64_t* key_hash
+) const {
+  auto may_have_entries = [&](const LSMRun& run) {
+    std::string_view run_min = run.get_min_entry();
+    return std::string_view(run.get_max_entry()) >= min_key
+        && !KeyEncoding::is_after_max(run_min.data(), get_key_size(run_min), max_key.data(), max_key.size())
+        && (key_hash == nullptr || run.may_contain(*key_hash));
+  };
+
+  // the entries of the memtables are copied and the runs referenced, so the mutex is held only here
+  std::vector<std::pair<std::string, bool>> memtable_entries;
+  std::vector<std::pair<std::string, bool>> immutable_entries;
+  std::vector<std::vector<std::shared_ptr<LSMRun>>> level_runs(1);
+  {
+    std::lock_guard<std::mutex> lck(mutex);
+    memtable.copy_range(min_key, max_key, memtable_entries);
+    if (immutable_memtable != nullptr) {
+      immutable_memtable->copy_range(min_key, max_key, immutable_entries);
+    }
+    for (auto it = levels[0].rbegin(); it != levels[0].rend(); ++it) {
+      if (may_have_entries(**it)) {
+        level_runs[0].push_back(*it);
+      }
+    }
+    for (size_t level = 1; level < levels.size(); level++) {
+      level_runs.emplace_back();
+      for (auto& run : levels[level]) {
+        if (may_have_entries(*run)) {
+          level_runs.back().push_back(run);
+        }
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<LSMCursor>> cursors;
+  cursors.push_back(std::make_unique<LSMMemtableCursor>(std::move(memtable_entries)));
+  cursors.push_back(std::make_unique<LSMMemtableCursor>(std::move(immutable_entries)));
+  for (auto& run : level_runs[0]) {
+    cursors.push_back(std::make_unique<LSMRunCursor>(run, min_key, false));
+  }
+  for (size_t level = 1; level < level_runs.size(); level++) {
+    if (!level_runs[level].empty()) {
+      cursors.push_back(std::make_unique<LSMLevelCursor>(std::move(level_runs[level]), min_key, false));
+    }
+  }
+  return cursors;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "relational_model/index.h"
+#include "relational_model/record.h"
+#include "storage/lsm/lsm_cursor.h"
+#include "storage/lsm/lsm_memtable.h"
+#include "storage/lsm/lsm_run.h"
+
+class HeapFile;
+
+/*
+  Log-structured merge index, for tables with many more inserts than lookups. Inserts and deletes go to
+  an in-memory memtable (see LSMMemtable), and a deletion is stored as a deleted entry hiding the older
+  one. When the memtable is full it is written sequentially as a new run of the level 0 (see LSMRun).
+
+  A background thread compacts the runs with leveled compaction: when the level 0 has L0_MAX_RUNS runs
+  they are merged with the runs of the level 1 they overlap, and when a level n >= 1 is bigger than its
+  limit one of its runs is merged with the runs of the level n + 1 it overlaps. The runs of a level n >= 1
+  do not overlap, and the limit of each level is LEVEL_SIZE_RATIO times the limit of the previous one.
+
+  Scans merge the memtable and the runs overlapping the range (see LSMIndexIter). Lookups of a whole key
+  skip the runs whose Bloom filter does not have it.
+
+  The runs of each level are listed in the manifest file, rewritten when they change. The memtable is
+  written as a run when the index is closed, there is no log of the entries not written yet.
+ */
+class LSMIndex : public Index {
+public:
+  // approximate bytes of the memtable before it is written as a run
+  static constexpr size_t MEMTABLE_MAX_BYTES = 4 * 1024 * 1024;
+
+  // runs of level 0 that trigger a compaction
+  static constexpr size_t L0_MAX_RUNS = 4;
+
+  // runs of level 0 that stop inserts until a compaction finishes
+  static constexpr size_t L0_STOP_RUNS = 3 * L0_MAX_RUNS;
+
+  static constexpr int64_t L1_MAX_BYTES = 16 * 1024 * 1024;
+
+  static constexpr int64_t LEVEL_SIZE_RATIO = 10;
+
+  // max bytes of the runs written by compactions
+  static constexpr int64_t RUN_MAX_BYTES = 4 * 1024 * 1024;
+
+  // the key is the concatenation of the `key_columns`
+  LSMIndex(const HeapFile& heap_file, const std::vector<int64_t>& key_columns, const std::string& idx_name);
+
+  // waits for the running compaction and writes the memtable
+  ~LSMIndex();
+
+  void insert_record(const Record& record, RID rid) override;
+
+  void delete_record(const Record& record, RID rid) override;
+
+  using Index::get_iter;
+
+  std::unique_ptr<RelationIter> get_iter(
+      const std::vector<Value>& min, const std::vector<Value>& max
+  ) override;
+
+  IndexType get_type() override {
+    return IndexType::LSM;
+  }
+
+  const std::vector<int64_t>& get_key_columns() const override {
+    return key_columns;
+  }
+
+  // writes the memtable as a run of level 0
+  void flush();
+
+  // blocks until no level needs a compaction
+  void wait_for_compactions();
+
+  // returns the number of runs of each level
+  std::vector<size_t> get_run_counts() const;
+
+  const HeapFile& heap_file;
+
+  const std::vector<int64_t> key_columns;
+
+  const std::vector<DataType> key_datatypes;
+
+  const std::string idx_name;
+
+  const FileId manifest_file_id;
+
+private:
+  friend class LSMIndexIter;
+
+  struct Compaction {
+    // runs to merge, first the ones of the upper level from the newest to the oldest, followed by the runs
+    // of the output level sorted by their first entry
+    std::vector<std::shared_ptr<LSMRun>> inputs;
+
+    size_t upper_count;
+
+    // level of the new runs
+    size_t output_level;
+
+    // true if there are no runs in deeper levels, so the deleted entries can be dropped
+    bool drop_deleted;
+  };
+
+  // protects the memtables, the levels and the manifest
+  mutable std::mutex mutex;
+
+  LSMMemtable memtable;
+
+  // memtable being written as a run, nullptr if there is none
+  std::shared_ptr<const LSMMemtable> immutable_memtable;
+
+  // level 0 is ordered from the oldest run to the newest one, the next levels by the first entry of the runs
+  std::vector<std::vector<std::shared_ptr<LSMRun>>> levels;
+
+  // for each level, the last entry of the last run compacted from it, so its runs are compacted in turns
+  std::vector<std::string> compaction_keys;
+
+  std::atomic<int64_t> next_run_id;
+
+  // notified when a memtable was written, to check if a compaction is needed, or to stop the thread
+  std::condition_variable compaction_cv;
+
+  // notified when a compaction or the writing of a memtable finishes
+  std::condition_variable done_cv;
+
+  bool compacting;
+
+  bool stopping;
+
+  std::thread compaction_thread;
+
+  void write_entry(const Record& record, RID rid, bool deleted);
+
+  // writes the memtable if it has at least `min_bytes`, mutex must be locked by `lck`
+  void flush_memtable(std::unique_lock<std::mutex>& lck, size_t min_bytes);
+
+  std::string get_run_filename(int64_t run_id) const;
+
+  static int64_t get_level_max_bytes(size_t level);
+
+  // returns false if no level needs a compaction, mutex must be locked
+  bool pick_compaction(Compaction& compaction) const;
+
+  // writes the merged entries of the inputs as new runs
+  std::vector<std::shared_ptr<LSMRun>> run_compaction(const Compaction& compaction);
+
+  // replaces the inputs of the compaction by its outputs, mutex must be locked
+  void install_compaction(const Compaction& compaction, std::vector<std::shared_ptr<LSMRun>> outputs);
+
+  void compaction_loop();
+
+  // mutex must be locked
+  void write_manifest() const;
+
+  // returns the cursors over the entries that may be in [min_key, max_key], from the newest source to the
+  // oldest one. If `key_hash` is not nullptr, the runs whose Bloom filter does not have it are skipped
+  std::vector<std::unique_ptr<LSMCursor>> get_cursors(
+      std::string_view min_key, std::string_view max_key, const uint64_t* key_hash
+  ) const;
+};
@@ -0,0 +1,59 @@
+#include "lsm_index_iter.h"
+
+#include "relational_model/key_encoding.h"
+#include "storage/b_plus_tree/b_plus_tree_utils.h"
+#include "storage/heap_file/heap_file.h"
+
+LSMIndexIter::LSMIndexIter(
+    const LSMIndex& index, const std::vector<Value>& min, const std::vector<Value>& max
+)
+    : index(index),
+      min_key(KeyEncoding::encode(min)),
+      max_key(KeyEncoding::encode(max)),
+      whole_key(min.size() == index.key_columns.size() && min_key == max_key) {}
+
+void LSMIndexIter::begin(Record& _out) {
+  out = &_out;
+  reset();
+}
+
+void LSMIndexIter::reset() {
+  auto key_hash = LSMBloomFilter::hash(min_key.data(), min_key.size());
+  merge = std::make_unique<LSMMerge>(index.get_cursors(min_key, max_key, whole_key ? &key_hash : nullptr));
+  ended = false;
+}
+
+bool LSMIndexIter::advance(RID* rid) {
+  while (!ended && merge->next()) {
+    auto entry = merge->get_entry();
+    auto key_size = entry.size() - BPlusTreeRecord::RID_SIZE;
+    if (KeyEncoding::is_after_max(entry.data(), key_size, max_key.data(), max_key.size())) {
+      ended = true;
+      break;
+    }
+    if (!merge->is_deleted()) {
+      *rid = BPlusTreeRecord::decode_rid(entry.data() + entry.size() - BPlusTreeRecord::RID_SIZE);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LSMIndexIter::next() {
+  RID rid;
+  if (!advance(&rid)) {
+    return false;
+  }
+  index.heap_file.get_record(rid, *out);
+  return true;
+}
+
+bool LSMIndexIter::next_batch(ColumnBatch& batch) {
+  batch.clear();
+  if (merge == nullptr) {
+    reset();
+  }
+
+  index.heap_file.append_records_to_batch([this](RID* rid) { return advance(rid); }, batch);
+  return batch.size > 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "relational_model/relation_iter.h"
+#include "storage/lsm/lsm_cursor.h"
+#include "storage/lsm/lsm_index.h"
+
+// Returns the records with min <= key <= max, merging the entries of the memtables and the runs that
+// overlap the range. The memtables are copied and the runs kept when the scan starts, so inserts and
+// compactions running meanwhile are not seen. When min and max are the same whole key, the runs whose
+// Bloom filter does not have it are not read.
+class LSMIndexIter : public RelationIter {
+public:
+  LSMIndexIter(const LSMIndex& index, const std::vector<Value>& min, const std::vector<Value>& max);
+
+  virtual void begin(Record& out) override;
+
+  virtual bool next() override;
+
+  virtual bool next_batch(ColumnBatch& batch) override;
+
+  virtual void reset() override;
+
+private:
+  const LSMIndex& index;
+
+  // encoded keys (without RID)
+  std::string min_key;
+
+  std::string max_key;
+
+  const bool whole_key;
+
+  std::unique_ptr<LSMMerge> merge;
+
+  // true when an entry after max was found
+  bool ended;
+
+  Record* out;
+
+  // moves to the next entry not deleted with key <= max, returns false if there is no such entry
+  bool advance(RID* rid);
+};
@@ -0,0 +1,119 @@
+#include "lsm_memtable.h"
+
+#include <algorithm>
+
+#include "relational_model/key_encoding.h"
+#include "storage/b_plus_tree/b_plus_tree_utils.h"
+
+void LSMMemtable::add(std::string_view entry, bool deleted) {
+  unsorted.push_back({static_cast<uint32_t>(bytes.size()), static_cast<uint16_t>(entry.size()), deleted});
+  bytes.append(entry);
+  if (unsorted.size() < SORT_SIZE) {
+    return;
+  }
+
+  sort(unsorted);
+  sorted.push_back(std::move(unsorted));
+  unsorted.clear();
+  // each entry is merged about log2(entries / SORT_SIZE) times
+  while (sorted.size() >= 2 && sorted[sorted.size() - 2].size() <= 2 * sorted.back().size()) {
+    auto& older = sorted[sorted.size() - 2];
+    auto& newer = sorted.back();
+    auto merged = merge(
+        Range(older.data(), older.data() + older.size()), Range(newer.data(), newer.data() + newer.size())
+    );
+    sorted.pop_back();
+    sorted.back() = std::move(merged);
+  }
+}
+
+void LSMMemtable::sort(std::vector<Entry>& entries) const {
+  std::stable_sort(entries.begin(), entries.end(), [&](Entry a, Entry b) {
+    return get_entry(a) < get_entry(b);
+  });
+  size_t count = 0;
+  for (auto entry : entries) {
+    if (count > 0 && get_entry(entries[count - 1]) == get_entry(entry)) {
+      entries[count - 1] = entry;
+    } else {
+      entries[count++] = entry;
+    }
+  }
+  entries.resize(count);
+}
+
+std::vector<LSMMemtable::Entry> LSMMemtable::merge(Range older, Range newer) const {
+  std::vector<Entry> res;
+  res.reserve((older.second - older.first) + (newer.second - newer.first));
+  auto [a, a_end] = older;
+  auto [b, b_end] = newer;
+  while (a != a_end && b != b_end) {
+    auto cmp = get_entry(*a).compare(get_entry(*b));
+    if (cmp < 0) {
+      res.push_back(*a++);
+    } else {
+      // when they are equal the older entry is skipped
+      a += cmp == 0;
+      res.push_back(*b++);
+    }
+  }
+  res.insert(res.end(), a, a_end);
+  res.insert(res.end(), b, b_end);
+  return res;
+}
+
+std::vector<LSMMemtable::Entry> LSMMemtable::merge(const std::vector<Range>& ranges) const {
+  std::vector<Entry> res;
+  for (auto& range : ranges) {
+    res = merge(Range(res.data(), res.data() + res.size()), range);
+  }
+  return res;
+}
+
+void LSMMemtable::copy_range(
+    std::string_view min_key, std::string_view max_key, std::vector<std::pair<std::string, bool>>& out
+) const {
+  auto last_added = unsorted;
+  sort(last_added);
+
+  auto is_after_max = [&](Entry entry) {
+    auto key_size = entry.size - BPlusTreeRecord::RID_SIZE;
+    return KeyEncoding::is_after_max(get_entry(entry).data(), key_size, max_key.data(), max_key.size());
+  };
+
+  std::vector<Range> ranges;
+  auto add_range = [&](const std::vector<Entry>& entries) {
+    auto less = [&](Entry a, std::string_view b) { return get_entry(a) < b; };
+    auto first = std::lower_bound(entries.data(), entries.data() + entries.size(), min_key, less);
+    auto last = first;
+    while (last != entries.data() + entries.size() && !is_after_max(*last)) {
+      last++;
+    }
+    ranges.emplace_back(first, last);
+  };
+  for (auto& entries : sorted) {
+    add_range(entries);
+  }
+  add_range(last_added);
+
+  for (auto entry : merge(ranges)) {
+    out.emplace_back(get_entry(entry), entry.deleted);
+  }
+}
+
+std::vector<std::pair<std::string_view, bool>> LSMMemtable::get_entries() const {
+  auto last_added = unsorted;
+  sort(last_added);
+
+  std::vector<Range> ranges;
+  for (auto& entries : sorted) {
+    ranges.emplace_back(entries.data(), entries.data() + entries.size());
+  }
+  ranges.emplace_back(last_added.data(), last_added.data() + last_added.size());
+
+  std::vector<std::pair<std::string_view, bool>> res;
+  for (auto entry : merge(ranges)) {
+    res.emplace_back(get_entry(entry), entry.deleted);
+  }
+  return res;
+}
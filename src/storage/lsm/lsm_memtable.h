@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// In-memory entries of an LSMIndex not written to a run yet. The bytes of the entries are appended to a
+// single buffer, and the entries are sorted SORT_SIZE at a time into sorted groups, merged together like
+// the digits of a binary counter. So each entry is compared a few times against entries close in memory,
+// instead of being searched in a tree of scattered nodes.
+class LSMMemtable {
+public:
+  // entries sorted together before merging them with the sorted groups
+  static constexpr size_t SORT_SIZE = 256;
+
+  void add(std::string_view entry, bool deleted);
+
+  bool empty() const {
+    return unsorted.empty() && sorted.empty();
+  }
+
+  // bytes of the added entries, counting the ones added several times
+  size_t get_size_bytes() const {
+    return bytes.size();
+  }
+
+  // appends to `out` the entries in [min_key, max_key] in order (see KeyEncoding::is_after_max). The second
+  // value tells if the entry is deleted
+  void copy_range(
+      std::string_view min_key, std::string_view max_key, std::vector<std::pair<std::string, bool>>& out
+  ) const;
+
+  // returns all the entries in order, valid while the memtable is not modified
+  std::vector<std::pair<std::string_view, bool>> get_entries() const;
+
+private:
+  struct Entry {
+    uint32_t offset;
+
+    uint16_t size;
+
+    bool deleted;
+  };
+
+  // entries [first, last) of a sorted group
+  using Range = std::pair<const Entry*, const Entry*>;
+
+  std::string bytes;
+
+  // the last added entries, less than SORT_SIZE
+  std::vector<Entry> unsorted;
+
+  // groups of sorted entries, from the oldest to the newest. Each group has no repeated entries and is
+  // more than twice as big as the next one
+  std::vector<std::vector<Entry>> sorted;
+
+  std::string_view get_entry(Entry entry) const {
+    return std::string_view(bytes.data() + entry.offset, entry.size);
+  }
+
+  // sorts the entries, keeping only the last one added of each repeated entry
+  void sort(std::vector<Entry>& entries) const;
+
+  // returns the merge of two sorted ranges, taking the entries of `newer` when they are repeated
+  std::vector<Entry> merge(Range older, Range newer) const;
+
+  // returns the merge of the ranges, ordered from the oldest to the newest
+  std::vector<Entry> merge(const std::vector<Range>& ranges) const;
+};
@@ -0,0 +1,259 @@
+#include "lsm_run.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "system/system.h"
+
+static uint16_t read_uint16(const char* in) {
+  uint16_t res;
+  std::memcpy(&res, in, sizeof(res));
+  return res;
+}
+
+static void write_uint16(char* out, uint16_t n) {
+  std::memcpy(out, &n, sizeof(n));
+}
+
+// returns the size an entry takes in a page
+static size_t get_entry_space(std::string_view entry) {
+  return LSMRun::ENTRY_HEADER_SIZE + entry.size();
+}
+
+// writes the entry at `offset` of the page and increments the entry count of the page
+static void write_entry(char* page, size_t offset, std::string_view entry, bool deleted) {
+  write_uint16(page + offset, static_cast<uint16_t>(entry.size()));
+  page[offset + sizeof(uint16_t)] = deleted ? 1 : 0;
+  std::memcpy(page + offset + LSMRun::ENTRY_HEADER_SIZE, entry.data(), entry.size());
+  write_uint16(page, read_uint16(page) + 1);
+}
+
+LSMRun::LSMRun(
+    const std::string& filename,
+    int64_t id,
+    int64_t data_page_count,
+    int64_t bloom_page_count,
+    int64_t entry_count
+)
+    : filename(filename),
+      file_id(file_mgr.get_file_id(filename)),
+      id(id),
+      data_page_count(data_page_count),
+      bloom_page_count(bloom_page_count),
+      entry_count(entry_count),
+      obsolete(false),
+      bloom(bloom_page_count) {
+  auto bloom_bytes = reinterpret_cast<char*>(bloom.words.data());
+  file_mgr.read_pages(file_id, data_page_count, bloom_page_count, bloom_bytes);
+
+  auto fence_page_count = file_mgr.count_pages(file_id) - data_page_count - bloom_page_count;
+  std::vector<char> fence_pages(fence_page_count * Page::SIZE);
+  file_mgr.read_pages(file_id, data_page_count + bloom_page_count, fence_page_count, fence_pages.data());
+  for (int64_t i = 0; i < fence_page_count; i++) {
+    auto page = fence_pages.data() + i * Page::SIZE;
+    auto offset = PAGE_HEADER_SIZE;
+    for (uint16_t j = 0; j < read_uint16(page); j++) {
+      auto size = read_uint16(page + offset);
+      fences.emplace_back(page + offset + ENTRY_HEADER_SIZE, size);
+      offset += ENTRY_HEADER_SIZE + size;
+    }
+  }
+}
+
+LSMRun::LSMRun(
+    const std::string& filename,
+    int64_t id,
+    int64_t data_page_count,
+    int64_t entry_count,
+    std::vector<std::string> fences,
+    LSMBloomFilter bloom
+)
+    : filename(filename),
+      file_id(file_mgr.get_file_id(filename)),
+      id(id),
+      data_page_count(data_page_count),
+      bloom_page_count(bloom.words.size() / LSMBloomFilter::WORDS_PER_PAGE),
+      entry_count(entry_count),
+      obsolete(false),
+      fences(std::move(fences)),
+      bloom(std::move(bloom)) {}
+
+LSMRun::~LSMRun() {
+  if (obsolete) {
+    buffer_mgr.remove_file(file_id);
+    file_mgr.remove_file(filename);
+  }
+}
+
+int64_t LSMRun::find_page(std::string_view entry) const {
+  // the last page whose first entry is not greater than `entry`
+  auto first_entries_end = fences.begin() + data_page_count;
+  auto it = std::upper_bound(fences.begin(), first_entries_end, entry, [](std::string_view a, auto& b) {
+    return a < std::string_view(b);
+  });
+  return it == fences.begin() ? 0 : (it - fences.begin()) - 1;
+}
+
+LSMRunWriter::LSMRunWriter(const std::string& filename, int64_t id)
+    : filename(filename),
+      file_id(file_mgr.get_file_id(filename)),
+      id(id),
+      pending_page_count(0),
+      written_page_count(0),
+      data_page_count(0),
+      entry_count(0),
+      page_offset(0) {}
+
+char* LSMRunWriter::new_page() {
+  if (pending_page_count == WRITE_PAGES) {
+    write_pending();
+  }
+  pending_page_count++;
+  pending.resize(pending_page_count * Page::SIZE);
+  auto page = pending.data() + (pending_page_count - 1) * Page::SIZE;
+  std::memset(page, 0, Page::SIZE);
+  return page;
+}
+
+void LSMRunWriter::write_pending() {
+  file_mgr.write_pages(file_id, written_page_count, pending_page_count, pending.data());
+  written_page_count += pending_page_count;
+  pending_page_count = 0;
+}
+
+void LSMRunWriter::add(std::string_view entry, size_t key_size, bool deleted) {
+  if (page_offset == 0 || page_offset + get_entry_space(entry) > Page::SIZE) {
+    new_page();
+    data_page_count++;
+    page_offset = LSMRun::PAGE_HEADER_SIZE;
+    fences.emplace_back(entry);
+  }
+  auto page = pending.data() + (pending_page_count - 1) * Page::SIZE;
+  write_entry(page, page_offset, entry, deleted);
+  page_offset += get_entry_space(entry);
+
+  key_hashes.push_back(LSMBloomFilter::hash(entry.data(), key_size));
+  last_entry.assign(entry.data(), entry.size());
+  entry_count++;
+}
+
+std::shared_ptr<LSMRun> LSMRunWriter::finish() {
+  if (entry_count == 0) {
+    file_mgr.remove_file(filename);
+    return nullptr;
+  }
+  write_pending();
+
+  LSMBloomFilter bloom(LSMBloomFilter::get_page_count(key_hashes.size()));
+  for (auto key_hash : key_hashes) {
+    bloom.add(key_hash);
+  }
+  auto bloom_page_count = static_cast<int64_t>(bloom.words.size() / LSMBloomFilter::WORDS_PER_PAGE);
+  file_mgr.write_pages(
+      file_id, written_page_count, bloom_page_count, reinterpret_cast<const char*>(bloom.words.data())
+  );
+  written_page_count += bloom_page_count;
+
+  fences.push_back(last_entry);
+  char* page = nullptr;
+  size_t offset = 0;
+  for (auto& fence : fences) {
+    if (page == nullptr || offset + get_entry_space(fence) > Page::SIZE) {
+      page = new_page();
+      offset = LSMRun::PAGE_HEADER_SIZE;
+    }
+    write_entry(page, offset, fence, false);
+    offset += get_entry_space(fence);
+  }
+  write_pending();
+
+  return std::shared_ptr<LSMRun>(
+      new LSMRun(filename, id, data_page_count, entry_count, std::move(fences), std::move(bloom))
+  );
+}
+
+LSMRunCursor::LSMRunCursor(std::shared_ptr<LSMRun> run, std::string_view start, bool sequential)
+    : run(std::move(run)),
+      sequential(sequential),
+      page(nullptr),
+      buffer_first_page(0) {
+  page_number = this->run->find_page(start);
+  read_page();
+  while (valid() && get_entry() < start) {
+    next();
+  }
+}
+
+LSMRunCursor::~LSMRunCursor() {
+  if (page != nullptr) {
+    page->unpin();
+  }
+}
+
+void LSMRunCursor::read_page() {
+  if (sequential) {
+    auto buffer_page_count = static_cast<int64_t>(buffer.size() / Page::SIZE);
+    if (page_number < buffer_first_page || page_number >= buffer_first_page + buffer_page_count) {
+      auto count = std::min(LSMRunWriter::WRITE_PAGES, run->data_page_count - page_number);
+      buffer.resize(count * Page::SIZE);
+      file_mgr.read_pages(run->file_id, page_number, count, buffer.data());
+      buffer_first_page = page_number;
+    }
+    page_bytes = buffer.data() + (page_number - buffer_first_page) * Page::SIZE;
+  } else {
+    if (page != nullptr) {
+      page->unpin();
+    }
+    page = &buffer_mgr.get_page(run->file_id, page_number);
+    page_bytes = page->get_bytes();
+  }
+  // pages always have at least one entry
+  entry_pos = 0;
+  page_entry_count = read_uint16(page_bytes);
+  offset = LSMRun::PAGE_HEADER_SIZE;
+  entry_size = read_uint16(page_bytes + offset);
+}
+
+void LSMRunCursor::next() {
+  offset += LSMRun::ENTRY_HEADER_SIZE + entry_size;
+  entry_pos++;
+  if (entry_pos < page_entry_count) {
+    entry_size = read_uint16(page_bytes + offset);
+    return;
+  }
+  page_number++;
+  if (valid()) {
+    read_page();
+  } else if (page != nullptr) {
+    page->unpin();
+    page = nullptr;
+  }
+}
+
+LSMLevelCursor::LSMLevelCursor(
+    std::vector<std::shared_ptr<LSMRun>> runs, std::string_view start, bool sequential
+)
+    : runs(std::move(runs)),
+      sequential(sequential),
+      next_run(0) {
+  // runs ending before start are skipped without reading them
+  while (next_run < this->runs.size() && std::string_view(this->runs[next_run]->get_max_entry()) < start) {
+    next_run++;
+  }
+  skip_ended(start);
+}
+
+void LSMLevelCursor::skip_ended(std::string_view start) {
+  while (current == nullptr || !current->valid()) {
+    current.reset(); // unpin before reading the next run
+    if (next_run == runs.size()) {
+      return;
+    }
+    current = std::make_unique<LSMRunCursor>(runs[next_run++], start, sequential);
+  }
+}
+
+void LSMLevelCursor::next() {
+  current->next();
+  skip_ended(std::string_view());
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "storage/file_id.h"
+#include "storage/lsm/lsm_bloom_filter.h"
+#include "storage/lsm/lsm_cursor.h"
+#include "storage/page.h"
+
+/*
+  Immutable sorted run of an LSMIndex. It is written once sequentially (see LSMRunWriter) and deleted when
+  it is compacted into other runs. The file has the data pages, followed by the pages of the Bloom filter
+  of the keys and by the fence pages.
+
+  Data page layout:
+  | entry count (uint16) | entries |
+
+  Entry layout:
+  | size (uint16) | deleted (uint8) | encoded key followed by the RID |
+
+  The fence pages have the first entry of each data page, followed by the last entry of the run, with the
+  same layout. They are kept in memory, so finding the data page where an entry would be reads no page.
+*/
+class LSMRun {
+  friend class LSMRunWriter;
+
+public:
+  static constexpr size_t PAGE_HEADER_SIZE = sizeof(uint16_t);
+
+  static constexpr size_t ENTRY_HEADER_SIZE = sizeof(uint16_t) + sizeof(uint8_t);
+
+  // max size of an entry (see BPlusTreeRecord::get_max_size)
+  static constexpr size_t MAX_ENTRY_SIZE = 1024;
+
+  static_assert(PAGE_HEADER_SIZE + ENTRY_HEADER_SIZE + MAX_ENTRY_SIZE <= Page::SIZE);
+
+  // opens a run written before
+  LSMRun(
+      const std::string& filename,
+      int64_t id,
+      int64_t data_page_count,
+      int64_t bloom_page_count,
+      int64_t entry_count
+  );
+
+  // removes the file if the run is obsolete
+  ~LSMRun();
+
+  // prevent accidental copies
+  LSMRun(const LSMRun& other) = delete;
+
+  const std::string filename;
+
+  const FileId file_id;
+
+  const int64_t id;
+
+  const int64_t data_page_count;
+
+  const int64_t bloom_page_count;
+
+  const int64_t entry_count;
+
+  // set when the run was compacted, its file is removed when the last iterator using it ends
+  std::atomic<bool> obsolete;
+
+  const std::string& get_min_entry() const {
+    return fences.front();
+  }
+
+  const std::string& get_max_entry() const {
+    return fences.back();
+  }
+
+  int64_t get_size_bytes() const {
+    return data_page_count * Page::SIZE;
+  }
+
+  // false if the run has no entry with the key
+  bool may_contain(uint64_t key_hash) const {
+    return bloom.may_contain(key_hash);
+  }
+
+  // returns the data page where `entry` is or would be
+  int64_t find_page(std::string_view entry) const;
+
+private:
+  std::vector<std::string> fences;
+
+  LSMBloomFilter bloom;
+
+  LSMRun(
+      const std::string& filename,
+      int64_t id,
+      int64_t data_page_count,
+      int64_t entry_count,
+      std::vector<std::string> fences,
+      LSMBloomFilter bloom
+  );
+};
+
+// Writes a new run. Pages are written directly to the file several at a time, without using the buffer.
+class LSMRunWriter {
+public:
+  // pages written to the file at once
+  static constexpr int64_t WRITE_PAGES = 32;
+
+  LSMRunWriter(const std::string& filename, int64_t id);
+
+  // entries must be added in order, `key_size` is the size of the key at the beginning of the entry
+  void add(std::string_view entry, size_t key_size, bool deleted);
+
+  // bytes of the data pages written so far
+  int64_t get_size_bytes() const {
+    return data_page_count * Page::SIZE;
+  }
+
+  // writes the pending pages, the Bloom filter and the fences. Returns nullptr and removes the file if
+  // no entry was added
+  std::shared_ptr<LSMRun> finish();
+
+private:
+  const std::string filename;
+
+  const FileId file_id;
+
+  const int64_t id;
+
+  // pages not written yet, the last one is the data page being filled
+  std::vector<char> pending;
+
+  int64_t pending_page_count;
+
+  // pages written to the file
+  int64_t written_page_count;
+
+  int64_t data_page_count;
+
+  int64_t entry_count;
+
+  // offset of the next entry in the current page, 0 if there is no current page
+  size_t page_offset;
+
+  std::vector<uint64_t> key_hashes;
+
+  std::vector<std::string> fences;
+
+  std::string last_entry;
+
+  // returns the memory of a new pending page, writing the pending pages if there are WRITE_PAGES of them
+  char* new_page();
+
+  void write_pending();
+};
+
+// Reads the entries of a run in order, starting from the first one greater or equal than `start`.
+// Pages are read through the buffer and pinned while they are used, or if `sequential` is true, directly
+// from the file LSMRunWriter::WRITE_PAGES at a time (for compactions, that read whole runs).
+class LSMRunCursor : public LSMCursor {
+public:
+  LSMRunCursor(std::shared_ptr<LSMRun> run, std::string_view start, bool sequential);
+
+  ~LSMRunCursor();
+
+  bool valid() const override {
+    return page_number < run->data_page_count;
+  }
+
+  std::string_view get_entry() const override {
+    return std::string_view(page_bytes + offset + LSMRun::ENTRY_HEADER_SIZE, entry_size);
+  }
+
+  bool is_deleted() const override {
+    return page_bytes[offset + sizeof(uint16_t)] != 0;
+  }
+
+  void next() override;
+
+private:
+  std::shared_ptr<LSMRun> run;
+
+  const bool sequential;
+
+  // the page being read when not sequential
+  Page* page;
+
+  // pages read when sequential
+  std::vector<char> buffer;
+
+  int64_t buffer_first_page;
+
+  int64_t page_number;
+
+  const char* page_bytes;
+
+  // position of the current entry in the page
+  int32_t entry_pos;
+
+  int32_t page_entry_count;
+
+  size_t offset;
+
+  size_t entry_size;
+
+  // makes page_number the current page, positioned at its first entry
+  void read_page();
+};
+
+// Reads the entries of the runs of a level after level 0, which do not overlap, as a single sorted source
+class LSMLevelCursor : public LSMCursor {
+public:
+  // `runs` must be sorted by their first entry
+  LSMLevelCursor(std::vector<std::shared_ptr<LSMRun>> runs, std::string_view start, bool sequential);
+
+  bool valid() const override {
+    return current != nullptr;
+  }
+
+  std::string_view get_entry() const override {
+    return current->get_entry();
+  }
+
+  bool is_deleted() const override {
+    return current->is_deleted();
+  }
+
+  void next() override;
+
+private:
+  std::vector<std::shared_ptr<LSMRun>> runs;
+
+  const bool sequential;
+
+  // position in runs of the next run to read
+  size_t next_run;
+
+  // nullptr when there are no more entries
+  std::unique_ptr<LSMRunCursor> current;
+
+  // moves to the first entry of the next runs, if the current one has no more entries
+  void skip_ended(std::string_view start);
+};
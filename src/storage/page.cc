@@ -28,12 +28,19 @@ int64_t Page::read_int64(size_t offset) {
   return res;
 }
 
-void Page::write(size_t offset, size_t size, char* in) {
+void Page::write(size_t offset, size_t size, const char* in) {
   assert(offset + size <= Page::SIZE);
   memcpy(bytes + offset, in, size);
   dirty = true;
 }
 
+void Page::move(size_t dst_offset, size_t src_offset, size_t size) {
+  assert(dst_offset + size <= Page::SIZE);
+  assert(src_offset + size <= Page::SIZE);
+  memmove(bytes + dst_offset, bytes + src_offset, size);
+  dirty = true;
+}
+
 void Page::write_int8(size_t offset, uint8_t i) {
   assert(offset + 1 <= Page::SIZE);
   char* i_ptr = reinterpret_cast<char*>(&i);
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <shared_mutex>
 
 #include "storage/page_id.h"
 
@@ -15,17 +16,29 @@ public:
   // contains file_id and page_number of this page
   PageId page_id;
 
+  // protects the content of the page for structures that are modified concurrently (see BPlusTree).
+  // Only valid while the page is pinned
+  std::shared_mutex latch;
+
   // Read / Write interfaces
   void read(size_t offset, size_t size, char* out);
   uint8_t read_uint8(size_t offset);
   int32_t read_int32(size_t offset);
   int64_t read_int64(size_t offset);
 
-  void write(size_t offset, size_t size, char* in);
+  void write(size_t offset, size_t size, const char* in);
   void write_int8(size_t offset, uint8_t);
   void write_int32(size_t offset, int32_t);
   void write_int64(size_t offset, int64_t);
 
+  // moves `size` bytes from src_offset to dst_offset, the ranges may overlap
+  void move(size_t dst_offset, size_t src_offset, size_t size);
+
+  // read-only access to the page content, only valid while the page is pinned
+  inline const char* get_bytes() const noexcept {
+    return bytes;
+  }
+
   // get page number
   inline int32_t get_page_number() const noexcept {
     return page_id.page_number;
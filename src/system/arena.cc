@@ -0,0 +1,53 @@
+#include "arena.h"
+
+#include <cassert>
+#include <cstdint>
+
+Arena::~Arena() {
+  for (auto chunk : chunks) {
+    delete[] chunk;
+  }
+  for (auto chunk : big_chunks) {
+    delete[] chunk;
+  }
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+  assert(alignment <= alignof(std::max_align_t));
+  auto aligned = reinterpret_cast<char*>(
+      (reinterpret_cast<uintptr_t>(current) + alignment - 1) & ~(uintptr_t(alignment) - 1)
+  );
+  if (current != nullptr && aligned + bytes <= current_end) {
+    current = aligned + bytes;
+    return aligned;
+  }
+
+  // new[] returns memory aligned for any fundamental type, enough for the start of a chunk
+  if (bytes > CHUNK_SIZE / 4) {
+    // keeps the free space of the current chunk for the next requests
+    big_chunks.push_back(new char[bytes]);
+    return big_chunks.back();
+  }
+
+  chunks.push_back(new char[CHUNK_SIZE]);
+  current = chunks.back() + bytes;
+  current_end = chunks.back() + CHUNK_SIZE;
+  return chunks.back();
+}
+
+void Arena::reset() {
+  for (auto chunk : big_chunks) {
+    delete[] chunk;
+  }
+  big_chunks.clear();
+
+  if (chunks.empty()) {
+    return;
+  }
+  for (size_t i = 1; i < chunks.size(); i++) {
+    delete[] chunks[i];
+  }
+  chunks.resize(1);
+  current = chunks[0];
+  current_end = chunks[0] + CHUNK_SIZE;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator for memory owned by a query or operation, freed all at once when the arena is reset or
+// destroyed. Memory is carved from chunks of CHUNK_SIZE bytes, bigger requests get a chunk of their own.
+// As a std::pmr::memory_resource it can be used by std::pmr containers.
+class Arena : public std::pmr::memory_resource {
+public:
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  Arena() = default;
+
+  ~Arena() override;
+
+  // prevent accidental copies
+  Arena(const Arena& other) = delete;
+
+  // returns uninitialized memory for `size` chars
+  char* allocate_buffer(size_t size) {
+    return static_cast<char*>(allocate(size, 1));
+  }
+
+  // makes all the memory available again. Every object allocated in the arena must be already destroyed.
+  // The first chunk is kept, so an arena reused between operations of similar size does not allocate
+  void reset();
+
+  // number of chunks currently allocated
+  size_t get_chunk_count() const {
+    return chunks.size() + big_chunks.size();
+  }
+
+private:
+  // chunks of CHUNK_SIZE bytes, the last one is the current
+  std::vector<char*> chunks;
+
+  // chunks of requests bigger than CHUNK_SIZE / 4
+  std::vector<char*> big_chunks;
+
+  // free space of the current chunk
+  char* current = nullptr;
+
+  char* current_end = nullptr;
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+
+  // memory is only freed by reset() and the destructor
+  void do_deallocate(void*, size_t, size_t) override { }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
@@ -66,6 +66,20 @@ void BufferManager::fake_flush() {
   }
 }
 
+void BufferManager::remove_file(FileId file_id) {
+  std::lock_guard<std::mutex> lck(pages_mutex);
+  for (int64_t i = 0; i < frame_count; i++) {
+    auto& page = frames[i];
+    if (page.page_id.file_id == file_id) {
+      assert(page.pins == 0);
+      page_map.erase(page.page_id);
+      page.page_id = PageId(FileId(FileId::UNASSIGNED), 0);
+      page.dirty = false;
+      page.second_chance = false;
+    }
+  }
+}
+
 Page& BufferManager::get_unused_page() {
   while (true) {
     if (frames[clock].pins == 0) {
@@ -109,5 +123,6 @@ Page& BufferManager::get_page(FileId file_id, int64_t page_number) {
 }
 
 Page& BufferManager::append_page(FileId file_id) {
+  std::lock_guard<std::mutex> lck(append_mutex);
   return get_page(file_id, file_mgr.count_pages(file_id));
 }
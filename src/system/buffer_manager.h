@@ -30,6 +30,10 @@ public:
   // write all dirty pages to disk
   void flush();
 
+  // discards the pages of the file without writing them, before the file is removed
+  // (see FileManager::remove_file). None of them can be pinned
+  void remove_file(FileId file_id);
+
   // just to test recovery
   void fake_flush();
 
@@ -47,6 +51,9 @@ private:
   // needed to avoid race conditions
   std::mutex pages_mutex;
 
+  // prevents two append_page calls on the same file from getting the same page
+  std::mutex append_mutex;
+
   // used to search the index in the `buffer_pool` of a certain page
   // robin_hood::unordered_map<PageId, Page*> page_map;
   std::unordered_map<PageId, Page*> page_map;
@@ -5,8 +5,12 @@
 
 #include "exceptions/exceptions.h"
 #include "relational_model/schema.h"
+#include "storage/art/art_index.h"
 #include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/hash_index/hash_bucket.h"
+#include "storage/hash_index/hash_index.h"
 #include "storage/heap_file/heap_file.h"
+#include "storage/lsm/lsm_index.h"
 #include "system/system.h"
 
 using namespace std;
@@ -60,28 +64,53 @@ Catalog::Catalog(const string& filename) {
     for (int64_t c = 0; c < table_cardinality; ++c) {
       DataType d = static_cast<DataType>(read_int64());
       std::string col_name = read_string();
-      columns.push_back({col_name, d});
+      ColumnEncoding encoding = static_cast<ColumnEncoding>(read_int64());
+      columns.push_back({col_name, d, encoding});
     }
+    TableFormat format = static_cast<TableFormat>(read_int64());
 
     auto schema = std::make_unique<Schema>(std::move(columns));
 
     auto& schema_ref = *schema.get();
-    auto heap_file = std::make_unique<HeapFile>(i, schema_ref, table_name);
+    auto heap_file = std::make_unique<HeapFile>(i, schema_ref, table_name, format);
     table_name_idx.insert({table_name, tables.size()});
 
-    std::unique_ptr<Index> index;
-    IndexType index_type = static_cast<IndexType>(read_int64());
-    switch (index_type) {
-    case IndexType::B_PLUS_TREE: {
-      auto key_col_idx = read_int64();
-      index = std::make_unique<BPlusTree>(*heap_file.get(), key_col_idx, normalize(table_name));
-      break;
-    }
-    case IndexType::NONE:
-      break;
+    std::vector<std::unique_ptr<Index>> indexes(read_int64());
+    for (size_t index_pos = 0; index_pos < indexes.size(); index_pos++) {
+      auto index_name = get_index_name(table_name, index_pos);
+      IndexType index_type = static_cast<IndexType>(read_int64());
+      switch (index_type) {
+      case IndexType::B_PLUS_TREE: {
+        auto key_columns = read_columns();
+        auto include_columns = read_columns();
+        indexes[index_pos] = std::make_unique<BPlusTree>(
+            *heap_file.get(), key_columns, index_name + ".bpt", include_columns
+        );
+        break;
+      }
+      case IndexType::HASH: {
+        auto key_columns = read_columns();
+        indexes[index_pos] = std::make_unique<HashIndex>(*heap_file.get(), key_columns, index_name + ".hash");
+        break;
+      }
+      case IndexType::LSM: {
+        auto key_columns = read_columns();
+        indexes[index_pos] = std::make_unique<LSMIndex>(*heap_file.get(), key_columns, index_name + ".lsm");
+        break;
+      }
+      case IndexType::ART: {
+        auto key_columns = read_columns();
+        auto index = std::make_unique<ARTIndex>(*heap_file.get(), key_columns);
+        insert_heap_records(*heap_file, *index);
+        indexes[index_pos] = std::move(index);
+        break;
+      }
+      case IndexType::NONE:
+        throw std::runtime_error("Invalid index type in catalog");
+      }
     }
 
-    tables.emplace_back(table_name, std::move(schema), std::move(heap_file), std::move(index));
+    tables.emplace_back(table_name, std::move(schema), std::move(heap_file), std::move(indexes));
   }
 }
 
@@ -97,20 +126,25 @@ Catalog::~Catalog() {
     for (size_t i = 0; i < schema->columns.size(); i++) {
       write_int64(static_cast<int64_t>(schema->columns[i].datatype));
       write_string(schema->columns[i].name);
+      write_int64(static_cast<int64_t>(schema->columns[i].encoding));
     }
+    write_int64(static_cast<int64_t>(table_info.heap_file->format));
 
-    // write index type
-    if (table_info.index == nullptr) {
-      write_int64(static_cast<uint64_t>(IndexType::NONE));
-    } else {
-      auto index_type = table_info.index->get_type();
+    // write the type and the columns of each index
+    write_int64(table_info.indexes.size());
+    for (auto& index : table_info.indexes) {
+      auto index_type = index->get_type();
       write_int64(static_cast<uint64_t>(index_type));
+      write_columns(index->get_key_columns());
       switch (index_type) {
       case IndexType::B_PLUS_TREE: {
-        auto casted = reinterpret_cast<BPlusTree*>(table_info.index.get());
-        write_int64(casted->key_column_idx);
+        auto casted = reinterpret_cast<BPlusTree*>(index.get());
+        write_columns(casted->include_columns);
         break;
       }
+      case IndexType::HASH:
+      case IndexType::LSM:
+      case IndexType::ART:
       case IndexType::NONE:
         break;
       }
@@ -145,6 +179,14 @@ string Catalog::read_string() {
   return res;
 }
 
+std::vector<int64_t> Catalog::read_columns() {
+  std::vector<int64_t> columns(read_int64());
+  for (auto& col : columns) {
+    col = read_int64();
+  }
+  return columns;
+}
+
 void Catalog::write_int64(const int64_t n) {
   uint8_t buf[8];
   for (unsigned int i = 0, shift = 0; i < sizeof(buf); ++i, shift += 8) {
@@ -158,7 +200,14 @@ void Catalog::write_string(const string& s) {
   file.write(s.c_str(), s.size());
 }
 
-HeapFile* Catalog::create_table(const std::string& table_name, const Schema& schema) {
+void Catalog::write_columns(const std::vector<int64_t>& columns) {
+  write_int64(columns.size());
+  for (auto col : columns) {
+    write_int64(col);
+  }
+}
+
+HeapFile* Catalog::create_table(const std::string& table_name, const Schema& schema, TableFormat format) {
   std::string normalized_table_name = normalize(table_name);
 
   auto found = table_name_idx.find(normalized_table_name);
@@ -167,12 +216,22 @@ HeapFile* Catalog::create_table(const std::string& table_name, const Schema& sch
     throw QueryException("table: `" + table_name + "` already exists.");
   }
 
+  for (auto& col : schema.columns) {
+    if (col.encoding == ColumnEncoding::DICTIONARY && col.datatype != DataType::STR) {
+      throw QueryException("column `" + col.name + "`: only STR columns can be dictionary encoded.");
+    }
+  }
+
   TableId table_id = tables.size();
   table_name_idx.insert({normalized_table_name, table_id});
 
-  auto heap_file = std::make_unique<HeapFile>(table_id, schema, normalized_table_name);
+  auto table_schema = std::make_unique<Schema>(schema);
+  auto heap_file = std::make_unique<HeapFile>(table_id, *table_schema, normalized_table_name, format);
 
-  tables.emplace_back(normalized_table_name, std::make_unique<Schema>(schema), std::move(heap_file), nullptr);
+  std::vector<std::unique_ptr<Index>> no_indexes;
+  tables.emplace_back(
+      normalized_table_name, std::move(table_schema), std::move(heap_file), std::move(no_indexes)
+  );
 
   return tables.back().heap_file.get();
 }
@@ -200,23 +259,30 @@ RID Catalog::insert_record(
 
   auto rid = tables[table_pos].heap_file->insert_record(record);
 
-  auto index = tables[get_table_pos(table_name)].index.get();
-  if (index != nullptr) {
-    index->insert_record(rid);
+  for (auto& index : tables[table_pos].indexes) {
+    index->insert_record(record, rid);
   }
 
   return rid;
 }
 
-void Catalog::delete_record(const std::string& table_name, RID rid) {
-  auto table_pos = get_table_pos(table_name);
+TableInserter Catalog::get_inserter(const std::string& table_name) {
+  return TableInserter(*this, get_table_pos(table_name));
+}
 
-  // MUST delete from the index before the table, otherwise rid will be invalid
-  auto index = get_index(table_name);
-  if (index != nullptr) {
-    index->delete_record(rid);
+void Catalog::delete_record(const std::string& table_name, RID rid) {
+  auto& table_info = tables[get_table_pos(table_name)];
+
+  // MUST delete from the indexes before the table, otherwise rid will be invalid. The record is read once
+  // for all of them
+  if (!table_info.indexes.empty()) {
+    auto& record = *table_info.record_buf;
+    table_info.heap_file->get_record(rid, record);
+    for (auto& index : table_info.indexes) {
+      index->delete_record(record, rid);
+    }
   }
-  tables[table_pos].heap_file->delete_record(rid);
+  table_info.heap_file->delete_record(rid);
 }
 
 Record& Catalog::get_record_buf(const std::string& table_name) {
@@ -256,25 +322,150 @@ FileId Catalog::get_file_id(TableId tid) {
   return tables[tid].heap_file->file_id;
 }
 
-void Catalog::create_index(const std::string& table_name, int key_col_idx) {
-  auto table_pos = get_table_pos(table_name);
+std::string Catalog::get_index_name(const std::string& table_name, size_t index_pos) {
+  return normalize(table_name) + "." + std::to_string(index_pos);
+}
 
-  auto& table_info = tables[table_pos];
-  if (table_info.index != nullptr) {
-    throw QueryException("table: `" + table_name + "` already has an index.");
+void Catalog::check_key_columns(
+    const std::string& table_name, const std::vector<int64_t>& key_columns, IndexType index_type
+) const {
+  auto& table_info = tables[get_table_pos(table_name)];
+  auto column_count = static_cast<int64_t>(table_info.schema->columns.size());
+  if (key_columns.empty()) {
+    throw QueryException("index on table: `" + table_name + "` must have a key column.");
+  }
+  for (size_t i = 0; i < key_columns.size(); i++) {
+    auto col = key_columns[i];
+    if (col < 0 || col >= column_count
+        || std::find(key_columns.begin(), key_columns.begin() + i, col) != key_columns.begin() + i)
+    {
+      throw QueryException("invalid key column for index on table: `" + table_name + "`.");
+    }
   }
+  for (auto& index : table_info.indexes) {
+    if (index->get_type() == index_type && index->get_key_columns() == key_columns) {
+      throw QueryException("table: `" + table_name + "` already has that index.");
+    }
+  }
+}
 
-  table_info.index =
-      std::make_unique<BPlusTree>(*table_info.heap_file, key_col_idx, normalize(table_name) + ".bpt");
+void Catalog::create_index(
+    const std::string& table_name,
+    const std::vector<int64_t>& key_columns,
+    const std::vector<int64_t>& include_columns,
+    const BPlusTreeBuildOptions& options
+) {
+  check_key_columns(table_name, key_columns, IndexType::B_PLUS_TREE);
+
+  auto& table_info = tables[get_table_pos(table_name)];
+  auto column_count = static_cast<int64_t>(table_info.schema->columns.size());
+  for (auto col : include_columns) {
+    if (col < 0 || col >= column_count
+        || std::find(key_columns.begin(), key_columns.end(), col) != key_columns.end())
+    {
+      throw QueryException("invalid INCLUDE column for index on table: `" + table_name + "`.");
+    }
+  }
+  if (BPlusTreeRecord::get_max_size(*table_info.schema, key_columns, include_columns)
+      > BPlusTreeRecord::MAX_SIZE)
+  {
+    throw QueryException("columns of index on table: `" + table_name + "` are too big.");
+  }
+  if (!(options.fill_factor > 0 && options.fill_factor <= 1)) {
+    throw QueryException("index fill factor must be in (0, 1].");
+  }
+
+  auto index_name = get_index_name(table_name, table_info.indexes.size()) + ".bpt";
+  auto index = std::make_unique<BPlusTree>(*table_info.heap_file, key_columns, index_name, include_columns);
+  BPlusTreeBuilder builder(*index, options, file_mgr.get_file_path(index_name + ".run"));
+  builder.build();
+  table_info.indexes.push_back(std::move(index));
+}
+
+void Catalog::create_index(
+    const std::string& table_name,
+    int key_col_idx,
+    const std::vector<int64_t>& include_columns,
+    const BPlusTreeBuildOptions& options
+) {
+  create_index(table_name, std::vector<int64_t>{key_col_idx}, include_columns, options);
+}
+
+void Catalog::create_hash_index(const std::string& table_name, const std::vector<int64_t>& key_columns) {
+  check_key_columns(table_name, key_columns, IndexType::HASH);
+
+  auto& table_info = tables[get_table_pos(table_name)];
+  if (HashIndex::get_max_entry_size(*table_info.schema, key_columns) > HashBucket::MAX_ENTRY_SIZE) {
+    throw QueryException("columns of index on table: `" + table_name + "` are too big.");
+  }
+
+  auto& heap_file = *table_info.heap_file;
+  auto index_name = get_index_name(table_name, table_info.indexes.size()) + ".hash";
+  auto index = std::make_unique<HashIndex>(heap_file, key_columns, index_name);
+  insert_heap_records(heap_file, *index);
+  table_info.indexes.push_back(std::move(index));
+}
+
+void Catalog::create_hash_index(const std::string& table_name, int key_col_idx) {
+  create_hash_index(table_name, std::vector<int64_t>{key_col_idx});
+}
+
+void Catalog::create_lsm_index(const std::string& table_name, const std::vector<int64_t>& key_columns) {
+  check_key_columns(table_name, key_columns, IndexType::LSM);
 
-  auto iter = table_info.heap_file->get_record_iter();
-  Record record_buf(*table_info.schema);
-  iter->begin(record_buf);
-  while (iter->next()) {
-    table_info.index->insert_record(iter->get_current_RID());
+  auto& table_info = tables[get_table_pos(table_name)];
+  if (BPlusTreeRecord::get_max_size(*table_info.schema, key_columns) > LSMRun::MAX_ENTRY_SIZE) {
+    throw QueryException("columns of index on table: `" + table_name + "` are too big.");
+  }
+
+  auto& heap_file = *table_info.heap_file;
+  auto index_name = get_index_name(table_name, table_info.indexes.size()) + ".lsm";
+  auto index = std::make_unique<LSMIndex>(heap_file, key_columns, index_name);
+  insert_heap_records(heap_file, *index);
+  table_info.indexes.push_back(std::move(index));
+}
+
+void Catalog::create_lsm_index(const std::string& table_name, int key_col_idx) {
+  create_lsm_index(table_name, std::vector<int64_t>{key_col_idx});
+}
+
+void Catalog::create_art_index(const std::string& table_name, const std::vector<int64_t>& key_columns) {
+  check_key_columns(table_name, key_columns, IndexType::ART);
+
+  auto& table_info = tables[get_table_pos(table_name)];
+  if (BPlusTreeRecord::get_max_size(*table_info.schema, key_columns) > BPlusTreeRecord::MAX_SIZE) {
+    throw QueryException("columns of index on table: `" + table_name + "` are too big.");
+  }
+
+  auto& heap_file = *table_info.heap_file;
+  auto index = std::make_unique<ARTIndex>(heap_file, key_columns);
+  insert_heap_records(heap_file, *index);
+  table_info.indexes.push_back(std::move(index));
+}
+
+void Catalog::create_art_index(const std::string& table_name, int key_col_idx) {
+  create_art_index(table_name, std::vector<int64_t>{key_col_idx});
+}
+
+void Catalog::insert_heap_records(HeapFile& heap_file, Index& index) {
+  Record record(heap_file.schema);
+  auto page_count = file_mgr.count_pages(heap_file.file_id);
+  for (int64_t page_number = 0; page_number < page_count; page_number++) {
+    auto page = heap_file.get_page(page_number);
+    auto dir_count = page->get_dir_count();
+    for (int32_t slot = 0; slot < dir_count; slot++) {
+      if (page->get_record(slot, record)) {
+        index.insert_record(record, RID(page_number, slot));
+      }
+    }
   }
 }
 
 Index* Catalog::get_index(const std::string& table_name) {
-  return tables[get_table_pos(table_name)].index.get();
+  auto& indexes = tables[get_table_pos(table_name)].indexes;
+  return indexes.empty() ? nullptr : indexes.front().get();
+}
+
+const std::vector<std::unique_ptr<Index>>& Catalog::get_indexes(const std::string& table_name) {
+  return tables[get_table_pos(table_name)].indexes;
 }
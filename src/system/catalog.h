@@ -2,14 +2,17 @@
 
 #include <fstream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "relational_model/record.h"
 #include "relational_model/schema.h"
+#include "storage/b_plus_tree/b_plus_tree_builder.h"
 #include "storage/file_id.h"
 #include "storage/heap_file/rid.h"
 #include "storage/heap_file/heap_file.h"
+#include "system/table_inserter.h"
 
 class Catalog {
 public:
@@ -21,7 +24,7 @@ public:
   // sets the schema when the table is found
   HeapFile* get_table(const std::string& table_name, Schema* schema);
 
-  HeapFile* create_table(const std::string& table_name, const Schema&);
+  HeapFile* create_table(const std::string& table_name, const Schema&, TableFormat format = TableFormat::ROW);
 
   bool table_exists(const std::string& table_name) const;
 
@@ -31,6 +34,9 @@ public:
       const std::string& table_name, const std::vector<std::variant<std::string_view, int64_t>>& values
   );
 
+  // resolves the table once, for inserting many rows (see TableInserter)
+  TableInserter get_inserter(const std::string& table_name);
+
   void delete_record(const std::string& table_name, RID rid);
 
   Record& get_record_buf(const std::string& table_name);
@@ -39,11 +45,50 @@ public:
 
   FileId get_file_id(TableId tid);
 
-  void create_index(const std::string& table_name, int key_col_idx);
+  // A table may have many indexes, but not two of the same type over the same key columns. Keys with
+  // several columns are compared column by column, in the order of `key_columns`.
+
+  // the values of `include_columns` are also stored in the index, so index-only scans can return them.
+  // The index is built bottom-up from the sorted entries of the table (see BPlusTreeBuilder)
+  void create_index(
+      const std::string& table_name,
+      const std::vector<int64_t>& key_columns,
+      const std::vector<int64_t>& include_columns = {},
+      const BPlusTreeBuildOptions& options = {}
+  );
+
+  void create_index(
+      const std::string& table_name,
+      int key_col_idx,
+      const std::vector<int64_t>& include_columns = {},
+      const BPlusTreeBuildOptions& options = {}
+  );
+
+  // the index only supports equality lookups, reading a single page of the index (see HashIndex)
+  void create_hash_index(const std::string& table_name, const std::vector<int64_t>& key_columns);
+
+  void create_hash_index(const std::string& table_name, int key_col_idx);
+
+  // the index is optimized for inserts, buffering them in memory and merging sorted runs in the background
+  // (see LSMIndex)
+  void create_lsm_index(const std::string& table_name, const std::vector<int64_t>& key_columns);
+
+  void create_lsm_index(const std::string& table_name, int key_col_idx);
 
+  // the index is kept only in memory and rebuilt from the table when the database is opened (see ARTIndex)
+  void create_art_index(const std::string& table_name, const std::vector<int64_t>& key_columns);
+
+  void create_art_index(const std::string& table_name, int key_col_idx);
+
+  // returns the first index created on the table, nullptr if it has no indexes
   Index* get_index(const std::string& table_name);
 
+  // returns the indexes of the table in creation order
+  const std::vector<std::unique_ptr<Index>>& get_indexes(const std::string& table_name);
+
 private:
+  friend class TableInserter;
+
   std::map<std::string, int64_t> table_name_idx;
 
   std::vector<TableInfo> tables;
@@ -58,6 +103,21 @@ private:
 
   int64_t get_table_pos(const std::string& table_name) const;
 
+  // validates the key columns of a new index of type `index_type` on the table
+  void check_key_columns(
+      const std::string& table_name, const std::vector<int64_t>& key_columns, IndexType index_type
+  ) const;
+
+  // name of the files of the index at position `index_pos` of the table, without extension
+  static std::string get_index_name(const std::string& table_name, size_t index_pos);
+
+  // inserts the records already in the heap file into a new index
+  static void insert_heap_records(HeapFile& heap_file, Index& index);
+
+  std::vector<int64_t> read_columns();
+
+  void write_columns(const std::vector<int64_t>& columns);
+
   void write_int64(const int64_t);
 
   void write_string(const std::string&);
@@ -55,7 +55,34 @@ void FileManager::read_page(PageId page_id, char* bytes) const {
   }
 }
 
+void FileManager::read_pages(FileId file_id, int64_t page_number, int64_t count, char* bytes) const {
+  auto size = count * Page::SIZE;
+  auto read_res = pread(file_id.id, bytes, size, page_number * Page::SIZE);
+  if (read_res != size) {
+    throw std::runtime_error("Could not read file pages");
+  }
+}
+
+void FileManager::write_pages(FileId file_id, int64_t page_number, int64_t count, const char* bytes) const {
+  auto size = count * Page::SIZE;
+  auto write_res = pwrite(file_id.id, bytes, size, page_number * Page::SIZE);
+  if (write_res != size) {
+    throw std::runtime_error("Could not write file pages");
+  }
+}
+
+void FileManager::remove_file(const string& filename) {
+  std::lock_guard<std::mutex> lck(files_mutex);
+  auto search = filename2file_id.find(filename);
+  if (search != filename2file_id.end()) {
+    close(search->second.id);
+    filename2file_id.erase(search);
+  }
+  unlink(get_file_path(filename).c_str());
+}
+
 FileId FileManager::get_file_id(const string& filename) {
+  std::lock_guard<std::mutex> lck(files_mutex);
   auto search = filename2file_id.find(filename);
   if (search != filename2file_id.end()) {
     return search->second;
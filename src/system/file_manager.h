@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <unistd.h>
 
@@ -33,9 +34,23 @@ public:
   // `bytes` must point to the start memory position of `Page::SIZE` allocated bytes
   void read_page(PageId page_id, char* bytes) const;
 
+  // Reads or writes `count` consecutive pages starting at `page_number` directly, without going through
+  // the buffer. Used for files written once sequentially and read sequentially (see LSMRun), the pages
+  // must not be modified in the buffer. Safe to call concurrently with other reads of the same file.
+  void read_pages(FileId file_id, int64_t page_number, int64_t count, char* bytes) const;
+
+  void write_pages(FileId file_id, int64_t page_number, int64_t count, const char* bytes) const;
+
+  // closes and deletes the file. Its pages must have been removed from the buffer before
+  // (see BufferManager::remove_file)
+  void remove_file(const std::string& filename);
+
 private:
   // folder where all the used files will be
   const std::string db_folder;
 
   std::map<std::string, FileId> filename2file_id;
+
+  // protects filename2file_id, files may be created and removed by a background thread (see LSMIndex)
+  std::mutex files_mutex;
 };
@@ -0,0 +1,115 @@
+#include "table_inserter.h"
+
+#include "exceptions/exceptions.h"
+#include "storage/b_plus_tree/b_plus_tree.h"
+#include "storage/heap_file/heap_file.h"
+#include "system/catalog.h"
+
+TableInserter::TableInserter(Catalog& catalog, int64_t table_pos)
+    : schema(*catalog.tables[table_pos].schema),
+      catalog(catalog),
+      table_pos(table_pos),
+      heap_file(*catalog.tables[table_pos].heap_file),
+      record_buf(schema, arena) {}
+
+template <class SetRow>
+void TableInserter::insert_rows(size_t row_count, RID* out_rids, SetRow set_row) {
+  auto& indexes = catalog.tables[table_pos].indexes;
+  for (auto i = index_batches.size(); i < indexes.size(); i++) {
+    switch (indexes[i]->get_type()) {
+    case IndexType::B_PLUS_TREE: {
+      auto bpt = reinterpret_cast<BPlusTree*>(indexes[i].get());
+      index_batches.push_back(std::make_unique<BPlusTreeInsertBatch>(*bpt));
+      break;
+    }
+    case IndexType::HASH:
+    case IndexType::LSM:
+    case IndexType::ART:
+    case IndexType::NONE:
+      index_batches.push_back(nullptr);
+      break;
+    }
+  }
+
+  std::unique_ptr<TablePage> current_page;
+  try {
+    for (size_t row = 0; row < row_count; row++) {
+      set_row(row);
+      auto rid = heap_file.insert_record(record_buf, current_page);
+      for (size_t i = 0; i < indexes.size(); i++) {
+        if (index_batches[i] != nullptr) {
+          index_batches[i]->add(record_buf, rid);
+        } else {
+          indexes[i]->insert_record(record_buf, rid);
+        }
+      }
+      if (out_rids != nullptr) {
+        out_rids[row] = rid;
+      }
+    }
+  } catch (...) {
+    // rows inserted before the failing one stay inserted, so they must be in the indexes
+    flush_index_batches();
+    throw;
+  }
+  flush_index_batches();
+}
+
+void TableInserter::flush_index_batches() {
+  for (auto& batch : index_batches) {
+    if (batch != nullptr) {
+      batch->flush();
+    }
+  }
+}
+
+void TableInserter::insert(const std::vector<ColumnSpan>& columns, size_t row_count, RID* out_rids) {
+  if (columns.size() != schema.columns.size()) {
+    throw QueryException(
+        "expected " + std::to_string(schema.columns.size()) + " columns, received "
+        + std::to_string(columns.size())
+    );
+  }
+  for (size_t col = 0; col < columns.size(); col++) {
+    if (columns[col].datatype != schema.columns[col].datatype) {
+      throw QueryException("wrong datatype for column `" + schema.columns[col].name + "`");
+    }
+  }
+
+  insert_rows(row_count, out_rids, [&](size_t row) {
+    for (size_t col = 0; col < columns.size(); col++) {
+      auto& value = record_buf.values[col];
+      switch (columns[col].datatype) {
+      case DataType::INT: {
+        value.value.as_int = columns[col].ints[row];
+        break;
+      }
+      case DataType::STR: {
+        auto& str = columns[col].strs[row];
+        // rows before this one stay inserted
+        if (str.size() > Value::MAX_STRLEN) {
+          throw QueryException("string too long for column `" + schema.columns[col].name + "`");
+        }
+        value.set_str(str.data(), str.size());
+        break;
+      }
+      }
+    }
+  });
+}
+
+void TableInserter::insert(const ColumnBatch& batch, RID* out_rids) {
+  if (batch.columns.size() != schema.columns.size()) {
+    throw QueryException(
+        "expected " + std::to_string(schema.columns.size()) + " columns, received "
+        + std::to_string(batch.columns.size())
+    );
+  }
+  for (size_t col = 0; col < batch.columns.size(); col++) {
+    if (batch.columns[col].datatype != schema.columns[col].datatype) {
+      throw QueryException("wrong datatype for column `" + schema.columns[col].name + "`");
+    }
+  }
+
+  insert_rows(batch.size, out_rids, [&](size_t row) { batch.read_record(row, record_buf); });
+}
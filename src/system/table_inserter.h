@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "relational_model/column_batch.h"
+#include "relational_model/record.h"
+#include "storage/b_plus_tree/b_plus_tree_insert_batch.h"
+#include "storage/heap_file/rid.h"
+#include "system/arena.h"
+
+class Catalog;
+class HeapFile;
+
+// Values of one column for a batch of rows to insert, not owned. Use the pointer matching the datatype of
+// the column.
+struct ColumnSpan {
+  DataType datatype;
+
+  const int64_t* ints;
+
+  const std::string_view* strs;
+
+  ColumnSpan(const int64_t* ints)
+      : datatype(DataType::INT),
+        ints(ints),
+        strs(nullptr) {}
+
+  ColumnSpan(const std::string_view* strs)
+      : datatype(DataType::STR),
+        ints(nullptr),
+        strs(strs) {}
+};
+
+// Inserts rows into a table resolved once (see Catalog::get_inserter), avoiding the per row name lookup
+// and std::variant validation of Catalog::insert_record. Datatypes are validated once per batch, and the
+// page where the last row went stays pinned during a batch.
+// Every index of the table is maintained from the rows being inserted, including indexes created after the
+// inserter. The entries of a batch for each B+tree are inserted together, sorted (see BPlusTreeInsertBatch).
+class TableInserter {
+public:
+  TableInserter(Catalog& catalog, int64_t table_pos);
+
+  // prevent accidental copies
+  TableInserter(const TableInserter& other) = delete;
+
+  // inserts `row_count` rows, the row i has the value i of each column.
+  // If out_rids is not nullptr the RID of each row is written there (it must have row_count elements)
+  void insert(const std::vector<ColumnSpan>& columns, size_t row_count, RID* out_rids = nullptr);
+
+  // inserts all the rows of the batch, that must have the schema of the table
+  void insert(const ColumnBatch& batch, RID* out_rids = nullptr);
+
+  const Schema& schema;
+
+private:
+  Catalog& catalog;
+
+  const int64_t table_pos;
+
+  HeapFile& heap_file;
+
+  Arena arena;
+
+  Record record_buf;
+
+  // one for each index of the table, nullptr for indexes that are not B+trees
+  std::vector<std::unique_ptr<BPlusTreeInsertBatch>> index_batches;
+
+  template <class SetRow>
+  void insert_rows(size_t row_count, RID* out_rids, SetRow set_row);
+
+  void flush_index_batches();
+};